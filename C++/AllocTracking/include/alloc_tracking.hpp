@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace ds::alloc {
+
+/*
+ * Allocation tracking
+ * Counts heap traffic on the current thread so tests can assert that a hot
+ * path does not allocate and benchmarks can report allocations per op.
+ *
+ *   operator new / new[] (all overloads)  -> allocations, bytes
+ *   operator delete / delete[]            -> deallocations
+ *   malloc / calloc / realloc / free      -> same, with ALLOC_TRACKING_MALLOC
+ *
+ * The replacement operators live in src/alloc_hooks.cpp, which the
+ * ALLOCTRACKING target compiles into every executable that links it. Without
+ * that file the counters below exist but never move; hooks_installed() tells
+ * the two cases apart.
+ *
+ * Counters are thread_local and trivially destructible, so the hooks can
+ * bump them from any thread, including during thread and process teardown.
+ * A scope only sees allocations made by the thread that created it.
+ */
+
+struct counters {
+  std::uint64_t allocations{0};
+  std::uint64_t deallocations{0};
+  std::uint64_t bytes{0};
+};
+
+namespace detail {
+inline thread_local counters thread_counters;
+inline bool hooks_linked = false;
+} // namespace detail
+
+[[nodiscard]] inline bool hooks_installed() noexcept {
+  return detail::hooks_linked;
+}
+
+// Totals for the calling thread since it started.
+[[nodiscard]] inline counters thread_totals() noexcept {
+  return detail::thread_counters;
+}
+
+// Allocation activity on this thread since construction (or reset()).
+class scope {
+public:
+  scope() noexcept : start_(thread_totals()) {}
+
+  void reset() noexcept { start_ = thread_totals(); }
+
+  [[nodiscard]] std::uint64_t allocations() const noexcept {
+    return thread_totals().allocations - start_.allocations;
+  }
+  [[nodiscard]] std::uint64_t deallocations() const noexcept {
+    return thread_totals().deallocations - start_.deallocations;
+  }
+  [[nodiscard]] std::uint64_t bytes() const noexcept {
+    return thread_totals().bytes - start_.bytes;
+  }
+
+  // Lets `for (scope s; s.once(); ...)` run a block exactly once; used by
+  // REQUIRE_NO_ALLOC.
+  bool once() noexcept { return !std::exchange(done_, true); }
+
+private:
+  counters start_;
+  bool done_{false};
+};
+
+} // namespace ds::alloc
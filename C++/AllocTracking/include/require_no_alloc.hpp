@@ -0,0 +1,25 @@
+#pragma once
+
+#include "alloc_tracking.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+// Block forms for Catch2 tests:
+//
+//   REQUIRE_NO_ALLOC { q.push(1); q.try_pop(v); }
+//   CHECK_NO_ALLOC { book.CancelOrder(42); }
+//
+// The block runs once; afterwards the number of allocations it made on this
+// thread must be zero. Needs the ALLOCTRACKING hooks linked in.
+#define DS_ALLOC_BLOCK_(ASSERT)                                                \
+  for (::ds::alloc::scope ds_alloc_scope_; ds_alloc_scope_.once();             \
+       [&] {                                                                   \
+         /* read the counts before Catch allocates its own messages */         \
+         auto ds_allocations_ = ds_alloc_scope_.allocations();                 \
+         auto ds_bytes_ = ds_alloc_scope_.bytes();                             \
+         INFO("bytes allocated: " << ds_bytes_);                               \
+         ASSERT(ds_allocations_ == 0);                                         \
+       }())
+
+#define REQUIRE_NO_ALLOC DS_ALLOC_BLOCK_(REQUIRE)
+#define CHECK_NO_ALLOC DS_ALLOC_BLOCK_(CHECK)
@@ -0,0 +1,193 @@
+// Global allocation hooks for ds::alloc. Compiled into every executable that
+// links ALLOCTRACKING; see alloc_tracking.hpp.
+
+#include "alloc_tracking.hpp"
+
+#include <cstdlib>
+#include <new>
+
+#if defined(DS_ALLOC_TRACK_MALLOC) && defined(__GLIBC__)
+extern "C" {
+void *__libc_malloc(std::size_t size);
+void *__libc_calloc(std::size_t count, std::size_t size);
+void *__libc_realloc(void *p, std::size_t size);
+void __libc_free(void *p);
+void *__libc_memalign(std::size_t alignment, std::size_t size);
+}
+#define DS_RAW_MALLOC __libc_malloc
+#define DS_RAW_FREE __libc_free
+#else
+#define DS_RAW_MALLOC std::malloc
+#define DS_RAW_FREE std::free
+#endif
+
+namespace {
+
+const bool installed = [] {
+  ds::alloc::detail::hooks_linked = true;
+  return true;
+}();
+
+inline void count_alloc(std::size_t size) noexcept {
+  auto &c = ds::alloc::detail::thread_counters;
+  ++c.allocations;
+  c.bytes += size;
+}
+
+inline void count_free(void *p) noexcept {
+  if (p != nullptr) {
+    ++ds::alloc::detail::thread_counters.deallocations;
+  }
+}
+
+void *raw_alloc(std::size_t size) noexcept {
+  return DS_RAW_MALLOC(size == 0 ? 1 : size);
+}
+
+void *raw_aligned_alloc(std::size_t size, std::size_t alignment) noexcept {
+#if defined(DS_ALLOC_TRACK_MALLOC) && defined(__GLIBC__)
+  return __libc_memalign(alignment, size == 0 ? 1 : size);
+#else
+  // aligned_alloc wants the size to be a multiple of the alignment.
+  std::size_t rounded = (size + alignment - 1) / alignment * alignment;
+  return std::aligned_alloc(alignment, rounded == 0 ? alignment : rounded);
+#endif
+}
+
+void *tracked_new(std::size_t size) {
+  void *p = raw_alloc(size);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  count_alloc(size);
+  return p;
+}
+
+void *tracked_new(std::size_t size, std::align_val_t alignment) {
+  void *p = raw_aligned_alloc(size, static_cast<std::size_t>(alignment));
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  count_alloc(size);
+  return p;
+}
+
+void tracked_delete(void *p) noexcept {
+  count_free(p);
+  DS_RAW_FREE(p);
+}
+
+} // namespace
+
+// ----- OPERATOR NEW -----
+
+void *operator new(std::size_t size) { return tracked_new(size); }
+void *operator new[](std::size_t size) { return tracked_new(size); }
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+  try {
+    return tracked_new(size);
+  } catch (...) {
+    return nullptr;
+  }
+}
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+  try {
+    return tracked_new(size);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+  return tracked_new(size, alignment);
+}
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+  return tracked_new(size, alignment);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment,
+                   const std::nothrow_t &) noexcept {
+  try {
+    return tracked_new(size, alignment);
+  } catch (...) {
+    return nullptr;
+  }
+}
+void *operator new[](std::size_t size, std::align_val_t alignment,
+                     const std::nothrow_t &) noexcept {
+  try {
+    return tracked_new(size, alignment);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+// ----- OPERATOR DELETE -----
+
+void operator delete(void *p) noexcept { tracked_delete(p); }
+void operator delete[](void *p) noexcept { tracked_delete(p); }
+void operator delete(void *p, std::size_t) noexcept { tracked_delete(p); }
+void operator delete[](void *p, std::size_t) noexcept { tracked_delete(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept {
+  tracked_delete(p);
+}
+void operator delete[](void *p, const std::nothrow_t &) noexcept {
+  tracked_delete(p);
+}
+void operator delete(void *p, std::align_val_t) noexcept { tracked_delete(p); }
+void operator delete[](void *p, std::align_val_t) noexcept {
+  tracked_delete(p);
+}
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept {
+  tracked_delete(p);
+}
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept {
+  tracked_delete(p);
+}
+void operator delete(void *p, std::align_val_t,
+                     const std::nothrow_t &) noexcept {
+  tracked_delete(p);
+}
+void operator delete[](void *p, std::align_val_t,
+                       const std::nothrow_t &) noexcept {
+  tracked_delete(p);
+}
+
+// ----- MALLOC (optional) -----
+
+#if defined(DS_ALLOC_TRACK_MALLOC) && defined(__GLIBC__)
+extern "C" {
+
+void *malloc(std::size_t size) {
+  void *p = __libc_malloc(size);
+  if (p != nullptr) {
+    count_alloc(size);
+  }
+  return p;
+}
+
+void *calloc(std::size_t count, std::size_t size) {
+  void *p = __libc_calloc(count, size);
+  if (p != nullptr) {
+    count_alloc(count * size);
+  }
+  return p;
+}
+
+// Counted as a free plus an allocation when it hands back new storage.
+void *realloc(void *old, std::size_t size) {
+  void *p = __libc_realloc(old, size);
+  if (p != nullptr && p != old) {
+    count_free(old);
+    count_alloc(size);
+  }
+  return p;
+}
+
+void free(void *p) {
+  count_free(p);
+  __libc_free(p);
+}
+}
+#endif
@@ -0,0 +1,82 @@
+#include "alloc_tracking.hpp"
+#include "require_no_alloc.hpp"
+#include <array>
+#include <catch2/catch_test_macros.hpp>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct alignas(64) over_aligned {
+  std::array<char, 64> bytes;
+};
+
+} // namespace
+
+TEST_CASE("hooks are linked into this binary", "[alloc]") {
+  REQUIRE(ds::alloc::hooks_installed());
+}
+
+TEST_CASE("scope counts new and delete on this thread", "[alloc]") {
+  ds::alloc::scope s;
+  auto p = std::make_unique<int>(1);
+  auto arr = std::make_unique<int[]>(16);
+  REQUIRE(s.allocations() == 2);
+  REQUIRE(s.bytes() >= sizeof(int) * 17);
+  p.reset();
+  arr.reset();
+  REQUIRE(s.deallocations() == 2);
+}
+
+TEST_CASE("aligned and nothrow overloads are counted", "[alloc]") {
+  ds::alloc::scope s;
+  auto *a = new over_aligned;
+  REQUIRE(reinterpret_cast<std::uintptr_t>(a) % 64 == 0);
+  delete a;
+  int *b = new (std::nothrow) int(3);
+  delete b;
+  REQUIRE(s.allocations() == 2);
+  REQUIRE(s.deallocations() == 2);
+}
+
+TEST_CASE("other threads do not leak into a scope", "[alloc]") {
+  ds::alloc::scope s;
+  std::thread t([] {
+    std::vector<int> v(1000);
+    (void)v;
+  });
+  t.join();
+  // std::thread itself allocates its state on this thread.
+  std::uint64_t spawn_cost = s.allocations();
+  s.reset();
+  std::thread t2([] { std::vector<int> v(1000); });
+  t2.join();
+  REQUIRE(s.allocations() == spawn_cost);
+}
+
+TEST_CASE("REQUIRE_NO_ALLOC passes for stack-only work", "[alloc]") {
+  std::array<int, 64> values{};
+  int sum = 0;
+  REQUIRE_NO_ALLOC {
+    std::iota(values.begin(), values.end(), 0);
+    sum = std::accumulate(values.begin(), values.end(), 0);
+  }
+  REQUIRE(sum == 2016);
+}
+
+TEST_CASE("reserved vector push_back does not allocate", "[alloc]") {
+  std::vector<int> v;
+  v.reserve(100);
+  CHECK_NO_ALLOC {
+    for (int i = 0; i < 100; ++i) {
+      v.push_back(i);
+    }
+  }
+  ds::alloc::scope s;
+  v.push_back(100);
+  REQUIRE(s.allocations() == 1);
+}
@@ -0,0 +1,503 @@
+#pragma once
+
+#include "alloc_tracking.hpp"
+#include "perf_counters.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <ctime>
+#include <functional>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace ds::bench {
+
+/*
+ * Microbenchmark harness shared by every module's *_bench executable.
+ *
+ *   calibrate  grow the iteration count until one run takes >= min_time
+ *   warmup     `warmup` untimed runs at that iteration count
+ *   measure    `repetitions` timed runs -> ns/op samples -> summary
+ *
+ * Each run calls the benchmark body once with a state that carries the
+ * iteration count; the body loops that many times. Setup that must not be
+ * timed goes between state.pause() and state.resume().
+ *
+ * Command line (all optional):
+ *   --filter=<substr>  --repetitions=<n>  --warmup=<n>  --min-time-ms=<n>
+ *   --cpu=<n>          --json=<path>      --counters
+ *
+ * --counters adds perf_event_open counters (see perf_counters.hpp), reported
+ * per operation and averaged over the measured repetitions. Without kernel
+ * support the run carries on with timings only.
+ *
+ * Executables linking ALLOCTRACKING also get allocs/op and bytes/op: heap
+ * allocations made by the benchmark thread while the clock runs.
+ *
+ * --cpu pins the calling thread. Threads a benchmark spawns inherit the mask,
+ * so leave it off for multi-threaded benchmarks.
+ */
+
+// ------ OPTIMIZER BARRIERS -------
+
+template <typename T> inline void do_not_optimize(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  const volatile auto *sink = &value;
+  (void)sink;
+#endif
+}
+
+inline void clobber_memory() {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : : "memory");
+#endif
+}
+
+// ------ STATISTICS -------
+
+struct summary {
+  double mean{};
+  double median{};
+  double stddev{};
+  double min{};
+  double max{};
+  double ci95_low{};
+  double ci95_high{};
+};
+
+// Two-sided 95% Student t critical values for 1..30 degrees of freedom.
+inline double t_critical_95(std::size_t dof) {
+  static constexpr double table[] = {
+      12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+      2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+      2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+  if (dof == 0) {
+    return 0.0;
+  }
+  return dof <= std::size(table) ? table[dof - 1] : 1.960;
+}
+
+inline summary summarize(std::vector<double> samples) {
+  summary s;
+  if (samples.empty()) {
+    return s;
+  }
+  std::sort(samples.begin(), samples.end());
+  std::size_t n = samples.size();
+  s.min = samples.front();
+  s.max = samples.back();
+  s.median = n % 2 == 1 ? samples[n / 2]
+                         : (samples[n / 2 - 1] + samples[n / 2]) / 2.0;
+
+  double sum = 0.0;
+  for (double x : samples) {
+    sum += x;
+  }
+  s.mean = sum / static_cast<double>(n);
+
+  double squares = 0.0;
+  for (double x : samples) {
+    squares += (x - s.mean) * (x - s.mean);
+  }
+  s.stddev = n > 1 ? std::sqrt(squares / static_cast<double>(n - 1)) : 0.0;
+
+  double half = t_critical_95(n - 1) * s.stddev /
+                std::sqrt(static_cast<double>(n));
+  s.ci95_low = s.mean - half;
+  s.ci95_high = s.mean + half;
+  return s;
+}
+
+// ------ CPU PINNING -------
+
+// Returns false where pinning is unsupported or the CPU is not available.
+inline bool pin_to_cpu(int cpu) {
+#ifdef __linux__
+  if (cpu < 0 || cpu >= CPU_SETSIZE) {
+    return false;
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(static_cast<std::size_t>(cpu), &set);
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+  (void)cpu;
+  return false;
+#endif
+}
+
+// ------ BENCHMARK STATE -------
+
+class state {
+public:
+  using clock = std::chrono::steady_clock;
+
+  explicit state(std::size_t iterations, perf_counters *counters = nullptr)
+      : iterations_(iterations), counters_(counters) {}
+
+  [[nodiscard]] std::size_t iterations() const noexcept { return iterations_; }
+
+  // Exclude the code between pause() and resume() from the measurement.
+  void pause() {
+    elapsed_ += clock::now() - started_;
+    if (counters_ != nullptr) {
+      counters_->stop();
+    }
+    allocations_ += alloc_scope_.allocations();
+    alloc_bytes_ += alloc_scope_.bytes();
+    running_ = false;
+  }
+  void resume() {
+    running_ = true;
+    alloc_scope_.reset();
+    if (counters_ != nullptr) {
+      counters_->start();
+    }
+    started_ = clock::now();
+  }
+
+  // Called by the runner around the benchmark body.
+  void start() { resume(); }
+  void stop() {
+    if (running_) {
+      pause();
+    }
+  }
+
+  [[nodiscard]] double elapsed_ns() const {
+    return std::chrono::duration<double, std::nano>(elapsed_).count();
+  }
+  [[nodiscard]] std::uint64_t allocations() const noexcept {
+    return allocations_;
+  }
+  [[nodiscard]] std::uint64_t allocated_bytes() const noexcept {
+    return alloc_bytes_;
+  }
+
+private:
+  std::size_t iterations_;
+  perf_counters *counters_;
+  clock::time_point started_{};
+  clock::duration elapsed_{};
+  ds::alloc::scope alloc_scope_;
+  std::uint64_t allocations_{0};
+  std::uint64_t alloc_bytes_{0};
+  bool running_{false};
+};
+
+// ------ RUNNER -------
+
+struct options {
+  std::string filter;
+  std::size_t repetitions{10};
+  std::size_t warmup{2};
+  double min_time_ms{20.0};
+  int cpu{-1};
+  std::string json_path;
+  bool counters{false};
+};
+
+struct result {
+  std::string name;
+  std::size_t iterations{};
+  std::vector<double> ns_per_op;
+  summary stats;
+  counter_values counters_per_op;
+  double allocs_per_op{};
+  double bytes_per_op{};
+};
+
+inline options parse_options(int argc, char **argv) {
+  options opts;
+  for (int i = 1; i < argc; ++i) {
+    std::string_view arg(argv[i]);
+    auto value = [&](std::string_view flag) -> std::string_view {
+      return arg.starts_with(flag) ? arg.substr(flag.size())
+                                   : std::string_view{};
+    };
+    if (auto v = value("--filter="); !v.empty()) {
+      opts.filter = v;
+    } else if (auto r = value("--repetitions="); !r.empty()) {
+      opts.repetitions = std::max<std::size_t>(1, std::stoul(std::string(r)));
+    } else if (auto w = value("--warmup="); !w.empty()) {
+      opts.warmup = std::stoul(std::string(w));
+    } else if (auto m = value("--min-time-ms="); !m.empty()) {
+      opts.min_time_ms = std::stod(std::string(m));
+    } else if (auto c = value("--cpu="); !c.empty()) {
+      opts.cpu = std::stoi(std::string(c));
+    } else if (auto j = value("--json="); !j.empty()) {
+      opts.json_path = j;
+    } else if (arg == "--counters") {
+      opts.counters = true;
+    } else {
+      std::cerr << "ignoring unknown argument " << arg << '\n';
+    }
+  }
+  return opts;
+}
+
+inline std::string json_escape(std::string_view text) {
+  std::string out;
+  out.reserve(text.size());
+  for (char c : text) {
+    switch (c) {
+    case '"':
+      out += "\\\"";
+      break;
+    case '\\':
+      out += "\\\\";
+      break;
+    case '\n':
+      out += "\\n";
+      break;
+    default:
+      out += c;
+    }
+  }
+  return out;
+}
+
+class runner {
+public:
+  using body = std::function<void(state &)>;
+
+  runner(int argc, char **argv, std::string suite)
+      : runner(parse_options(argc, argv), std::move(suite)) {}
+  runner(options opts, std::string suite)
+      : opts_(std::move(opts)), suite_(std::move(suite)) {}
+
+  runner &add(std::string name, body fn) {
+    benchmarks_.push_back({std::move(name), std::move(fn)});
+    return *this;
+  }
+
+  // Runs every benchmark matching the filter; returns a process exit code.
+  int run() {
+    if (opts_.cpu >= 0 && !pin_to_cpu(opts_.cpu)) {
+      std::cerr << "could not pin to cpu " << opts_.cpu << ", continuing\n";
+    }
+    if (opts_.counters) {
+      counters_ = std::make_unique<perf_counters>();
+      if (!counters_->available()) {
+        std::cerr << "hardware counters unavailable (" << counters_->error()
+                  << "), reporting timings only\n";
+        counters_.reset();
+      }
+    }
+    print_header(std::cout);
+    for (auto &[name, fn] : benchmarks_) {
+      if (name.find(opts_.filter) == std::string::npos) {
+        continue;
+      }
+      results_.push_back(measure(name, fn));
+      print_row(std::cout, results_.back());
+    }
+    if (!opts_.json_path.empty()) {
+      std::ofstream out(opts_.json_path);
+      if (!out) {
+        std::cerr << "could not open " << opts_.json_path << '\n';
+        return 1;
+      }
+      write_json(out);
+    }
+    return 0;
+  }
+
+  [[nodiscard]] const std::vector<result> &results() const noexcept {
+    return results_;
+  }
+
+  void write_json(std::ostream &out) const {
+    out << "{\n  \"suite\": \"" << json_escape(suite_) << "\",\n"
+        << "  \"context\": {\"timestamp\": " << std::time(nullptr)
+        << ", \"cpu\": " << opts_.cpu
+        << ", \"repetitions\": " << opts_.repetitions
+        << ", \"warmup\": " << opts_.warmup
+        << ", \"min_time_ms\": " << opts_.min_time_ms << "},\n"
+        << "  \"benchmarks\": [";
+    for (std::size_t i = 0; i < results_.size(); ++i) {
+      const result &r = results_[i];
+      const summary &s = r.stats;
+      out << (i == 0 ? "\n" : ",\n") << "    {\"name\": \""
+          << json_escape(r.name) << "\", \"iterations\": " << r.iterations
+          << ", \"ns_per_op\": {\"mean\": " << s.mean
+          << ", \"median\": " << s.median << ", \"stddev\": " << s.stddev
+          << ", \"min\": " << s.min << ", \"max\": " << s.max
+          << ", \"ci95_low\": " << s.ci95_low
+          << ", \"ci95_high\": " << s.ci95_high << "}, \"samples\": [";
+      for (std::size_t j = 0; j < r.ns_per_op.size(); ++j) {
+        out << (j == 0 ? "" : ", ") << r.ns_per_op[j];
+      }
+      out << "]";
+      if (ds::alloc::hooks_installed()) {
+        out << ", \"allocs_per_op\": " << r.allocs_per_op
+            << ", \"bytes_per_op\": " << r.bytes_per_op;
+      }
+      write_counters_json(out, r.counters_per_op);
+      out << "}";
+    }
+    out << "\n  ]\n}\n";
+  }
+
+private:
+  struct sample {
+    double ns;
+    std::uint64_t allocations;
+    std::uint64_t bytes;
+  };
+
+  static sample run_once(const body &fn, std::size_t iterations,
+                         perf_counters *counters = nullptr) {
+    state st(iterations, counters);
+    st.start();
+    fn(st);
+    st.stop();
+    return {st.elapsed_ns(), st.allocations(), st.allocated_bytes()};
+  }
+
+  result measure(const std::string &name, const body &fn) const {
+    const double min_ns = opts_.min_time_ms * 1e6;
+    std::size_t iterations = 1;
+    for (;;) {
+      double ns = run_once(fn, iterations).ns;
+      if (ns >= min_ns || iterations >= (std::size_t{1} << 40)) {
+        break;
+      }
+      // Aim a little past the target, but never grow by more than 10x.
+      double scale = ns > 0.0 ? 1.4 * min_ns / ns : 10.0;
+      scale = std::clamp(scale, 2.0, 10.0);
+      iterations = static_cast<std::size_t>(
+          std::ceil(static_cast<double>(iterations) * scale));
+    }
+
+    for (std::size_t i = 0; i < opts_.warmup; ++i) {
+      run_once(fn, iterations);
+    }
+
+    result r{name, iterations, {}, {}, {}, 0.0, 0.0};
+    r.ns_per_op.reserve(opts_.repetitions);
+    for (std::size_t i = 0; i < opts_.repetitions; ++i) {
+      if (counters_) {
+        counters_->reset();
+      }
+      sample run = run_once(fn, iterations, counters_.get());
+      r.ns_per_op.push_back(run.ns / static_cast<double>(iterations));
+      r.allocs_per_op += static_cast<double>(run.allocations);
+      r.bytes_per_op += static_cast<double>(run.bytes);
+      if (counters_) {
+        accumulate(r.counters_per_op, counters_->read());
+      }
+    }
+    r.stats = summarize(r.ns_per_op);
+
+    double ops = static_cast<double>(iterations * opts_.repetitions);
+    r.allocs_per_op /= ops;
+    r.bytes_per_op /= ops;
+    for (double &v : r.counters_per_op.value) {
+      v /= ops;
+    }
+    return r;
+  }
+
+  static void accumulate(counter_values &total, const counter_values &run) {
+    for (std::size_t i = 0; i < counter_count; ++i) {
+      if (run.available[i]) {
+        total.value[i] += run.value[i];
+        total.available[i] = true;
+      }
+    }
+  }
+
+  static void write_counters_json(std::ostream &out,
+                                  const counter_values &values) {
+    bool first = true;
+    for (std::size_t i = 0; i < counter_count; ++i) {
+      if (!values.available[i]) {
+        continue;
+      }
+      out << (first ? ", \"counters_per_op\": {" : ", ") << '"'
+          << counter_names[i] << "\": " << values.value[i];
+      first = false;
+    }
+    if (!first) {
+      out << '}';
+    }
+  }
+
+  void print_header(std::ostream &out) const {
+    char line[200];
+    std::snprintf(line, sizeof(line), "%-40s %12s %12s %12s %12s %8s",
+                  suite_.c_str(), "iterations", "mean ns/op", "+/- 95%",
+                  "median", "cv %");
+    out << line;
+    if (ds::alloc::hooks_installed()) {
+      std::snprintf(line, sizeof(line), " %10s %10s", "allocs/op", "bytes/op");
+      out << line;
+    }
+    out << '\n';
+  }
+
+  static void print_row(std::ostream &out, const result &r) {
+    const summary &s = r.stats;
+    double cv = s.mean > 0.0 ? 100.0 * s.stddev / s.mean : 0.0;
+    char line[200];
+    std::snprintf(line, sizeof(line), "%-40s %12zu %12.2f %12.2f %12.2f %8.2f",
+                  r.name.c_str(), r.iterations, s.mean, s.ci95_high - s.mean,
+                  s.median, cv);
+    out << line;
+    if (ds::alloc::hooks_installed()) {
+      std::snprintf(line, sizeof(line), " %10.2f %10.1f", r.allocs_per_op,
+                    r.bytes_per_op);
+      out << line;
+    }
+    out << '\n';
+    print_counters(out, r.counters_per_op);
+  }
+
+  // One indented line under the timing row, e.g.
+  //   cycles 41.2  instructions 96.0  ipc 2.33  l1d_misses 0.01 ...
+  static void print_counters(std::ostream &out, const counter_values &c) {
+    std::string text;
+    char field[64];
+    for (std::size_t i = 0; i < counter_count; ++i) {
+      if (!c.available[i]) {
+        continue;
+      }
+      std::snprintf(field, sizeof(field), "  %s %.2f",
+                    std::string(counter_names[i]).c_str(), c.value[i]);
+      text += field;
+      if (static_cast<counter>(i) == counter::instructions &&
+          c.has(counter::cycles) && c[counter::cycles] > 0.0) {
+        std::snprintf(field, sizeof(field), "  ipc %.2f",
+                      c[counter::instructions] / c[counter::cycles]);
+        text += field;
+      }
+    }
+    if (!text.empty()) {
+      out << "  " << text << '\n';
+    }
+  }
+
+  options opts_;
+  std::string suite_;
+  std::vector<std::pair<std::string, body>> benchmarks_;
+  std::vector<result> results_;
+  std::unique_ptr<perf_counters> counters_;
+};
+
+} // namespace ds::bench
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace ds::bench {
+
+/*
+ * perf_counters
+ * Hardware and scheduler counters around a benchmark region, read through
+ * perf_event_open(2).
+ *
+ *   cycles  instructions  l1d_misses  llc_misses  branch_misses  ctx_switches
+ *
+ * 1) every event is opened on its own, disabled, inherited by threads the
+ *    benchmark spawns; an event the kernel refuses is simply left out
+ * 2) start()/stop() enable and disable all open events together
+ * 3) read() scales each count by time_enabled / time_running, so values stay
+ *    meaningful when the PMU multiplexes more events than it has registers
+ *
+ * Containers, VMs without a virtual PMU and perf_event_paranoid > 2 commonly
+ * refuse some or all events; available() and error() report that instead of
+ * failing the run.
+ */
+
+enum class counter : std::size_t {
+  cycles,
+  instructions,
+  l1d_misses,
+  llc_misses,
+  branch_misses,
+  context_switches,
+};
+
+inline constexpr std::size_t counter_count = 6;
+
+inline constexpr std::array<std::string_view, counter_count> counter_names = {
+    "cycles",     "instructions",  "l1d_misses",
+    "llc_misses", "branch_misses", "context_switches"};
+
+struct counter_values {
+  std::array<double, counter_count> value{};
+  std::array<bool, counter_count> available{};
+
+  [[nodiscard]] double operator[](counter c) const {
+    return value[static_cast<std::size_t>(c)];
+  }
+  [[nodiscard]] bool has(counter c) const {
+    return available[static_cast<std::size_t>(c)];
+  }
+};
+
+class perf_counters {
+public:
+  perf_counters() {
+    fds_.fill(-1);
+#ifdef __linux__
+    for (std::size_t i = 0; i < counter_count; ++i) {
+      fds_[i] = open_event(static_cast<counter>(i));
+    }
+    if (!available()) {
+      error_ = "perf_event_open failed: ";
+      error_ += std::strerror(last_errno_);
+    }
+#else
+    error_ = "perf_event_open is Linux only";
+#endif
+  }
+
+  ~perf_counters() {
+#ifdef __linux__
+    for (int fd : fds_) {
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+#endif
+  }
+
+  perf_counters(const perf_counters &) = delete;
+  perf_counters &operator=(const perf_counters &) = delete;
+
+  // True when at least one event could be opened.
+  [[nodiscard]] bool available() const noexcept {
+    for (int fd : fds_) {
+      if (fd >= 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  [[nodiscard]] bool available(counter c) const noexcept {
+    return fds_[static_cast<std::size_t>(c)] >= 0;
+  }
+
+  [[nodiscard]] const std::string &error() const noexcept { return error_; }
+
+  void reset() {
+#ifdef __linux__
+    control(PERF_EVENT_IOC_RESET);
+#endif
+  }
+  void start() {
+#ifdef __linux__
+    control(PERF_EVENT_IOC_ENABLE);
+#endif
+  }
+  void stop() {
+#ifdef __linux__
+    control(PERF_EVENT_IOC_DISABLE);
+#endif
+  }
+
+  [[nodiscard]] counter_values read() const {
+    counter_values out;
+#ifdef __linux__
+    for (std::size_t i = 0; i < counter_count; ++i) {
+      if (fds_[i] < 0) {
+        continue;
+      }
+      // PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING
+      std::uint64_t buffer[3] = {};
+      if (::read(fds_[i], buffer, sizeof(buffer)) !=
+          static_cast<ssize_t>(sizeof(buffer))) {
+        continue;
+      }
+      double count = static_cast<double>(buffer[0]);
+      if (buffer[2] != 0 && buffer[2] < buffer[1]) {
+        count *= static_cast<double>(buffer[1]) /
+                 static_cast<double>(buffer[2]);
+      }
+      out.value[i] = count;
+      out.available[i] = true;
+    }
+#endif
+    return out;
+  }
+
+private:
+#ifdef __linux__
+  int open_event(counter c) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_hv = 1;
+    attr.read_format =
+        PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    auto cache_miss = [](std::uint64_t cache) -> std::uint64_t {
+      return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+             (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    };
+    switch (c) {
+    case counter::cycles:
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = PERF_COUNT_HW_CPU_CYCLES;
+      break;
+    case counter::instructions:
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+      break;
+    case counter::l1d_misses:
+      attr.type = PERF_TYPE_HW_CACHE;
+      attr.config = cache_miss(PERF_COUNT_HW_CACHE_L1D);
+      break;
+    case counter::llc_misses:
+      attr.type = PERF_TYPE_HW_CACHE;
+      attr.config = cache_miss(PERF_COUNT_HW_CACHE_LL);
+      break;
+    case counter::branch_misses:
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+      break;
+    case counter::context_switches:
+      attr.type = PERF_TYPE_SOFTWARE;
+      attr.config = PERF_COUNT_SW_CONTEXT_SWITCHES;
+      break;
+    }
+
+    // Ask for kernel-side counts first (context switches happen there), then
+    // fall back to user space only for perf_event_paranoid >= 2.
+    for (int exclude_kernel = 0; exclude_kernel <= 1; ++exclude_kernel) {
+      attr.exclude_kernel = static_cast<std::uint64_t>(exclude_kernel) & 1U;
+      long fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0UL);
+      if (fd >= 0) {
+        return static_cast<int>(fd);
+      }
+      last_errno_ = errno;
+    }
+    return -1;
+  }
+
+  void control(unsigned long request) {
+    for (int fd : fds_) {
+      if (fd >= 0) {
+        ioctl(fd, request, 0);
+      }
+    }
+  }
+#endif
+
+  std::array<int, counter_count> fds_{};
+  int last_errno_{0};
+  std::string error_;
+};
+
+} // namespace ds::bench
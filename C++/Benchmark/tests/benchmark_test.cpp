@@ -0,0 +1,168 @@
+#include "benchmark.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+bool near(double a, double b) { return std::abs(a - b) < 1e-3; }
+
+} // namespace
+
+// ------ STATISTICS -------
+
+TEST_CASE("summarize computes order statistics", "[stats]") {
+  auto s = ds::bench::summarize({4.0, 1.0, 3.0, 2.0});
+  REQUIRE(s.min == 1.0);
+  REQUIRE(s.max == 4.0);
+  REQUIRE(near(s.median, 2.5));
+  REQUIRE(near(s.mean, 2.5));
+  REQUIRE(near(s.stddev, 1.2909944));
+}
+
+TEST_CASE("confidence interval uses the t distribution", "[stats]") {
+  auto s = ds::bench::summarize({10.0, 12.0});
+  // mean 11, stddev sqrt(2), t(1) = 12.706
+  REQUIRE(near(s.ci95_high - s.mean, 12.706));
+  REQUIRE(near(s.mean - s.ci95_low, 12.706));
+
+  auto single = ds::bench::summarize({5.0});
+  REQUIRE(single.ci95_low == single.ci95_high);
+}
+
+// ------ STATE -------
+
+TEST_CASE("paused time is excluded", "[state]") {
+  ds::bench::state st(1);
+  st.start();
+  st.pause();
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  st.resume();
+  st.stop();
+  REQUIRE(st.elapsed_ns() < 20e6);
+}
+
+// ------ RUNNER -------
+
+TEST_CASE("runner calibrates, repeats and filters", "[runner]") {
+  ds::bench::options opts;
+  opts.repetitions = 3;
+  opts.warmup = 1;
+  opts.min_time_ms = 1.0;
+  opts.filter = "keep";
+
+  std::size_t skipped_calls = 0;
+  ds::bench::runner r(opts, "test");
+  r.add("keep/sum", [](ds::bench::state &st) {
+    std::size_t sum = 0;
+    for (std::size_t i = 0; i < st.iterations(); ++i) {
+      sum += i;
+      ds::bench::do_not_optimize(sum);
+    }
+  });
+  r.add("skip", [&](ds::bench::state &) { ++skipped_calls; });
+  REQUIRE(r.run() == 0);
+
+  REQUIRE(skipped_calls == 0);
+  REQUIRE(r.results().size() == 1);
+  const auto &res = r.results().front();
+  REQUIRE(res.name == "keep/sum");
+  REQUIRE(res.ns_per_op.size() == 3);
+  REQUIRE(res.iterations > 1);
+}
+
+TEST_CASE("json report carries every sample", "[runner]") {
+  ds::bench::options opts;
+  opts.repetitions = 2;
+  opts.warmup = 0;
+  opts.min_time_ms = 0.1;
+  ds::bench::runner r(opts, "suite \"q\"");
+  r.add("noop", [](ds::bench::state &) {});
+  r.run();
+
+  std::ostringstream out;
+  r.write_json(out);
+  std::string json = out.str();
+  REQUIRE(json.find("\"suite\": \"suite \\\"q\\\"\"") != std::string::npos);
+  REQUIRE(json.find("\"name\": \"noop\"") != std::string::npos);
+  REQUIRE(json.find("\"ci95_high\"") != std::string::npos);
+}
+
+TEST_CASE("command line options are parsed", "[runner]") {
+  std::string args[] = {"bench", "--repetitions=7", "--cpu=0",
+                        "--json=out.json", "--filter=queue"};
+  std::vector<char *> argv;
+  for (auto &a : args) {
+    argv.push_back(a.data());
+  }
+  auto opts =
+      ds::bench::parse_options(static_cast<int>(argv.size()), argv.data());
+  REQUIRE(opts.repetitions == 7);
+  REQUIRE(opts.cpu == 0);
+  REQUIRE(opts.json_path == "out.json");
+  REQUIRE(opts.filter == "queue");
+}
+
+// ------ PERF COUNTERS -------
+
+TEST_CASE("perf counters either count or explain why not", "[counters]") {
+  ds::bench::perf_counters counters;
+  if (!counters.available()) {
+    REQUIRE_FALSE(counters.error().empty());
+    auto values = counters.read();
+    REQUIRE_FALSE(values.has(ds::bench::counter::instructions));
+    return;
+  }
+  counters.reset();
+  counters.start();
+  std::size_t sum = 0;
+  for (std::size_t i = 0; i < 100000; ++i) {
+    sum += i;
+    ds::bench::do_not_optimize(sum);
+  }
+  counters.stop();
+  auto values = counters.read();
+  if (values.has(ds::bench::counter::instructions)) {
+    REQUIRE(values[ds::bench::counter::instructions] > 100000.0);
+  }
+}
+
+TEST_CASE("runner with counters still reports timings", "[counters]") {
+  ds::bench::options opts;
+  opts.repetitions = 2;
+  opts.warmup = 0;
+  opts.min_time_ms = 0.1;
+  opts.counters = true;
+  ds::bench::runner r(opts, "counters");
+  r.add("noop", [](ds::bench::state &) {});
+  REQUIRE(r.run() == 0);
+  REQUIRE(r.results().size() == 1);
+  REQUIRE(r.results().front().ns_per_op.size() == 2);
+}
+
+// ------ ALLOCATIONS -------
+
+TEST_CASE("allocations per op exclude paused setup", "[alloc]") {
+  ds::bench::options opts;
+  opts.repetitions = 2;
+  opts.warmup = 0;
+  opts.min_time_ms = 0.1;
+  ds::bench::runner r(opts, "alloc");
+  r.add("one_alloc_per_op", [](ds::bench::state &st) {
+    st.pause();
+    std::vector<int> setup(1000);
+    st.resume();
+    for (std::size_t i = 0; i < st.iterations(); ++i) {
+      auto p = std::make_unique<std::uint64_t>(i);
+      ds::bench::do_not_optimize(p.get());
+    }
+  });
+  r.run();
+  REQUIRE(near(r.results().front().allocs_per_op, 1.0));
+  REQUIRE(near(r.results().front().bytes_per_op, 8.0));
+}
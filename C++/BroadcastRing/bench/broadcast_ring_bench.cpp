@@ -0,0 +1,66 @@
+#include "benchmark.hpp"
+#include "broadcast_ring.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// One op is one publish seen by every subscriber; compare the rows to see
+// that a publish does not get dearer as subscribers are added.
+template <ds::overflow_policy Policy>
+void fan_out(ds::bench::state &st, std::size_t subscribers) {
+  ds::broadcast_ring<std::uint64_t, Policy> ring(1024);
+  std::vector<decltype(ring.subscribe())> consumers;
+  for (std::size_t i = 0; i < subscribers; ++i) {
+    consumers.push_back(ring.subscribe());
+  }
+  std::atomic<bool> done{false};
+  std::vector<std::thread> threads;
+  for (auto &c : consumers) {
+    threads.emplace_back([&] {
+      std::uint64_t sum = 0;
+      while (!done.load(std::memory_order_relaxed)) {
+        if (c.poll([&](std::uint64_t v) { sum += v; }) == 0) {
+          std::this_thread::yield();
+        }
+      }
+      ds::bench::do_not_optimize(sum);
+    });
+  }
+  for (std::size_t i = 0; i < st.iterations(); ++i) {
+    ring.publish(i);
+  }
+  st.pause();
+  done.store(true);
+  for (auto &t : threads) {
+    t.join();
+  }
+  st.resume();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  ds::bench::runner runner(argc, argv, "broadcast_ring");
+
+  runner.add("publish/no_subscribers", [](ds::bench::state &st) {
+    fan_out<ds::overflow_policy::block>(st, 0);
+  });
+  runner.add("publish/block/1_subscriber", [](ds::bench::state &st) {
+    fan_out<ds::overflow_policy::block>(st, 1);
+  });
+  runner.add("publish/block/4_subscribers", [](ds::bench::state &st) {
+    fan_out<ds::overflow_policy::block>(st, 4);
+  });
+  runner.add("publish/overwrite/1_subscriber", [](ds::bench::state &st) {
+    fan_out<ds::overflow_policy::overwrite>(st, 1);
+  });
+  runner.add("publish/overwrite/4_subscribers", [](ds::bench::state &st) {
+    fan_out<ds::overflow_policy::overwrite>(st, 4);
+  });
+
+  return runner.run();
+}
@@ -0,0 +1,359 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace ds {
+
+/*
+ * broadcast_ring<T, Policy>
+ * Single producer, any number of consumers, and every consumer sees every
+ * element (thread_safe_queue hands each element to exactly one).
+ *
+ *                        head_ (next sequence to publish)
+ *                          v
+ *   slots  [ 8 | 9 | 10 | 11 | 4 | 5 | 6 | 7 ]     capacity 8
+ *                 ^              ^
+ *            consumer B     consumer A (slowest)
+ *
+ * An element is written once, into slot (sequence & mask). Consumers read
+ * it in place through their own cursor, so nothing is copied or counted per
+ * subscriber and a publish costs the same with 1 or 100 of them.
+ *
+ *   block      the producer may not lap the slowest consumer. It caches
+ *              that consumer's position and only rescans the cursors when
+ *              the cache says the ring is full, so the scan is amortised
+ *              over `capacity` publishes. Consumers read slots by reference.
+ *
+ *   overwrite  the producer never waits. Each slot carries a sequence
+ *              stamp; a consumer copies the element out and re-checks the
+ *              stamp, and a consumer that was lapped skips to the oldest
+ *              element still in the ring and counts what it lost. T must be
+ *              trivially copyable, and is stored as relaxed atomic words so
+ *              the torn reads the stamp rejects are still well defined.
+ *
+ * Subscribing and unsubscribing take a mutex, as does the producer's rare
+ * rescan; the publish and read paths do not.
+ */
+
+enum class overflow_policy { block, overwrite };
+
+template <typename T, overflow_policy Policy = overflow_policy::block>
+class broadcast_ring {
+  static_assert(Policy == overflow_policy::block ||
+                    std::is_trivially_copyable_v<T>,
+                "overwrite mode copies elements word by word");
+
+  static constexpr std::size_t cache_line = 64;
+
+  struct alignas(cache_line) cursor {
+    std::atomic<std::uint64_t> next{0};
+    bool active{false};
+  };
+
+  // ----- SLOTS -----
+  struct plain_slot {
+    T value{};
+  };
+
+  struct stamped_slot {
+    static constexpr std::size_t words =
+        (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+    static constexpr std::uint64_t writing = ~std::uint64_t{0};
+
+    std::atomic<std::uint64_t> stamp{0}; // sequence + 1 once written
+    std::array<std::atomic<std::uint64_t>, words> data{};
+
+    void store(std::uint64_t sequence, const T &value) {
+      std::array<std::uint64_t, words> raw{};
+      std::memcpy(raw.data(), &value, sizeof(T));
+      stamp.store(writing, std::memory_order_relaxed);
+      // Release on every word: a reader that sees any new word also sees
+      // the `writing` stamp when it re-checks.
+      for (std::size_t i = 0; i < words; ++i) {
+        data[i].store(raw[i], std::memory_order_release);
+      }
+      stamp.store(sequence + 1, std::memory_order_release);
+    }
+
+    bool load(std::uint64_t sequence, T &out) const {
+      if (stamp.load(std::memory_order_acquire) != sequence + 1) {
+        return false;
+      }
+      std::array<std::uint64_t, words> raw{};
+      for (std::size_t i = 0; i < words; ++i) {
+        raw[i] = data[i].load(std::memory_order_acquire);
+      }
+      if (stamp.load(std::memory_order_relaxed) != sequence + 1) {
+        return false;
+      }
+      std::memcpy(&out, raw.data(), sizeof(T));
+      return true;
+    }
+  };
+
+  using slot = std::conditional_t<Policy == overflow_policy::block,
+                                  plain_slot, stamped_slot>;
+
+public:
+  class consumer;
+
+  // Capacity is rounded up to a power of two.
+  explicit broadcast_ring(std::size_t capacity,
+                          std::size_t max_consumers = 64)
+      : mask_(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1),
+        slots_(std::make_unique<slot[]>(mask_ + 1)),
+        cursors_(std::make_unique<cursor[]>(max_consumers)),
+        max_consumers_(max_consumers) {}
+
+  broadcast_ring(const broadcast_ring &) = delete;
+  broadcast_ring &operator=(const broadcast_ring &) = delete;
+
+  [[nodiscard]] std::size_t capacity() const noexcept { return mask_ + 1; }
+
+  // Elements published so far.
+  [[nodiscard]] std::uint64_t published() const noexcept {
+    return head_.load(std::memory_order_acquire);
+  }
+
+  // ----- PRODUCER API -----
+
+  // Block mode: false if the slowest consumer is a full ring behind.
+  // Overwrite mode: always succeeds.
+  bool try_publish(const T &value) {
+    return try_publish_with([&](T &slot_value) { slot_value = value; });
+  }
+
+  // Spins (yielding) while the slowest consumer holds the ring full.
+  void publish(const T &value) {
+    while (!try_publish(value)) {
+      std::this_thread::yield();
+    }
+  }
+
+  // `fill(T&)` writes the element; in block mode straight into its slot.
+  template <typename Fill> bool try_publish_with(Fill &&fill) {
+    std::uint64_t sequence = head_cache_;
+    if constexpr (Policy == overflow_policy::block) {
+      if (sequence - gate_ > mask_) {
+        gate_ = slowest(sequence);
+        if (sequence - gate_ > mask_) {
+          return false;
+        }
+      }
+      fill(slots_[sequence & mask_].value);
+    } else {
+      T value{};
+      fill(value);
+      slots_[sequence & mask_].store(sequence, value);
+    }
+    head_cache_ = sequence + 1;
+    head_.store(sequence + 1, std::memory_order_release);
+    return true;
+  }
+
+  // ----- SUBSCRIPTION -----
+
+  // The consumer sees everything published after this call. Throws
+  // std::length_error when max_consumers are already subscribed.
+  [[nodiscard]] consumer subscribe() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (std::size_t i = 0; i < max_consumers_; ++i) {
+      cursor &c = cursors_[i];
+      if (!c.active) {
+        c.next.store(head_.load(std::memory_order_acquire),
+                     std::memory_order_relaxed);
+        c.active = true;
+        return consumer(this, &c);
+      }
+    }
+    throw std::length_error("broadcast_ring: too many consumers");
+  }
+
+  class consumer {
+  public:
+    consumer(consumer &&other) noexcept
+        : ring_(std::exchange(other.ring_, nullptr)),
+          cursor_(std::exchange(other.cursor_, nullptr)),
+          next_(other.next_), head_(other.head_), dropped_(other.dropped_) {}
+    consumer &operator=(consumer &&other) noexcept {
+      consumer(std::move(other)).swap(*this);
+      return *this;
+    }
+    consumer(const consumer &) = delete;
+    consumer &operator=(const consumer &) = delete;
+
+    ~consumer() {
+      if (ring_ != nullptr) {
+        ring_->unsubscribe(cursor_);
+      }
+    }
+
+    // Elements published but not yet read (may exceed capacity when lapped
+    // in overwrite mode).
+    [[nodiscard]] std::uint64_t lag() const noexcept {
+      return ring_->published() - next_;
+    }
+
+    // Elements this consumer lost to the producer lapping it.
+    [[nodiscard]] std::uint64_t dropped() const noexcept { return dropped_; }
+
+    // Block mode only: the next element, read in place. Valid until
+    // advance().
+    [[nodiscard]] const T *peek()
+      requires(Policy == overflow_policy::block)
+    {
+      if (!available()) {
+        return nullptr;
+      }
+      return &ring_->slots_[next_ & ring_->mask_].value;
+    }
+
+    void advance()
+      requires(Policy == overflow_policy::block)
+    {
+      ++next_;
+      cursor_->next.store(next_, std::memory_order_release);
+    }
+
+    bool try_read(T &out) {
+      if constexpr (Policy == overflow_policy::block) {
+        const T *value = peek();
+        if (value == nullptr) {
+          return false;
+        }
+        out = *value;
+        advance();
+        return true;
+      } else {
+        while (available()) {
+          if (ring_->slots_[next_ & ring_->mask_].load(next_, out)) {
+            ++next_;
+            return true;
+          }
+          skip_lapped();
+        }
+        return false;
+      }
+    }
+
+    // Spins (yielding) until an element arrives.
+    void read(T &out) {
+      while (!try_read(out)) {
+        std::this_thread::yield();
+      }
+    }
+
+    // Hands every available element to fn(const T&); in block mode the
+    // cursor is published once for the whole batch. Returns the count.
+    template <typename Fn> std::size_t poll(Fn &&fn) {
+      std::size_t count = 0;
+      if constexpr (Policy == overflow_policy::block) {
+        while (available()) {
+          fn(static_cast<const T &>(
+              ring_->slots_[next_ & ring_->mask_].value));
+          ++next_;
+          ++count;
+        }
+        if (count != 0) {
+          cursor_->next.store(next_, std::memory_order_release);
+        }
+      } else {
+        T value{};
+        while (try_read(value)) {
+          fn(static_cast<const T &>(value));
+          ++count;
+        }
+      }
+      return count;
+    }
+
+  private:
+    friend class broadcast_ring;
+
+    consumer(broadcast_ring *ring, cursor *c)
+        : ring_(ring), cursor_(c),
+          next_(c->next.load(std::memory_order_relaxed)), head_(next_) {}
+
+    void swap(consumer &other) noexcept {
+      std::swap(ring_, other.ring_);
+      std::swap(cursor_, other.cursor_);
+      std::swap(next_, other.next_);
+      std::swap(head_, other.head_);
+      std::swap(dropped_, other.dropped_);
+    }
+
+    // Re-reads the producer's head only when the cached one is used up.
+    bool available() {
+      if (next_ == head_) {
+        head_ = ring_->head_.load(std::memory_order_acquire);
+      }
+      if constexpr (Policy == overflow_policy::overwrite) {
+        if (head_ - next_ > ring_->mask_ + 1) {
+          skip_lapped();
+        }
+      }
+      return next_ != head_;
+    }
+
+    // Overwrite mode: jump to the oldest element the ring still holds.
+    void skip_lapped() {
+      head_ = ring_->head_.load(std::memory_order_acquire);
+      std::uint64_t oldest = head_ - std::min<std::uint64_t>(head_, ring_->mask_);
+      if (oldest > next_) {
+        dropped_ += oldest - next_;
+        next_ = oldest;
+      }
+    }
+
+    broadcast_ring *ring_;
+    cursor *cursor_;
+    std::uint64_t next_;
+    std::uint64_t head_;
+    std::uint64_t dropped_{0};
+  };
+
+private:
+  // Position of the slowest consumer, or `head` when there are none.
+  std::uint64_t slowest(std::uint64_t head) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::uint64_t min = head;
+    for (std::size_t i = 0; i < max_consumers_; ++i) {
+      if (cursors_[i].active) {
+        min = std::min(min, cursors_[i].next.load(std::memory_order_acquire));
+      }
+    }
+    return min;
+  }
+
+  void unsubscribe(cursor *c) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    c->active = false;
+  }
+
+  std::size_t mask_;
+  std::unique_ptr<slot[]> slots_;
+  std::unique_ptr<cursor[]> cursors_;
+  std::size_t max_consumers_;
+  std::mutex mutex_;
+
+  // Producer-owned; head_ on its own line so consumers polling it do not
+  // share a line with the producer's private state.
+  alignas(cache_line) std::uint64_t head_cache_{0};
+  std::uint64_t gate_{0};
+  alignas(cache_line) std::atomic<std::uint64_t> head_{0};
+};
+
+} // namespace ds
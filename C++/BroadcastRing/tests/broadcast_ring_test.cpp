@@ -0,0 +1,153 @@
+#include "broadcast_ring.hpp"
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct tick {
+  std::uint64_t sequence;
+  double price;
+};
+
+} // namespace
+
+// ------ BLOCK MODE -------
+
+TEST_CASE("every consumer sees every element in order", "[block]") {
+  ds::broadcast_ring<std::uint64_t> ring(8);
+  auto a = ring.subscribe();
+  auto b = ring.subscribe();
+  for (std::uint64_t i = 0; i < 5; ++i) {
+    REQUIRE(ring.try_publish(i));
+  }
+  std::vector<std::uint64_t> seen_a;
+  std::vector<std::uint64_t> seen_b;
+  REQUIRE(a.poll([&](std::uint64_t v) { seen_a.push_back(v); }) == 5);
+  std::uint64_t v = 0;
+  while (b.try_read(v)) {
+    seen_b.push_back(v);
+  }
+  REQUIRE(seen_a == std::vector<std::uint64_t>{0, 1, 2, 3, 4});
+  REQUIRE(seen_b == seen_a);
+}
+
+TEST_CASE("the slowest consumer gates the producer", "[block]") {
+  ds::broadcast_ring<int> ring(4);
+  auto fast = ring.subscribe();
+  auto slow = ring.subscribe();
+  for (int i = 0; i < 4; ++i) {
+    REQUIRE(ring.try_publish(i));
+  }
+  fast.poll([](int) {});
+  REQUIRE_FALSE(ring.try_publish(4));
+
+  REQUIRE(*slow.peek() == 0);
+  slow.advance();
+  REQUIRE(ring.try_publish(4));
+  REQUIRE_FALSE(ring.try_publish(5));
+}
+
+TEST_CASE("peek reads the slot in place", "[block]") {
+  ds::broadcast_ring<tick> ring(4);
+  auto a = ring.subscribe();
+  auto b = ring.subscribe();
+  REQUIRE(ring.try_publish_with([](tick &t) { t = {7, 101.5}; }));
+  REQUIRE(a.peek() == b.peek());
+  REQUIRE(a.peek()->price == 101.5);
+  REQUIRE(a.lag() == 1);
+}
+
+TEST_CASE("unsubscribing releases the gate and the slot", "[block]") {
+  ds::broadcast_ring<int> ring(2, 1);
+  {
+    auto c = ring.subscribe();
+    REQUIRE_THROWS_AS(ring.subscribe(), std::length_error);
+    REQUIRE(ring.try_publish(1));
+    REQUIRE(ring.try_publish(2));
+    REQUIRE_FALSE(ring.try_publish(3));
+  }
+  REQUIRE(ring.try_publish(3));
+  auto late = ring.subscribe();
+  REQUIRE(late.peek() == nullptr); // starts at the current head
+}
+
+TEST_CASE("threaded fan-out delivers everything to everyone", "[block]") {
+  constexpr std::uint64_t count = 20000;
+  ds::broadcast_ring<std::uint64_t> ring(64);
+  std::vector<decltype(ring.subscribe())> consumers;
+  for (int i = 0; i < 3; ++i) {
+    consumers.push_back(ring.subscribe());
+  }
+  std::vector<std::uint64_t> sums(consumers.size(), 0);
+  std::vector<std::thread> threads;
+  for (std::size_t i = 0; i < consumers.size(); ++i) {
+    threads.emplace_back([&, i] {
+      std::uint64_t expected = 0;
+      while (expected < count) {
+        consumers[i].poll([&](std::uint64_t v) {
+          REQUIRE(v == expected);
+          ++expected;
+          sums[i] += v;
+        });
+        std::this_thread::yield();
+      }
+    });
+  }
+  for (std::uint64_t i = 0; i < count; ++i) {
+    ring.publish(i);
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+  for (auto sum : sums) {
+    REQUIRE(sum == count * (count - 1) / 2);
+  }
+}
+
+// ------ OVERWRITE MODE -------
+
+TEST_CASE("a lapped consumer skips ahead and counts drops", "[overwrite]") {
+  ds::broadcast_ring<tick, ds::overflow_policy::overwrite> ring(4);
+  auto c = ring.subscribe();
+  for (std::uint64_t i = 0; i < 10; ++i) {
+    REQUIRE(ring.try_publish({i, 1.0}));
+  }
+  std::vector<std::uint64_t> seen;
+  c.poll([&](const tick &t) { seen.push_back(t.sequence); });
+  REQUIRE(seen == std::vector<std::uint64_t>{7, 8, 9});
+  REQUIRE(c.dropped() == 7);
+}
+
+TEST_CASE("overwrite readers never see torn elements", "[overwrite]") {
+  struct wide {
+    std::uint64_t a, b, c, d;
+  };
+  ds::broadcast_ring<wide, ds::overflow_policy::overwrite> ring(8);
+  auto c = ring.subscribe();
+  std::thread reader([&] {
+    wide w{};
+    std::uint64_t last = 0;
+    std::uint64_t got = 0;
+    while (last + 1 < 50000) {
+      if (c.try_read(w)) {
+        REQUIRE(w.b == w.a);
+        REQUIRE(w.c == w.a);
+        REQUIRE(w.d == w.a);
+        REQUIRE((got == 0 || w.a > last));
+        last = w.a;
+        ++got;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+    REQUIRE(got + c.dropped() == 50000);
+  });
+  for (std::uint64_t i = 0; i < 50000; ++i) {
+    ring.publish({i, i, i, i});
+  }
+  reader.join();
+}
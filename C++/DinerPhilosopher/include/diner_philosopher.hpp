@@ -1,31 +1,48 @@
 #pragma once
 
+#include "profiled_mutex.hpp"
+
 #include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <cstddef>
+#include <deque>
 #include <iostream>
 #include <mutex>
 #include <random>
+#include <string_view>
 #include <thread>
+#include <type_traits>
 #include <vector>
 
-
-class DinerPhilosopher {
+// Mutex may be ds::profiled_timed_mutex to record fork contention (see
+// ProfiledDinerPhilosopher below).
+template <typename Mutex = std::timed_mutex> class BasicDinerPhilosopher {
 public:
-  explicit DinerPhilosopher(int n) : n_(n), forks_(n), running_(true) {}
+  explicit BasicDinerPhilosopher(int n) : n_(n), running_(true) {
+    for (int i = 0; i < n_; i++) {
+      // Every fork reports under one lock site, so the registry shows how
+      // much time philosophers spend waiting on their neighbours.
+      if constexpr (std::is_constructible_v<Mutex, std::string_view>) {
+        forks_.emplace_back("DinerPhilosopher::fork");
+      } else {
+        forks_.emplace_back();
+      }
+    }
+  }
 
-  ~DinerPhilosopher() { stop(); }
+  ~BasicDinerPhilosopher() { stop(); }
 
-  DinerPhilosopher(const DinerPhilosopher &) = delete;
+  BasicDinerPhilosopher(const BasicDinerPhilosopher &) = delete;
 
-  DinerPhilosopher &operator=(const DinerPhilosopher &) = delete;
+  BasicDinerPhilosopher &operator=(const BasicDinerPhilosopher &) = delete;
 
   void start() {
     if (!philosophers_.empty())
       return;
     running_ = true;
     for (int i = 0; i < n_; i++) {
-      philosophers_.emplace_back(&DinerPhilosopher::philosopher, this, i);
+      philosophers_.emplace_back(&BasicDinerPhilosopher::philosopher, this, i);
     }
   }
 
@@ -46,13 +63,13 @@ public:
 
 private:
   void philosopher(int id) {
-    std::mt19937 rng(id);
+    std::mt19937 rng(static_cast<std::mt19937::result_type>(id));
     std::uniform_int_distribution<int> dist(1, 10);
     int left = id;
     int right = (id + 1) % n_;
 
-    int first = std::min(left, right);
-    int second = std::max(left, right);
+    auto first = static_cast<std::size_t>(std::min(left, right));
+    auto second = static_cast<std::size_t>(std::max(left, right));
 
     int eat_count = 0;
 
@@ -79,7 +96,11 @@ private:
   }
 
   int n_;
-  std::vector<std::timed_mutex> forks_;
+  std::deque<Mutex> forks_;
   std::vector<std::thread> philosophers_;
   std::atomic<bool> running_;
 };
+
+using DinerPhilosopher = BasicDinerPhilosopher<>;
+using ProfiledDinerPhilosopher =
+    BasicDinerPhilosopher<ds::profiled_timed_mutex>;
@@ -0,0 +1,114 @@
+#include "benchmark.hpp"
+#include "book_builder.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+// One op is one message, so messages/sec = 1e9 / (ns/op).
+
+namespace {
+
+// A session-like mix over 64 symbols: mostly adds and deletes near the
+// touch, with executions, partial cancels and replaces.
+const ds::itch::writer &capture(std::size_t messages) {
+  static std::map<std::size_t, ds::itch::writer> cache;
+  auto [it, inserted] = cache.try_emplace(messages);
+  if (!inserted) {
+    return it->second;
+  }
+  ds::itch::writer &w = it->second;
+  std::mt19937_64 rng(42);
+  struct live {
+    std::uint64_t ref;
+    std::uint16_t locate;
+  };
+  std::vector<live> orders;
+  std::uint64_t next_ref = 1;
+  for (std::uint16_t s = 1; s <= 64; ++s) {
+    w.stock_directory(s, "SYM" + std::to_string(s));
+  }
+  for (std::size_t i = 64; i < messages; ++i) {
+    auto roll = rng() % 100;
+    if (orders.size() < 1000 || roll < 45) {
+      auto locate = static_cast<std::uint16_t>(1 + rng() % 64);
+      bool buy = rng() % 2 == 0;
+      auto offset = static_cast<std::uint32_t>(rng() % 20) * 100;
+      std::uint32_t price = buy ? 100'0000 - offset : 100'0100 + offset;
+      w.add_order(locate, next_ref, buy, 100, "", price);
+      orders.push_back({next_ref++, locate});
+      continue;
+    }
+    std::size_t pick = rng() % orders.size();
+    live order = orders[pick];
+    if (roll < 85) {
+      w.order_delete(order.locate, order.ref);
+    } else if (roll < 90) {
+      w.order_executed(order.locate, order.ref, 100, i);
+    } else if (roll < 95) {
+      w.order_cancel(order.locate, order.ref, 40);
+      continue;
+    } else {
+      w.order_replace(order.locate, order.ref, next_ref, 100,
+                      100'0000 - static_cast<std::uint32_t>(rng() % 20) * 100);
+      orders.push_back({next_ref++, order.locate});
+    }
+    orders[pick] = orders.back();
+    orders.pop_back();
+  }
+  return w;
+}
+
+struct null_handler {};
+
+void parse_only(ds::bench::state &st) {
+  st.pause();
+  const auto &w = capture(st.iterations());
+  null_handler h;
+  st.resume();
+  auto result = ds::itch::parse(w.bytes(), h);
+  ds::bench::do_not_optimize(result);
+}
+
+void build_in_memory(ds::bench::state &st) {
+  st.pause();
+  const auto &w = capture(st.iterations());
+  ds::itch::book_builder builder(st.iterations());
+  st.resume();
+  auto stats = ds::itch::replay(w.bytes(), builder);
+  ds::bench::do_not_optimize(stats);
+}
+
+void build_from_file(ds::bench::state &st) {
+  st.pause();
+  const auto &w = capture(st.iterations());
+  auto path = std::filesystem::temp_directory_path() / "ds_feed_bench.itch";
+  {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(w.bytes().data()),
+              static_cast<std::streamsize>(w.bytes().size()));
+  }
+  ds::itch::book_builder builder(st.iterations());
+  st.resume();
+  auto stats = ds::itch::replay(path.string(), builder);
+  st.pause();
+  std::filesystem::remove(path);
+  st.resume();
+  ds::bench::do_not_optimize(stats);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  ds::bench::runner runner(argc, argv, "feed_handler");
+
+  runner.add("parse/null_handler", parse_only);
+  runner.add("build/in_memory", build_in_memory);
+  runner.add("build/mapped_file", build_from_file);
+
+  return runner.run();
+}
@@ -0,0 +1,249 @@
+#pragma once
+
+#include "itch.hpp"
+#include "mapped_file.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace ds::itch {
+
+/*
+ * Book building from a feed
+ * A recorded feed already contains the exchange's matching decisions
+ * (executions arrive as 'E'/'C' messages), so rebuilding the books needs
+ * aggregation, not matching:
+ *
+ *   orders_   order ref -> {locate, side, price, shares}   (one map, refs are
+ *                                                          unique feed-wide)
+ *   books_    stock locate -> symbol_book                 (dense vector)
+ *   symbol_book   price -> {shares, orders} per side, best first
+ *
+ * Messages for unknown refs (a capture that starts mid-session) are counted
+ * and otherwise ignored.
+ */
+
+struct level_totals {
+  std::int64_t shares{0};
+  std::uint32_t orders{0};
+};
+
+class symbol_book {
+public:
+  using bid_levels = std::map<std::uint32_t, level_totals, std::greater<>>;
+  using ask_levels = std::map<std::uint32_t, level_totals, std::less<>>;
+
+  [[nodiscard]] const std::string &symbol() const noexcept { return symbol_; }
+  [[nodiscard]] const bid_levels &bids() const noexcept { return bids_; }
+  [[nodiscard]] const ask_levels &asks() const noexcept { return asks_; }
+
+  // Totals at a price; zero when the level is empty.
+  [[nodiscard]] level_totals level(bool is_buy, std::uint32_t price) const {
+    if (is_buy) {
+      auto it = bids_.find(price);
+      return it == bids_.end() ? level_totals{} : it->second;
+    }
+    auto it = asks_.find(price);
+    return it == asks_.end() ? level_totals{} : it->second;
+  }
+
+private:
+  friend class book_builder;
+
+  void add(bool is_buy, std::uint32_t price, std::uint32_t shares) {
+    level_totals &level = is_buy ? bids_[price] : asks_[price];
+    level.shares += shares;
+    ++level.orders;
+  }
+
+  // Takes `shares` off a level; `gone` when the order left the book.
+  void reduce(bool is_buy, std::uint32_t price, std::uint32_t shares,
+              bool gone) {
+    if (is_buy) {
+      reduce(bids_, price, shares, gone);
+    } else {
+      reduce(asks_, price, shares, gone);
+    }
+  }
+
+  template <typename Levels>
+  static void reduce(Levels &levels, std::uint32_t price,
+                     std::uint32_t shares, bool gone) {
+    auto it = levels.find(price);
+    if (it == levels.end()) {
+      return;
+    }
+    it->second.shares -= shares;
+    if (gone && --it->second.orders == 0) {
+      levels.erase(it);
+    }
+  }
+
+  std::string symbol_;
+  bid_levels bids_;
+  ask_levels asks_;
+};
+
+class book_builder {
+public:
+  // Pre-sizes the order index; a full day can carry tens of millions of
+  // live refs and rehashing mid-replay is the slowest thing that can happen.
+  explicit book_builder(std::size_t expected_orders = 0) {
+    orders_.reserve(expected_orders);
+  }
+
+  // ----- HANDLER -----
+  void on_message(const stock_directory &m) {
+    book_for(m.stock_locate()).symbol_ = m.stock();
+  }
+
+  void on_message(const add_order &m) {
+    symbol_book &book = book_for(m.stock_locate());
+    if (book.symbol_.empty()) {
+      book.symbol_ = m.stock();
+    }
+    add(m.order_ref(), m.stock_locate(), m.is_buy(), m.price(), m.shares());
+  }
+
+  void on_message(const order_executed &m) {
+    reduce(m.order_ref(), m.executed_shares());
+  }
+
+  void on_message(const order_cancel &m) {
+    reduce(m.order_ref(), m.cancelled_shares());
+  }
+
+  void on_message(const order_delete &m) { remove(m.order_ref()); }
+
+  // Keeps side and symbol, loses time priority.
+  void on_message(const order_replace &m) {
+    auto it = orders_.find(m.original_ref());
+    if (it == orders_.end()) {
+      ++unknown_refs_;
+      return;
+    }
+    resting order = it->second;
+    remove(it);
+    add(m.new_ref(), order.locate, order.is_buy, m.price(), m.shares());
+  }
+
+  // ----- QUERIES -----
+  [[nodiscard]] const symbol_book *book(std::uint16_t locate) const noexcept {
+    return locate < books_.size() ? &books_[locate] : nullptr;
+  }
+
+  [[nodiscard]] const symbol_book *book(std::string_view symbol) const {
+    for (const auto &b : books_) {
+      if (b.symbol_ == symbol) {
+        return &b;
+      }
+    }
+    return nullptr;
+  }
+
+  [[nodiscard]] std::size_t resting_orders() const noexcept {
+    return orders_.size();
+  }
+  [[nodiscard]] std::size_t unknown_refs() const noexcept {
+    return unknown_refs_;
+  }
+
+private:
+  struct resting {
+    std::uint32_t price;
+    std::uint32_t shares;
+    std::uint16_t locate;
+    bool is_buy;
+  };
+
+  symbol_book &book_for(std::uint16_t locate) {
+    if (locate >= books_.size()) {
+      books_.resize(std::size_t{locate} + 1);
+    }
+    return books_[locate];
+  }
+
+  void add(std::uint64_t ref, std::uint16_t locate, bool is_buy,
+           std::uint32_t price, std::uint32_t shares) {
+    if (!orders_.try_emplace(ref, resting{price, shares, locate, is_buy})
+             .second) {
+      return;
+    }
+    book_for(locate).add(is_buy, price, shares);
+  }
+
+  void reduce(std::uint64_t ref, std::uint32_t shares) {
+    auto it = orders_.find(ref);
+    if (it == orders_.end()) {
+      ++unknown_refs_;
+      return;
+    }
+    resting &order = it->second;
+    std::uint32_t taken = shares < order.shares ? shares : order.shares;
+    order.shares -= taken;
+    books_[order.locate].reduce(order.is_buy, order.price, taken,
+                                order.shares == 0);
+    if (order.shares == 0) {
+      orders_.erase(it);
+    }
+  }
+
+  void remove(std::uint64_t ref) {
+    auto it = orders_.find(ref);
+    if (it == orders_.end()) {
+      ++unknown_refs_;
+      return;
+    }
+    remove(it);
+  }
+
+  void remove(std::unordered_map<std::uint64_t, resting>::iterator it) {
+    const resting &order = it->second;
+    books_[order.locate].reduce(order.is_buy, order.price, order.shares,
+                                true);
+    orders_.erase(it);
+  }
+
+  std::vector<symbol_book> books_;
+  std::unordered_map<std::uint64_t, resting> orders_;
+  std::size_t unknown_refs_{0};
+};
+
+// ----- REPLAY -----
+
+struct replay_stats {
+  parse_result parsed;
+  double seconds{0.0};
+
+  [[nodiscard]] double messages_per_second() const noexcept {
+    return seconds > 0.0 ? static_cast<double>(parsed.messages) / seconds
+                         : 0.0;
+  }
+};
+
+template <typename Handler>
+replay_stats replay(std::span<const std::byte> data, Handler &handler) {
+  auto start = std::chrono::steady_clock::now();
+  replay_stats stats;
+  stats.parsed = parse(data, handler);
+  stats.seconds = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+  return stats;
+}
+
+// Maps the capture and feeds every message to `handler`.
+template <typename Handler>
+replay_stats replay(const std::string &path, Handler &handler) {
+  mapped_file file(path);
+  return replay(file.bytes(), handler);
+}
+
+} // namespace ds::itch
@@ -0,0 +1,352 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace ds::itch {
+
+/*
+ * ITCH 5.0 (subset) zero-copy parser
+ *
+ * A capture file is a sequence of length-prefixed messages, the framing
+ * exchanges use for their recorded binary feeds:
+ *
+ *   [u16 length][type][u16 locate][u16 tracking][u48 timestamp][body...]
+ *    big-endian  '--------------- length bytes -------------------------'
+ *
+ * parse() walks the buffer once and switches on the type byte. Each handled
+ * type is wrapped in a view - a pointer into the buffer whose accessors
+ * decode a big-endian field on demand - so nothing is copied and fields the
+ * handler never reads are never decoded. A handler implements on_message()
+ * for the views it cares about; other types are skipped by length.
+ *
+ *   'R' stock directory       'E' order executed
+ *   'A' add order             'C' order executed with price
+ *   'F' add order (with MPID) 'X' order cancel (partial)
+ *   'U' order replace         'D' order delete
+ *
+ * Prices are the feed's fixed-point u32 (4 implied decimals).
+ */
+
+namespace detail {
+
+template <typename T> inline T load_be(const std::byte *p) noexcept {
+  T value;
+  std::memcpy(&value, p, sizeof(T));
+  if constexpr (std::endian::native == std::endian::little) {
+    value = std::byteswap(value);
+  }
+  return value;
+}
+
+inline std::uint64_t load_be48(const std::byte *p) noexcept {
+  return std::uint64_t{load_be<std::uint16_t>(p)} << 32 |
+         load_be<std::uint32_t>(p + 2);
+}
+
+} // namespace detail
+
+// Bytes after the length prefix, per message type.
+inline constexpr std::size_t stock_directory_length = 39;
+inline constexpr std::size_t add_order_length = 36;
+inline constexpr std::size_t add_order_mpid_length = 40;
+inline constexpr std::size_t order_executed_length = 31;
+inline constexpr std::size_t order_executed_price_length = 36;
+inline constexpr std::size_t order_cancel_length = 23;
+inline constexpr std::size_t order_delete_length = 19;
+inline constexpr std::size_t order_replace_length = 35;
+
+// ----- MESSAGE VIEWS -----
+
+class message_view {
+public:
+  explicit message_view(const std::byte *p) noexcept : p_(p) {}
+
+  [[nodiscard]] char type() const noexcept { return static_cast<char>(p_[0]); }
+  [[nodiscard]] std::uint16_t stock_locate() const noexcept {
+    return u16(1);
+  }
+  [[nodiscard]] std::uint64_t timestamp() const noexcept {
+    return detail::load_be48(p_ + 5);
+  }
+
+protected:
+  [[nodiscard]] std::uint16_t u16(std::size_t at) const noexcept {
+    return detail::load_be<std::uint16_t>(p_ + at);
+  }
+  [[nodiscard]] std::uint32_t u32(std::size_t at) const noexcept {
+    return detail::load_be<std::uint32_t>(p_ + at);
+  }
+  [[nodiscard]] std::uint64_t u64(std::size_t at) const noexcept {
+    return detail::load_be<std::uint64_t>(p_ + at);
+  }
+  // Space-padded alpha field, trailing spaces dropped.
+  [[nodiscard]] std::string_view alpha(std::size_t at,
+                                       std::size_t width) const noexcept {
+    std::string_view s(reinterpret_cast<const char *>(p_ + at), width);
+    return s.substr(0, s.find_last_not_of(' ') + 1);
+  }
+
+  const std::byte *p_;
+};
+
+struct stock_directory : message_view {
+  using message_view::message_view;
+  [[nodiscard]] std::string_view stock() const noexcept {
+    return alpha(11, 8);
+  }
+};
+
+// 'A' and 'F'; the MPID attribution of 'F' is not exposed.
+struct add_order : message_view {
+  using message_view::message_view;
+  [[nodiscard]] std::uint64_t order_ref() const noexcept { return u64(11); }
+  [[nodiscard]] bool is_buy() const noexcept {
+    return static_cast<char>(p_[19]) == 'B';
+  }
+  [[nodiscard]] std::uint32_t shares() const noexcept { return u32(20); }
+  [[nodiscard]] std::string_view stock() const noexcept {
+    return alpha(24, 8);
+  }
+  [[nodiscard]] std::uint32_t price() const noexcept { return u32(32); }
+};
+
+// 'E' and 'C'; has_price() tells them apart.
+struct order_executed : message_view {
+  using message_view::message_view;
+  [[nodiscard]] std::uint64_t order_ref() const noexcept { return u64(11); }
+  [[nodiscard]] std::uint32_t executed_shares() const noexcept {
+    return u32(19);
+  }
+  [[nodiscard]] std::uint64_t match_number() const noexcept {
+    return u64(23);
+  }
+  [[nodiscard]] bool has_price() const noexcept { return type() == 'C'; }
+  // Only meaningful when has_price().
+  [[nodiscard]] std::uint32_t execution_price() const noexcept {
+    return u32(32);
+  }
+};
+
+struct order_cancel : message_view {
+  using message_view::message_view;
+  [[nodiscard]] std::uint64_t order_ref() const noexcept { return u64(11); }
+  [[nodiscard]] std::uint32_t cancelled_shares() const noexcept {
+    return u32(19);
+  }
+};
+
+struct order_delete : message_view {
+  using message_view::message_view;
+  [[nodiscard]] std::uint64_t order_ref() const noexcept { return u64(11); }
+};
+
+struct order_replace : message_view {
+  using message_view::message_view;
+  [[nodiscard]] std::uint64_t original_ref() const noexcept { return u64(11); }
+  [[nodiscard]] std::uint64_t new_ref() const noexcept { return u64(19); }
+  [[nodiscard]] std::uint32_t shares() const noexcept { return u32(27); }
+  [[nodiscard]] std::uint32_t price() const noexcept { return u32(31); }
+};
+
+// ----- PARSER -----
+
+struct parse_result {
+  std::size_t messages{0}; // every framed message, handled or not
+  std::size_t bytes{0};    // consumed; < input size if the tail is truncated
+  std::size_t malformed{0}; // known types shorter than their layout
+};
+
+namespace detail {
+
+template <typename Handler, typename Message>
+inline void deliver(Handler &handler, const std::byte *p) {
+  if constexpr (requires { handler.on_message(Message(p)); }) {
+    handler.on_message(Message(p));
+  }
+}
+
+} // namespace detail
+
+template <typename Handler>
+parse_result parse(std::span<const std::byte> data, Handler &handler) {
+  parse_result result;
+  const std::byte *p = data.data();
+  const std::byte *end = p + data.size();
+
+  while (end - p >= 2) {
+    std::size_t length = detail::load_be<std::uint16_t>(p);
+    if (static_cast<std::size_t>(end - p) - 2 < length || length == 0) {
+      break;
+    }
+    const std::byte *m = p + 2;
+    p += 2 + length;
+    ++result.messages;
+
+    auto need = [&](std::size_t layout) {
+      if (length < layout) {
+        ++result.malformed;
+        return false;
+      }
+      return true;
+    };
+
+    switch (static_cast<char>(m[0])) {
+    case 'R':
+      if (need(stock_directory_length)) {
+        detail::deliver<Handler, stock_directory>(handler, m);
+      }
+      break;
+    case 'A':
+      if (need(add_order_length)) {
+        detail::deliver<Handler, add_order>(handler, m);
+      }
+      break;
+    case 'F':
+      if (need(add_order_mpid_length)) {
+        detail::deliver<Handler, add_order>(handler, m);
+      }
+      break;
+    case 'E':
+      if (need(order_executed_length)) {
+        detail::deliver<Handler, order_executed>(handler, m);
+      }
+      break;
+    case 'C':
+      if (need(order_executed_price_length)) {
+        detail::deliver<Handler, order_executed>(handler, m);
+      }
+      break;
+    case 'X':
+      if (need(order_cancel_length)) {
+        detail::deliver<Handler, order_cancel>(handler, m);
+      }
+      break;
+    case 'D':
+      if (need(order_delete_length)) {
+        detail::deliver<Handler, order_delete>(handler, m);
+      }
+      break;
+    case 'U':
+      if (need(order_replace_length)) {
+        detail::deliver<Handler, order_replace>(handler, m);
+      }
+      break;
+    default:
+      break;
+    }
+  }
+  result.bytes = static_cast<std::size_t>(p - data.data());
+  return result;
+}
+
+// ----- WRITER -----
+
+// Encodes messages in the layout parse() reads; used to build captures for
+// tests and benchmarks.
+class writer {
+public:
+  void stock_directory(std::uint16_t locate, std::string_view stock) {
+    emit('R', locate, stock_directory_length, [&](std::byte *m) {
+      put_alpha(m + 11, stock, 8);
+    });
+  }
+
+  void add_order(std::uint16_t locate, std::uint64_t ref, bool buy,
+                 std::uint32_t shares, std::string_view stock,
+                 std::uint32_t price) {
+    emit('A', locate, add_order_length, [&](std::byte *m) {
+      put(m + 11, ref);
+      m[19] = static_cast<std::byte>(buy ? 'B' : 'S');
+      put(m + 20, shares);
+      put_alpha(m + 24, stock, 8);
+      put(m + 32, price);
+    });
+  }
+
+  void order_executed(std::uint16_t locate, std::uint64_t ref,
+                      std::uint32_t shares, std::uint64_t match) {
+    emit('E', locate, order_executed_length, [&](std::byte *m) {
+      put(m + 11, ref);
+      put(m + 19, shares);
+      put(m + 23, match);
+    });
+  }
+
+  void order_cancel(std::uint16_t locate, std::uint64_t ref,
+                    std::uint32_t shares) {
+    emit('X', locate, order_cancel_length, [&](std::byte *m) {
+      put(m + 11, ref);
+      put(m + 19, shares);
+    });
+  }
+
+  void order_delete(std::uint16_t locate, std::uint64_t ref) {
+    emit('D', locate, order_delete_length, [&](std::byte *m) {
+      put(m + 11, ref);
+    });
+  }
+
+  void order_replace(std::uint16_t locate, std::uint64_t original,
+                     std::uint64_t replacement, std::uint32_t shares,
+                     std::uint32_t price) {
+    emit('U', locate, order_replace_length, [&](std::byte *m) {
+      put(m + 11, original);
+      put(m + 19, replacement);
+      put(m + 27, shares);
+      put(m + 31, price);
+    });
+  }
+
+  [[nodiscard]] std::span<const std::byte> bytes() const noexcept {
+    return buffer_;
+  }
+  void clear() noexcept { buffer_.clear(); }
+
+private:
+  // Lays the frame out on the stack, then appends it in one go.
+  template <typename Fill>
+  void emit(char type, std::uint16_t locate, std::size_t length, Fill fill) {
+    std::array<std::byte, 2 + add_order_mpid_length> frame{};
+    std::byte *p = frame.data();
+    put(p, static_cast<std::uint16_t>(length));
+    p[2] = static_cast<std::byte>(type);
+    put(p + 3, locate);
+    put(p + 5, std::uint16_t{0});
+    put(p + 7, std::uint16_t{static_cast<std::uint16_t>(sequence_ >> 32)});
+    put(p + 9, static_cast<std::uint32_t>(sequence_));
+    ++sequence_;
+    fill(p + 2);
+    append(p, 2 + length);
+  }
+
+  // Kept out of line: with the frame size known at the call site, GCC 12's
+  // array-bounds analysis misreads the vector's growth path.
+  [[gnu::noinline]] void append(const std::byte *frame, std::size_t n) {
+    buffer_.insert(buffer_.end(), frame, frame + n);
+  }
+
+  template <typename T> static void put(std::byte *p, T value) noexcept {
+    if constexpr (std::endian::native == std::endian::little) {
+      value = std::byteswap(value);
+    }
+    std::memcpy(p, &value, sizeof(T));
+  }
+
+  static void put_alpha(std::byte *p, std::string_view s, std::size_t width) {
+    std::memset(p, ' ', width);
+    std::memcpy(p, s.data(), std::min(s.size(), width));
+  }
+
+  std::vector<std::byte> buffer_;
+  std::uint64_t sequence_{0}; // stands in for the timestamp
+};
+
+} // namespace ds::itch
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ds {
+
+/*
+ * mapped_file
+ * Read-only, private mapping of a whole file. The parser reads straight out
+ * of the page cache: no read() calls and no copy into a user buffer. The
+ * kernel is told the access is sequential so it reads ahead aggressively
+ * and drops pages behind us.
+ *
+ * An empty file maps to an empty span.
+ */
+class mapped_file {
+public:
+  explicit mapped_file(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      throw std::system_error(errno, std::generic_category(),
+                              "open " + path);
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+      int error = errno;
+      ::close(fd);
+      throw std::system_error(error, std::generic_category(),
+                              "fstat " + path);
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+    if (size_ != 0) {
+      void *address = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (address == MAP_FAILED) {
+        int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(),
+                                "mmap " + path);
+      }
+      data_ = static_cast<std::byte *>(address);
+#ifdef MADV_SEQUENTIAL
+      ::madvise(address, size_, MADV_SEQUENTIAL);
+#endif
+    }
+    // The mapping keeps the file alive.
+    ::close(fd);
+  }
+
+  ~mapped_file() {
+    if (data_ != nullptr) {
+      ::munmap(data_, size_);
+    }
+  }
+
+  mapped_file(mapped_file &&other) noexcept
+      : data_(std::exchange(other.data_, nullptr)),
+        size_(std::exchange(other.size_, 0)) {}
+  mapped_file &operator=(mapped_file &&other) noexcept {
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    return *this;
+  }
+  mapped_file(const mapped_file &) = delete;
+  mapped_file &operator=(const mapped_file &) = delete;
+
+  [[nodiscard]] std::span<const std::byte> bytes() const noexcept {
+    return {data_, size_};
+  }
+  [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+private:
+  std::byte *data_{nullptr};
+  std::size_t size_{0};
+};
+
+} // namespace ds
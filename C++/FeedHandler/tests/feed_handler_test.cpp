@@ -0,0 +1,191 @@
+#include "book_builder.hpp"
+#include "itch.hpp"
+#include "mapped_file.hpp"
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace {
+
+// Records what it was handed; ignores everything but adds and deletes.
+struct add_delete_recorder {
+  std::vector<std::uint64_t> added;
+  std::vector<std::uint64_t> deleted;
+
+  void on_message(const ds::itch::add_order &m) {
+    added.push_back(m.order_ref());
+  }
+  void on_message(const ds::itch::order_delete &m) {
+    deleted.push_back(m.order_ref());
+  }
+};
+
+std::filesystem::path write_capture(std::span<const std::byte> bytes,
+                                    const std::string &name) {
+  auto path = std::filesystem::temp_directory_path() / name;
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out.write(reinterpret_cast<const char *>(bytes.data()),
+            static_cast<std::streamsize>(bytes.size()));
+  return path;
+}
+
+} // namespace
+
+// ------ PARSER -------
+
+TEST_CASE("views decode the fields that were written", "[parser]") {
+  ds::itch::writer w;
+  w.add_order(7, 0x0102030405060708ULL, true, 300, "AAPL", 1'234'500);
+
+  struct handler {
+    bool seen = false;
+    void on_message(const ds::itch::add_order &m) {
+      seen = true;
+      REQUIRE(m.type() == 'A');
+      REQUIRE(m.stock_locate() == 7);
+      REQUIRE(m.order_ref() == 0x0102030405060708ULL);
+      REQUIRE(m.is_buy());
+      REQUIRE(m.shares() == 300);
+      REQUIRE(m.stock() == "AAPL");
+      REQUIRE(m.price() == 1'234'500);
+    }
+  } h;
+  auto result = ds::itch::parse(w.bytes(), h);
+  REQUIRE(h.seen);
+  REQUIRE(result.messages == 1);
+  REQUIRE(result.bytes == w.bytes().size());
+}
+
+TEST_CASE("unhandled types are skipped by length", "[parser]") {
+  ds::itch::writer w;
+  w.stock_directory(1, "MSFT");
+  w.add_order(1, 10, false, 100, "MSFT", 500);
+  w.order_executed(1, 10, 50, 1);
+  w.order_delete(1, 10);
+
+  add_delete_recorder h;
+  auto result = ds::itch::parse(w.bytes(), h);
+  REQUIRE(result.messages == 4);
+  REQUIRE(h.added == std::vector<std::uint64_t>{10});
+  REQUIRE(h.deleted == std::vector<std::uint64_t>{10});
+}
+
+TEST_CASE("a truncated tail is left unconsumed", "[parser]") {
+  ds::itch::writer w;
+  w.add_order(1, 1, true, 1, "A", 1);
+  w.order_delete(1, 1);
+  auto all = w.bytes();
+  auto cut = all.first(all.size() - 3);
+
+  add_delete_recorder h;
+  auto result = ds::itch::parse(cut, h);
+  REQUIRE(result.messages == 1);
+  REQUIRE(result.bytes == 2 + ds::itch::add_order_length);
+  REQUIRE(h.deleted.empty());
+}
+
+TEST_CASE("known types shorter than their layout are not delivered",
+          "[parser]") {
+  // length 5, type 'D': far too short for an order delete
+  std::vector<std::byte> bytes{std::byte{0}, std::byte{5}, std::byte{'D'},
+                               std::byte{0}, std::byte{0}, std::byte{0},
+                               std::byte{0}};
+  add_delete_recorder h;
+  auto result = ds::itch::parse(bytes, h);
+  REQUIRE(result.messages == 1);
+  REQUIRE(result.malformed == 1);
+  REQUIRE(h.deleted.empty());
+}
+
+// ------ BOOK BUILDER -------
+
+TEST_CASE("book builder aggregates adds, executions and cancels",
+          "[builder]") {
+  ds::itch::writer w;
+  w.stock_directory(3, "ABC");
+  w.add_order(3, 1, true, 100, "ABC", 10'0000);
+  w.add_order(3, 2, true, 50, "ABC", 10'0000);
+  w.add_order(3, 3, false, 70, "ABC", 10'0100);
+  w.order_executed(3, 1, 40, 1);
+  w.order_cancel(3, 2, 50); // cancels it entirely
+  w.order_cancel(3, 3, 20);
+
+  ds::itch::book_builder builder;
+  ds::itch::parse(w.bytes(), builder);
+
+  const auto *book = builder.book("ABC");
+  REQUIRE(book != nullptr);
+  REQUIRE(book == builder.book(std::uint16_t{3}));
+  auto bid = book->level(true, 10'0000);
+  REQUIRE(bid.shares == 60);
+  REQUIRE(bid.orders == 1);
+  REQUIRE(book->level(false, 10'0100).shares == 50);
+  REQUIRE(builder.resting_orders() == 2);
+}
+
+TEST_CASE("replace moves the order and delete empties the level",
+          "[builder]") {
+  ds::itch::writer w;
+  w.add_order(1, 1, false, 100, "XYZ", 500);
+  w.add_order(1, 2, false, 100, "XYZ", 500);
+  w.order_replace(1, 1, 9, 80, 510);
+  w.order_delete(1, 2);
+  w.order_delete(1, 42); // never added
+
+  ds::itch::book_builder builder;
+  ds::itch::parse(w.bytes(), builder);
+
+  const auto *book = builder.book("XYZ");
+  REQUIRE(book->asks().size() == 1);
+  REQUIRE(book->asks().begin()->first == 510);
+  REQUIRE(book->asks().begin()->second.shares == 80);
+  REQUIRE(book->bids().empty());
+  REQUIRE(builder.unknown_refs() == 1);
+}
+
+TEST_CASE("books are kept per symbol", "[builder]") {
+  ds::itch::writer w;
+  w.add_order(1, 1, true, 10, "AAA", 100);
+  w.add_order(2, 2, true, 20, "BBB", 100);
+  w.order_executed(2, 2, 5, 1);
+
+  ds::itch::book_builder builder;
+  ds::itch::parse(w.bytes(), builder);
+  REQUIRE(builder.book("AAA")->level(true, 100).shares == 10);
+  REQUIRE(builder.book("BBB")->level(true, 100).shares == 15);
+  REQUIRE(builder.book("CCC") == nullptr);
+}
+
+// ------ REPLAY -------
+
+TEST_CASE("replay maps a capture file and reports throughput", "[replay]") {
+  ds::itch::writer w;
+  for (std::uint64_t ref = 1; ref <= 1000; ++ref) {
+    w.add_order(1, ref, ref % 2 == 0, 100, "FILE",
+                static_cast<std::uint32_t>(1000 + ref % 10));
+  }
+  for (std::uint64_t ref = 1; ref <= 1000; ref += 2) {
+    w.order_delete(1, ref);
+  }
+  auto path = write_capture(w.bytes(), "ds_feed_handler_test.itch");
+
+  ds::itch::book_builder builder(1000);
+  auto stats = ds::itch::replay(path.string(), builder);
+  std::filesystem::remove(path);
+
+  REQUIRE(stats.parsed.messages == 1500);
+  REQUIRE(stats.parsed.bytes == w.bytes().size());
+  REQUIRE(stats.messages_per_second() > 0.0);
+  REQUIRE(builder.resting_orders() == 500);
+  REQUIRE(builder.book("FILE")->asks().empty());
+}
+
+TEST_CASE("mapping a missing file throws system_error", "[replay]") {
+  REQUIRE_THROWS_AS(ds::mapped_file("/nonexistent/ds_feed.itch"),
+                    std::system_error);
+}
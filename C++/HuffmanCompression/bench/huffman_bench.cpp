@@ -0,0 +1,43 @@
+#include "benchmark.hpp"
+#include "huffman.hpp"
+#include <string>
+
+namespace {
+
+std::string sample_text() {
+  std::string text;
+  const std::string words[] = {"order ", "book ", "queue ", "thread ",
+                               "pool ",  "heap ", "lock ",  "free "};
+  for (std::size_t i = 0; text.size() < 4096; ++i) {
+    text += words[(i * 7 + i / 3) % 8];
+  }
+  return text;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  ds::bench::runner runner(argc, argv, "huffman");
+  const std::string text = sample_text();
+
+  runner.add("compress/4KiB", [&text](ds::bench::state &st) {
+    HuffmanCoder coder;
+    for (std::size_t i = 0; i < st.iterations(); ++i) {
+      auto data = coder.compress(text);
+      ds::bench::do_not_optimize(data.numBits);
+    }
+  });
+
+  runner.add("decompress/4KiB", [&text](ds::bench::state &st) {
+    HuffmanCoder coder;
+    st.pause();
+    auto data = coder.compress(text);
+    st.resume();
+    for (std::size_t i = 0; i < st.iterations(); ++i) {
+      auto out = coder.decompress(data);
+      ds::bench::do_not_optimize(out.size());
+    }
+  });
+
+  return runner.run();
+}
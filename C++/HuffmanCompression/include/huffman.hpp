@@ -1,9 +1,10 @@
 #pragma once
 
+#include "intrusive_ptr.hpp"
+
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
-#include <memory>
 #include <queue>
 #include <stdexcept>
 #include <string>
@@ -39,17 +40,24 @@
  *
  */
 
-struct HuffmanNode {
+/*
+ * Nodes are owned through ds::intrusive_ptr: the tree is built and walked by a
+ * single thread, so the refcount is a plain counter embedded in the node and
+ * each node is a single allocation.
+ */
+struct HuffmanNode;
+using HuffmanNodePtr = ds::intrusive_ptr<HuffmanNode>;
+
+struct HuffmanNode : ds::intrusive_ref_counter<HuffmanNode> {
   char ch;
   char minCh;
   int freq;
-  std::shared_ptr<HuffmanNode> left;
-  std::shared_ptr<HuffmanNode> right;
+  HuffmanNodePtr left;
+  HuffmanNodePtr right;
 
   HuffmanNode(char c, int f)
       : ch(c), minCh(ch), freq(f), left(nullptr), right(nullptr) {}
-  HuffmanNode(int f, const std::shared_ptr<HuffmanNode> &l,
-              const std::shared_ptr<HuffmanNode> &r)
+  HuffmanNode(int f, const HuffmanNodePtr &l, const HuffmanNodePtr &r)
       : ch('\0'), minCh(std::min(l->minCh, r->minCh)), freq(f), left(l),
         right(r) {}
   [[nodiscard]] bool isLeaf() const {
@@ -58,8 +66,7 @@ struct HuffmanNode {
 };
 
 struct CompareHuffman {
-  bool operator()(const std::shared_ptr<HuffmanNode> &a,
-                  const std::shared_ptr<HuffmanNode> &b) {
+  bool operator()(const HuffmanNodePtr &a, const HuffmanNodePtr &b) {
     if (a->freq != b->freq) {
       return a->freq > b->freq;
     }
@@ -88,34 +95,31 @@ struct HuffmanCoder {
   }
 
   // build the huffman tree
-  std::shared_ptr<HuffmanNode>
-  buildTree(const std::unordered_map<char, int> &freqTable) {
-    std::priority_queue<std::shared_ptr<HuffmanNode>,
-                        std::vector<std::shared_ptr<HuffmanNode>>,
+  HuffmanNodePtr buildTree(const std::unordered_map<char, int> &freqTable) {
+    std::priority_queue<HuffmanNodePtr, std::vector<HuffmanNodePtr>,
                         CompareHuffman>
         minHeap;
     for (const auto &pair : freqTable) {
-      minHeap.emplace(std::make_shared<HuffmanNode>(pair.first, pair.second));
+      minHeap.emplace(ds::make_intrusive<HuffmanNode>(pair.first, pair.second));
     }
     if (minHeap.size() == 1) {
       auto node = minHeap.top();
       minHeap.pop();
-      minHeap.emplace(std::make_shared<HuffmanNode>(node->freq, node, node));
+      minHeap.emplace(ds::make_intrusive<HuffmanNode>(node->freq, node, node));
     }
     while (minHeap.size() > 1) {
       auto l = minHeap.top();
       minHeap.pop();
       auto r = minHeap.top();
       minHeap.pop();
-      minHeap.emplace(std::make_shared<HuffmanNode>(l->freq + r->freq, l, r));
+      minHeap.emplace(ds::make_intrusive<HuffmanNode>(l->freq + r->freq, l, r));
     }
     return minHeap.empty() ? nullptr : minHeap.top();
   }
 
   // generate codes for all the characters using this tree
   // simple tree parsing
-  void generateCodes(const std::shared_ptr<HuffmanNode> &root,
-                     const std::string &code,
+  void generateCodes(const HuffmanNodePtr &root, const std::string &code,
                      std::unordered_map<char, std::string> &codes) {
     if (root->isLeaf()) {
       codes[root->ch] = code.empty() ? "0" : code;
@@ -197,7 +201,7 @@ struct HuffmanCoder {
     return bitString.substr(0, numBits);
   }
 
-  std::string decode(const std::shared_ptr<HuffmanNode> &root,
+  std::string decode(const HuffmanNodePtr &root,
                      const std::string &bitString) {
     if (!root || bitString.empty()) {
       return "";
@@ -292,7 +296,7 @@ struct HuffmanCoder {
 
     offset += 2;
 
-    size_t expectedMinSize = (numChars * 5) + 6;
+    size_t expectedMinSize = (static_cast<size_t>(numChars) * 5) + 6;
     if (buffer.size() < expectedMinSize) {
       throw std::runtime_error("buffer not large enough to hold "
                                "frequencyTable, serialised data corrupted");
@@ -0,0 +1,55 @@
+#include "benchmark.hpp"
+#include "intrusive_ptr.hpp"
+#include <memory>
+
+namespace {
+
+struct local_node : ds::intrusive_ref_counter<local_node> {
+  int value{0};
+};
+
+struct shared_node
+    : ds::intrusive_ref_counter<shared_node, ds::thread_safe_counter> {
+  int value{0};
+};
+
+template <typename Ptr> void copy_loop(ds::bench::state &st, const Ptr &p) {
+  for (std::size_t i = 0; i < st.iterations(); ++i) {
+    Ptr copy = p;
+    ds::bench::do_not_optimize(copy);
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  ds::bench::runner runner(argc, argv, "intrusive_ptr");
+
+  runner.add("make/intrusive", [](ds::bench::state &st) {
+    for (std::size_t i = 0; i < st.iterations(); ++i) {
+      auto p = ds::make_intrusive<local_node>();
+      ds::bench::do_not_optimize(p);
+    }
+  });
+
+  runner.add("make/std_shared", [](ds::bench::state &st) {
+    for (std::size_t i = 0; i < st.iterations(); ++i) {
+      auto p = std::make_shared<int>(0);
+      ds::bench::do_not_optimize(p);
+    }
+  });
+
+  runner.add("copy/intrusive_thread_unsafe", [](ds::bench::state &st) {
+    copy_loop(st, ds::make_intrusive<local_node>());
+  });
+
+  runner.add("copy/intrusive_thread_safe", [](ds::bench::state &st) {
+    copy_loop(st, ds::make_intrusive<shared_node>());
+  });
+
+  runner.add("copy/std_shared", [](ds::bench::state &st) {
+    copy_loop(st, std::make_shared<int>(0));
+  });
+
+  return runner.run();
+}
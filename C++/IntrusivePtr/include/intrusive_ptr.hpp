@@ -0,0 +1,171 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+/*
+ * intrusive_ptr<T>
+ * A reference-counted pointer whose count lives inside the object itself.
+ *
+ *   std::shared_ptr<T>                    ds::intrusive_ptr<T>
+ *   [ptr|ctrl] --> [strong|weak|deleter]  [ptr] --> [refcount|T...]
+ *         \------> [T...]
+ *
+ * 1) one allocation per object (make_shared also gets this, but a raw T* can
+ *    always be re-wrapped because the count travels with the object)
+ * 2) pointer is one word instead of two
+ * 3) the counting policy is chosen per type: single-threaded structures such
+ *    as trees pay a plain increment, shared ones opt into atomics
+ *
+ * A type opts in by deriving from intrusive_ref_counter<T, Policy>, or by
+ * providing its own intrusive_ptr_add_ref / intrusive_ptr_release overloads
+ * found through ADL.
+ */
+
+namespace ds {
+
+// ----- COUNTING POLICIES -----
+
+struct thread_unsafe_counter {
+  using type = std::size_t;
+
+  static std::size_t load(const type &c) noexcept { return c; }
+  static void increment(type &c) noexcept { ++c; }
+  // Returns the count after the decrement.
+  static std::size_t decrement(type &c) noexcept { return --c; }
+};
+
+struct thread_safe_counter {
+  using type = std::atomic<std::size_t>;
+
+  static std::size_t load(const type &c) noexcept {
+    return c.load(std::memory_order_acquire);
+  }
+  // A new reference can only be made from an existing one, so no ordering is
+  // needed on the way up.
+  static void increment(type &c) noexcept {
+    c.fetch_add(1, std::memory_order_relaxed);
+  }
+  // acq_rel so the thread that frees sees every other owner's writes.
+  static std::size_t decrement(type &c) noexcept {
+    return c.fetch_sub(1, std::memory_order_acq_rel) - 1;
+  }
+};
+
+template <typename Derived, typename Policy = thread_unsafe_counter>
+class intrusive_ref_counter {
+public:
+  intrusive_ref_counter() noexcept = default;
+
+  // Copying an object must not copy its reference count.
+  intrusive_ref_counter(const intrusive_ref_counter &) noexcept {}
+  intrusive_ref_counter &operator=(const intrusive_ref_counter &) noexcept {
+    return *this;
+  }
+
+  [[nodiscard]] std::size_t use_count() const noexcept {
+    return Policy::load(count_);
+  }
+
+  friend void intrusive_ptr_add_ref(const intrusive_ref_counter *p) noexcept {
+    Policy::increment(p->count_);
+  }
+
+  friend void intrusive_ptr_release(const intrusive_ref_counter *p) noexcept {
+    if (Policy::decrement(p->count_) == 0) {
+      destroy(p);
+    }
+  }
+
+protected:
+  ~intrusive_ref_counter() = default;
+
+private:
+  // Kept out of line: destroying a node releases its children, and GCC's
+  // use-after-free analysis misreads that recursion once it is fully inlined.
+  [[gnu::noinline]] static void
+  destroy(const intrusive_ref_counter *p) noexcept {
+    delete static_cast<const Derived *>(p);
+  }
+
+  mutable typename Policy::type count_{0};
+};
+
+// ----- POINTER -----
+
+template <typename T> class intrusive_ptr {
+public:
+  using element_type = T;
+
+  intrusive_ptr() noexcept = default;
+  intrusive_ptr(std::nullptr_t) noexcept {}
+
+  // add_ref = false adopts a reference the caller already holds.
+  intrusive_ptr(T *p, bool add_ref = true) : ptr_(p) {
+    if (ptr_ != nullptr && add_ref) {
+      intrusive_ptr_add_ref(ptr_);
+    }
+  }
+
+  intrusive_ptr(const intrusive_ptr &other) : ptr_(other.ptr_) {
+    if (ptr_ != nullptr) {
+      intrusive_ptr_add_ref(ptr_);
+    }
+  }
+
+  intrusive_ptr(intrusive_ptr &&other) noexcept
+      : ptr_(std::exchange(other.ptr_, nullptr)) {}
+
+  template <typename U>
+  intrusive_ptr(const intrusive_ptr<U> &other) : intrusive_ptr(other.get()) {}
+
+  ~intrusive_ptr() {
+    if (ptr_ != nullptr) {
+      intrusive_ptr_release(ptr_);
+    }
+  }
+
+  intrusive_ptr &operator=(const intrusive_ptr &other) {
+    intrusive_ptr(other).swap(*this);
+    return *this;
+  }
+
+  intrusive_ptr &operator=(intrusive_ptr &&other) noexcept {
+    intrusive_ptr(std::move(other)).swap(*this);
+    return *this;
+  }
+
+  void reset() noexcept { intrusive_ptr().swap(*this); }
+  void reset(T *p, bool add_ref = true) {
+    intrusive_ptr(p, add_ref).swap(*this);
+  }
+
+  // Give up ownership without decrementing.
+  [[nodiscard]] T *detach() noexcept { return std::exchange(ptr_, nullptr); }
+
+  void swap(intrusive_ptr &other) noexcept { std::swap(ptr_, other.ptr_); }
+
+  [[nodiscard]] T *get() const noexcept { return ptr_; }
+  T &operator*() const noexcept { return *ptr_; }
+  T *operator->() const noexcept { return ptr_; }
+  explicit operator bool() const noexcept { return ptr_ != nullptr; }
+
+  friend bool operator==(const intrusive_ptr &a,
+                         const intrusive_ptr &b) noexcept {
+    return a.get() == b.get();
+  }
+  friend bool operator==(const intrusive_ptr &a, std::nullptr_t) noexcept {
+    return a.ptr_ == nullptr;
+  }
+
+private:
+  T *ptr_{nullptr};
+};
+
+template <typename T, typename... Args>
+intrusive_ptr<T> make_intrusive(Args &&...args) {
+  return intrusive_ptr<T>(new T(std::forward<Args>(args)...));
+}
+
+} // namespace ds
@@ -0,0 +1,114 @@
+#include "intrusive_ptr.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct node : ds::intrusive_ref_counter<node> {
+  explicit node(int v, int *live) : value(v), live_count(live) {
+    ++*live_count;
+  }
+  ~node() { --*live_count; }
+
+  int value;
+  int *live_count;
+  ds::intrusive_ptr<node> left;
+  ds::intrusive_ptr<node> right;
+};
+
+struct shared_node
+    : ds::intrusive_ref_counter<shared_node, ds::thread_safe_counter> {
+  int value{0};
+};
+
+} // namespace
+
+// ------ BASIC OWNERSHIP -------
+
+TEST_CASE("default constructed pointer is null", "[intrusive_ptr]") {
+  ds::intrusive_ptr<node> p;
+  REQUIRE(p == nullptr);
+  REQUIRE_FALSE(p);
+}
+
+TEST_CASE("copies share one embedded count", "[intrusive_ptr]") {
+  int live = 0;
+  {
+    auto a = ds::make_intrusive<node>(1, &live);
+    REQUIRE(a->use_count() == 1);
+    {
+      auto b = a;
+      REQUIRE(a == b);
+      REQUIRE(a->use_count() == 2);
+    }
+    REQUIRE(a->use_count() == 1);
+    REQUIRE(live == 1);
+  }
+  REQUIRE(live == 0);
+}
+
+TEST_CASE("moves transfer without touching the count", "[intrusive_ptr]") {
+  int live = 0;
+  auto a = ds::make_intrusive<node>(1, &live);
+  auto b = std::move(a);
+  REQUIRE(a == nullptr);
+  REQUIRE(b->use_count() == 1);
+  b.reset();
+  REQUIRE(live == 0);
+}
+
+TEST_CASE("raw pointer can be re-wrapped", "[intrusive_ptr]") {
+  int live = 0;
+  auto a = ds::make_intrusive<node>(7, &live);
+  node *raw = a.get();
+  ds::intrusive_ptr<node> b(raw);
+  REQUIRE(b->use_count() == 2);
+  REQUIRE(b->value == 7);
+}
+
+TEST_CASE("detach and adopt round trip", "[intrusive_ptr]") {
+  int live = 0;
+  auto a = ds::make_intrusive<node>(3, &live);
+  node *raw = a.detach();
+  REQUIRE(a == nullptr);
+  REQUIRE(live == 1);
+
+  ds::intrusive_ptr<node> b(raw, false);
+  REQUIRE(b->use_count() == 1);
+  b.reset();
+  REQUIRE(live == 0);
+}
+
+TEST_CASE("shared children are freed once", "[intrusive_ptr][tree]") {
+  int live = 0;
+  {
+    auto leaf = ds::make_intrusive<node>(1, &live);
+    auto root = ds::make_intrusive<node>(0, &live);
+    root->left = leaf;
+    root->right = leaf;
+    REQUIRE(leaf->use_count() == 3);
+  }
+  REQUIRE(live == 0);
+}
+
+// ------ ATOMIC POLICY -------
+
+TEST_CASE("thread safe counter survives concurrent copies",
+          "[intrusive_ptr][threads]") {
+  auto p = ds::make_intrusive<shared_node>();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([p] {
+      for (int i = 0; i < 10000; ++i) {
+        ds::intrusive_ptr<shared_node> copy = p;
+        (void)copy;
+      }
+    });
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+  REQUIRE(p->use_count() == 1);
+}
@@ -0,0 +1,82 @@
+#include "benchmark.hpp"
+#include "io_executor.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+
+constexpr std::size_t block = 4096;
+constexpr std::size_t blocks = 256;
+
+int scratch_file() {
+  char path[] = "/tmp/ds_io_bench_XXXXXX";
+  int fd = ::mkstemp(path);
+  ::unlink(path);
+  std::vector<std::byte> zeros(block * blocks);
+  if (::pwrite(fd, zeros.data(), zeros.size(), 0) < 0) {
+    std::abort();
+  }
+  return fd;
+}
+
+// One op is one 4 KiB read (page cache hot) whose completion runs on the
+// pool; requests go out `depth` at a time.
+void reads(ds::bench::state &st, bool fallback, std::size_t depth,
+           bool fixed) {
+  st.pause();
+  ds::thread_pool pool(1);
+  ds::io_executor::options opts;
+  opts.force_fallback = fallback;
+  ds::io_executor io(pool, opts);
+  int fd = scratch_file();
+  std::vector<std::byte> buffer(block * depth);
+  std::span<std::byte> registered[] = {buffer};
+  if (fixed) {
+    io.register_buffers(registered);
+  }
+  st.resume();
+
+  std::atomic<std::size_t> completed{0};
+  auto done = [&](ds::io_result) { completed.fetch_add(1); };
+  for (std::size_t i = 0; i < st.iterations(); i += depth) {
+    std::size_t n = std::min(depth, st.iterations() - i);
+    {
+      ds::io_executor::batch batch(io);
+      for (std::size_t k = 0; k < n; ++k) {
+        auto range = std::span(buffer).subspan(k * block, block);
+        std::uint64_t offset = ((i + k) % blocks) * block;
+        if (fixed) {
+          batch.read_fixed(fd, 0, range, offset, done);
+        } else {
+          batch.read(fd, range, offset, done);
+        }
+      }
+    }
+    io.drain();
+  }
+  ds::bench::do_not_optimize(completed.load());
+  ::close(fd);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  ds::bench::runner runner(argc, argv, "io_executor");
+  runner.add("read4k/blocking_thread/depth1",
+             [](ds::bench::state &st) { reads(st, true, 1, false); });
+  runner.add("read4k/io_uring/depth1",
+             [](ds::bench::state &st) { reads(st, false, 1, false); });
+  runner.add("read4k/blocking_thread/depth32",
+             [](ds::bench::state &st) { reads(st, true, 32, false); });
+  runner.add("read4k/io_uring/depth32",
+             [](ds::bench::state &st) { reads(st, false, 32, false); });
+  runner.add("read4k/io_uring_fixed/depth32",
+             [](ds::bench::state &st) { reads(st, false, 32, true); });
+  return runner.run();
+}
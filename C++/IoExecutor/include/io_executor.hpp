@@ -0,0 +1,582 @@
+#pragma once
+
+#include "io_ring.hpp"
+#include "thread_pool.hpp"
+#include "thread_safe_queue.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace ds {
+
+/*
+ * io_executor
+ * Asynchronous read / write / fsync for thread_pool tasks, so a worker
+ * that needs the disk hands the request off instead of blocking in it.
+ *
+ *   caller (any thread)          completion thread            thread_pool
+ *   read(fd, buf, off, done) --> io_uring SQ --> kernel --> CQE --> post(done)
+ *
+ * Every operation finishes by running its continuation on the pool: a
+ * callback, a std::promise for the future overloads, or the coroutine
+ * that co_awaited async_read()/async_write()/async_fsync().
+ *
+ *   io_uring        requests become SQEs under one mutex and are submitted
+ *                   with one io_uring_enter per call, or per batch with
+ *                   io_executor::batch. A dedicated thread sleeps in
+ *                   io_uring_enter(GETEVENTS) and reaps CQEs in bulk.
+ *   registered      register_buffers() pins buffers once; read_fixed /
+ *   buffers         write_fixed then transfer into them without the kernel
+ *                   mapping user pages on every request.
+ *   fallback        when io_uring is unavailable (old kernel, seccomp) or
+ *                   options::force_fallback is set, the same thread runs
+ *                   the requests with pread/pwrite/fsync instead. Regular
+ *                   files always poll as ready, so readiness polling cannot
+ *                   make disk I/O non-blocking; this keeps the blocking off
+ *                   the pool, which is the point.
+ *
+ * Results follow the syscall convention: bytes transferred, or -errno.
+ * Transfers are capped at MAX_RW_COUNT like read(2), so check for short
+ * counts. Buffers must stay valid until the continuation runs, and
+ * continuations must not throw. The pool must outlive the executor, whose
+ * destructor waits for every request in flight.
+ */
+
+enum class io_backend { io_uring, blocking_thread };
+
+struct io_result {
+  std::int32_t value; // bytes transferred, or -errno
+
+  [[nodiscard]] bool ok() const noexcept { return value >= 0; }
+  [[nodiscard]] std::size_t bytes() const noexcept {
+    return ok() ? static_cast<std::size_t>(value) : 0;
+  }
+  [[nodiscard]] std::error_code error() const noexcept {
+    return ok() ? std::error_code{}
+                : std::error_code(-value, std::generic_category());
+  }
+};
+
+class io_executor {
+  enum class op_kind : std::uint8_t {
+    read,
+    write,
+    fsync,
+    read_fixed,
+    write_fixed
+  };
+
+  struct operation {
+    virtual ~operation() = default;
+    virtual void complete(io_result result) = 0;
+
+    op_kind kind{};
+    int fd{-1};
+    void *data{nullptr};
+    std::uint32_t length{0};
+    std::uint64_t offset{0};
+    std::uint16_t buffer{0};
+    // io_uring hands the request between threads where TSAN cannot see;
+    // this flag makes the handoff visible.
+    std::atomic<bool> handed_off{false};
+  };
+
+  template <typename Fn> struct callback_operation final : operation {
+    template <typename F>
+    explicit callback_operation(F &&f) : fn(std::forward<F>(f)) {}
+    void complete(io_result result) override { fn(result); }
+    Fn fn;
+  };
+
+public:
+  struct options {
+    unsigned entries = 256;
+    bool force_fallback = false;
+  };
+
+  class batch;
+  class awaitable;
+
+  // Largest single transfer, as for read(2)/write(2).
+  static constexpr std::size_t max_transfer = 0x7ffff000;
+
+  explicit io_executor(thread_pool &pool) : io_executor(pool, options{}) {}
+  io_executor(thread_pool &pool, options opts) : pool_(pool) {
+    if (!opts.force_fallback) {
+      ring_ = io_ring::create(opts.entries);
+    }
+    if (ring_) {
+      completion_thread_ = std::thread([this] { reap_loop(); });
+    } else {
+      completion_thread_ = std::thread([this] { blocking_loop(); });
+    }
+  }
+
+  ~io_executor() {
+    drain();
+    if (ring_) {
+      // user_data 0 tells the reaper to stop.
+      std::lock_guard<std::mutex> lock(sq_mutex_);
+      io_uring_sqe *sqe = next_sqe();
+      sqe->opcode = IORING_OP_NOP;
+      submit_all();
+    } else {
+      pending_.shutdown();
+    }
+    completion_thread_.join();
+  }
+
+  io_executor(const io_executor &) = delete;
+  io_executor &operator=(const io_executor &) = delete;
+  io_executor(io_executor &&) = delete;
+  io_executor &operator=(io_executor &&) = delete;
+
+  [[nodiscard]] io_backend backend() const noexcept {
+    return ring_ ? io_backend::io_uring : io_backend::blocking_thread;
+  }
+
+  // Requests whose continuation has not finished yet.
+  [[nodiscard]] std::size_t in_flight() const noexcept {
+    return in_flight_.load();
+  }
+
+  // Blocks until every request so far has run its continuation.
+  void drain() {
+    std::unique_lock<std::mutex> lock(done_mutex_);
+    done_.wait(lock, [this] { return in_flight_.load() == 0; });
+  }
+
+  // ----- REQUESTS (callback runs on the pool with an io_result) -----
+
+  template <typename Fn>
+  void read(int fd, std::span<std::byte> buffer, std::uint64_t offset,
+            Fn &&done) {
+    start(make(op_kind::read, fd, buffer.data(), buffer.size(), offset,
+               std::forward<Fn>(done)));
+  }
+
+  template <typename Fn>
+  void write(int fd, std::span<const std::byte> buffer, std::uint64_t offset,
+             Fn &&done) {
+    start(make(op_kind::write, fd, const_cast<std::byte *>(buffer.data()),
+               buffer.size(), offset, std::forward<Fn>(done)));
+  }
+
+  template <typename Fn> void fsync(int fd, Fn &&done) {
+    start(make(op_kind::fsync, fd, nullptr, 0, 0, std::forward<Fn>(done)));
+  }
+
+  // ----- REQUESTS (future) -----
+
+  [[nodiscard]] std::future<io_result>
+  read(int fd, std::span<std::byte> buffer, std::uint64_t offset) {
+    return with_future(
+        [&](auto done) { read(fd, buffer, offset, std::move(done)); });
+  }
+
+  [[nodiscard]] std::future<io_result>
+  write(int fd, std::span<const std::byte> buffer, std::uint64_t offset) {
+    return with_future(
+        [&](auto done) { write(fd, buffer, offset, std::move(done)); });
+  }
+
+  [[nodiscard]] std::future<io_result> fsync(int fd) {
+    return with_future([&](auto done) { fsync(fd, std::move(done)); });
+  }
+
+  // ----- REQUESTS (coroutine; resumes on the pool) -----
+
+  [[nodiscard]] awaitable async_read(int fd, std::span<std::byte> buffer,
+                                     std::uint64_t offset);
+  [[nodiscard]] awaitable async_write(int fd,
+                                      std::span<const std::byte> buffer,
+                                      std::uint64_t offset);
+  [[nodiscard]] awaitable async_fsync(int fd);
+
+  // ----- REGISTERED BUFFERS -----
+
+  // Pins `buffers` (once per executor) for read_fixed/write_fixed, which
+  // name a buffer by index and transfer into a sub-range of it.
+  void register_buffers(std::span<const std::span<std::byte>> buffers) {
+    std::lock_guard<std::mutex> lock(sq_mutex_);
+    if (!registered_.empty()) {
+      throw std::logic_error("io_executor: buffers already registered");
+    }
+    std::vector<iovec> iovecs;
+    iovecs.reserve(buffers.size());
+    for (std::span<std::byte> b : buffers) {
+      iovecs.push_back(iovec{b.data(), b.size()});
+    }
+    if (ring_) {
+      ring_->register_buffers(iovecs);
+    }
+    registered_ = std::move(iovecs);
+  }
+
+  template <typename Fn>
+  void read_fixed(int fd, std::size_t buffer, std::span<std::byte> range,
+                  std::uint64_t offset, Fn &&done) {
+    check_registered(buffer, range.data(), range.size());
+    auto op = make(op_kind::read_fixed, fd, range.data(), range.size(), offset,
+                   std::forward<Fn>(done));
+    op->buffer = static_cast<std::uint16_t>(buffer);
+    start(std::move(op));
+  }
+
+  template <typename Fn>
+  void write_fixed(int fd, std::size_t buffer,
+                   std::span<const std::byte> range, std::uint64_t offset,
+                   Fn &&done) {
+    check_registered(buffer, range.data(), range.size());
+    auto op = make(op_kind::write_fixed, fd,
+                   const_cast<std::byte *>(range.data()), range.size(), offset,
+                   std::forward<Fn>(done));
+    op->buffer = static_cast<std::uint16_t>(buffer);
+    start(std::move(op));
+  }
+
+private:
+  // ----- OPERATIONS -----
+
+  template <typename Fn>
+  static std::unique_ptr<operation> make(op_kind kind, int fd, std::byte *data,
+                                         std::size_t length,
+                                         std::uint64_t offset, Fn &&done) {
+    auto op = std::make_unique<callback_operation<std::decay_t<Fn>>>(
+        std::forward<Fn>(done));
+    op->kind = kind;
+    op->fd = fd;
+    op->data = data;
+    op->length = static_cast<std::uint32_t>(std::min(length, max_transfer));
+    op->offset = offset;
+    return op;
+  }
+
+  template <typename Issue> std::future<io_result> with_future(Issue issue) {
+    std::promise<io_result> promise;
+    std::future<io_result> future = promise.get_future();
+    issue([promise = std::move(promise)](io_result r) mutable {
+      promise.set_value(r);
+    });
+    return future;
+  }
+
+  void check_registered(std::size_t buffer, const std::byte *data,
+                        std::size_t length) const {
+    std::lock_guard<std::mutex> lock(sq_mutex_);
+    if (buffer >= registered_.size()) {
+      throw std::out_of_range("io_executor: no such registered buffer");
+    }
+    const auto *base =
+        static_cast<const std::byte *>(registered_[buffer].iov_base);
+    if (data < base || data + length > base + registered_[buffer].iov_len) {
+      throw std::out_of_range("io_executor: range outside registered buffer");
+    }
+  }
+
+  void start(std::unique_ptr<operation> op) {
+    operation *ops[] = {op.release()};
+    start_all(ops);
+  }
+
+  // Takes ownership of every op. From here each one finishes through
+  // finish(), with -errno if the ring refuses it.
+  void start_all(std::span<operation *const> ops) {
+    in_flight_.fetch_add(ops.size());
+    if (!ring_) {
+      for (operation *op : ops) {
+        pending_.push(op);
+      }
+      return;
+    }
+    std::lock_guard<std::mutex> lock(sq_mutex_);
+    for (operation *op : ops) {
+      prepare(*next_sqe(), *op);
+    }
+    submit_all();
+  }
+
+  // ----- IO_URING BACKEND -----
+
+  // Caller holds sq_mutex_.
+  io_uring_sqe *next_sqe() {
+    io_uring_sqe *sqe = nullptr;
+    while ((sqe = ring_->next_sqe()) == nullptr) {
+      if (submit() == 0) {
+        std::this_thread::yield();
+      }
+    }
+    return sqe;
+  }
+
+  void submit_all() {
+    while (ring_->unsubmitted() != 0) {
+      if (submit() == 0) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  // The SQEs are already in the ring, each naming its op. If the kernel
+  // refuses them, take them back and fail their ops instead of throwing
+  // while the ops are half owned by the kernel.
+  unsigned submit() {
+    try {
+      return ring_->submit();
+    } catch (const std::system_error &e) {
+      ring_->retract([&](std::uint64_t user_data) {
+        if (user_data != 0) {
+          finish(reinterpret_cast<operation *>(user_data),
+                 io_result{-e.code().value()});
+        }
+      });
+      return 1;
+    }
+  }
+
+  static void prepare(io_uring_sqe &sqe, operation &op) {
+    switch (op.kind) {
+    case op_kind::read:
+      sqe.opcode = IORING_OP_READ;
+      break;
+    case op_kind::write:
+      sqe.opcode = IORING_OP_WRITE;
+      break;
+    case op_kind::fsync:
+      sqe.opcode = IORING_OP_FSYNC;
+      break;
+    case op_kind::read_fixed:
+      sqe.opcode = IORING_OP_READ_FIXED;
+      sqe.buf_index = op.buffer;
+      break;
+    case op_kind::write_fixed:
+      sqe.opcode = IORING_OP_WRITE_FIXED;
+      sqe.buf_index = op.buffer;
+      break;
+    }
+    sqe.fd = op.fd;
+    sqe.addr = reinterpret_cast<std::uintptr_t>(op.data);
+    sqe.len = op.length;
+    sqe.off = op.offset;
+    sqe.user_data = reinterpret_cast<std::uintptr_t>(&op);
+    // Last touch before the kernel owns it.
+    op.handed_off.store(true, std::memory_order_release);
+  }
+
+  void reap_loop() {
+    std::array<io_ring::completion, 64> completions;
+    bool stopping = false;
+    while (!stopping) {
+      ring_->wait();
+      std::size_t n = 0;
+      while ((n = ring_->reap(completions)) != 0) {
+        for (const io_ring::completion &c : std::span(completions).first(n)) {
+          if (c.user_data == 0) {
+            stopping = true;
+            continue;
+          }
+          finish(reinterpret_cast<operation *>(c.user_data),
+                 io_result{c.result});
+        }
+      }
+    }
+  }
+
+  // ----- FALLBACK BACKEND -----
+
+  void blocking_loop() {
+    operation *op = nullptr;
+    while (pending_.wait_and_pop(op)) {
+      finish(op, io_result{run_blocking(*op)});
+    }
+  }
+
+  static std::int32_t run_blocking(const operation &op) {
+    auto offset = static_cast<off_t>(op.offset);
+    ssize_t result = 0;
+    switch (op.kind) {
+    case op_kind::read:
+    case op_kind::read_fixed:
+      result = ::pread(op.fd, op.data, op.length, offset);
+      break;
+    case op_kind::write:
+    case op_kind::write_fixed:
+      result = ::pwrite(op.fd, op.data, op.length, offset);
+      break;
+    case op_kind::fsync:
+      result = ::fsync(op.fd);
+      break;
+    }
+    return result < 0 ? -errno : static_cast<std::int32_t>(result);
+  }
+
+  // ----- COMPLETION -----
+
+  void finish(operation *op, io_result result) {
+    op->handed_off.load(std::memory_order_acquire);
+    pool_.post([this, op, result] {
+      std::unique_ptr<operation> owned(op);
+      owned->complete(result);
+      owned.reset();
+      // Under the lock: drain() cannot see zero, and the destructor cannot
+      // free done_, until this thread is done touching the executor.
+      std::lock_guard<std::mutex> lock(done_mutex_);
+      if (in_flight_.fetch_sub(1) == 1) {
+        done_.notify_all();
+      }
+    });
+  }
+
+  thread_pool &pool_;
+  std::optional<io_ring> ring_;
+  mutable std::mutex sq_mutex_;
+  std::vector<iovec> registered_;
+  thread_safe_queue<operation *> pending_; // fallback only
+  std::atomic<std::size_t> in_flight_{0};
+  std::mutex done_mutex_;
+  std::condition_variable done_;
+  std::thread completion_thread_;
+};
+
+// ----- BATCH -----
+
+// Collects requests and submits them with one lock and one
+// io_uring_enter when submit() is called or the batch is destroyed.
+class io_executor::batch {
+public:
+  explicit batch(io_executor &io) : io_(io) {}
+  ~batch() { submit(); }
+
+  batch(const batch &) = delete;
+  batch &operator=(const batch &) = delete;
+
+  template <typename Fn>
+  batch &read(int fd, std::span<std::byte> buffer, std::uint64_t offset,
+              Fn &&done) {
+    return add(make(op_kind::read, fd, buffer.data(), buffer.size(), offset,
+                    std::forward<Fn>(done)));
+  }
+
+  template <typename Fn>
+  batch &write(int fd, std::span<const std::byte> buffer,
+               std::uint64_t offset, Fn &&done) {
+    return add(make(op_kind::write, fd, const_cast<std::byte *>(buffer.data()),
+                    buffer.size(), offset, std::forward<Fn>(done)));
+  }
+
+  template <typename Fn> batch &fsync(int fd, Fn &&done) {
+    return add(
+        make(op_kind::fsync, fd, nullptr, 0, 0, std::forward<Fn>(done)));
+  }
+
+  template <typename Fn>
+  batch &read_fixed(int fd, std::size_t buffer, std::span<std::byte> range,
+                    std::uint64_t offset, Fn &&done) {
+    io_.check_registered(buffer, range.data(), range.size());
+    auto op = make(op_kind::read_fixed, fd, range.data(), range.size(), offset,
+                   std::forward<Fn>(done));
+    op->buffer = static_cast<std::uint16_t>(buffer);
+    return add(std::move(op));
+  }
+
+  [[nodiscard]] std::size_t size() const noexcept { return ops_.size(); }
+
+  void submit() {
+    if (ops_.empty()) {
+      return;
+    }
+    std::vector<operation *> raw;
+    raw.reserve(ops_.size());
+    for (auto &op : ops_) {
+      raw.push_back(op.release());
+    }
+    ops_.clear();
+    io_.start_all(raw);
+  }
+
+private:
+  batch &add(std::unique_ptr<operation> op) {
+    ops_.push_back(std::move(op));
+    return *this;
+  }
+
+  io_executor &io_;
+  std::vector<std::unique_ptr<operation>> ops_;
+};
+
+// ----- AWAITABLE -----
+
+// co_await yields the io_result; the coroutine resumes on a pool worker.
+class io_executor::awaitable {
+public:
+  [[nodiscard]] bool await_ready() const noexcept { return false; }
+
+  void await_suspend(std::coroutine_handle<> handle) {
+    // The operation may complete and resume the coroutine (destroying this
+    // awaitable) before start() returns; touch nothing afterwards.
+    io_result *slot = &result_;
+    io_.start(make(kind_, fd_, data_, length_, offset_,
+                   [slot, handle](io_result r) {
+                     *slot = r;
+                     handle.resume();
+                   }));
+  }
+
+  [[nodiscard]] io_result await_resume() const noexcept { return result_; }
+
+private:
+  friend class io_executor;
+
+  awaitable(io_executor &io, op_kind kind, int fd, std::byte *data,
+            std::size_t length, std::uint64_t offset)
+      : io_(io), kind_(kind), fd_(fd), data_(data), length_(length),
+        offset_(offset) {}
+
+  io_executor &io_;
+  op_kind kind_;
+  int fd_;
+  std::byte *data_;
+  std::size_t length_;
+  std::uint64_t offset_;
+  io_result result_{0};
+};
+
+inline io_executor::awaitable
+io_executor::async_read(int fd, std::span<std::byte> buffer,
+                        std::uint64_t offset) {
+  return awaitable(*this, op_kind::read, fd, buffer.data(), buffer.size(),
+                   offset);
+}
+
+inline io_executor::awaitable
+io_executor::async_write(int fd, std::span<const std::byte> buffer,
+                         std::uint64_t offset) {
+  return awaitable(*this, op_kind::write, fd,
+                   const_cast<std::byte *>(buffer.data()), buffer.size(),
+                   offset);
+}
+
+inline io_executor::awaitable io_executor::async_fsync(int fd) {
+  return awaitable(*this, op_kind::fsync, fd, nullptr, 0, 0);
+}
+
+} // namespace ds
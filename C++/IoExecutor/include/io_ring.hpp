@@ -0,0 +1,268 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <system_error>
+#include <utility>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace ds {
+
+/*
+ * io_ring
+ * Minimal io_uring wrapper on the raw syscalls (no liburing).
+ *
+ *   submission queue   user fills SQEs and bumps the tail; the kernel
+ *                      consumes up to the tail on io_uring_enter()
+ *   completion queue   the kernel posts CQEs and bumps the tail; the user
+ *                      reads them and bumps the head
+ *
+ * Both rings and the SQE array are shared mappings of the ring fd. Heads
+ * and tails the other side writes are accessed through std::atomic_ref
+ * with acquire/release, the ordering the io_uring ABI specifies.
+ *
+ * Not thread safe by itself: one thread (or a mutex) owns the submission
+ * side and one thread owns the completion side. create() returns nullopt
+ * when the kernel refuses io_uring (ENOSYS, or EPERM under seccomp) so the
+ * caller can fall back.
+ */
+class io_ring {
+public:
+  struct completion {
+    std::uint64_t user_data;
+    std::int32_t result; // >= 0 on success, -errno on failure
+  };
+
+  [[nodiscard]] static std::optional<io_ring> create(unsigned entries) {
+    io_uring_params params{};
+    long fd = ::syscall(__NR_io_uring_setup, entries, &params);
+    if (fd < 0) {
+      return std::nullopt;
+    }
+    return io_ring(static_cast<int>(fd), params);
+  }
+
+  ~io_ring() { release(); }
+
+  io_ring(io_ring &&other) noexcept { steal(other); }
+  io_ring &operator=(io_ring &&other) noexcept {
+    if (this != &other) {
+      release();
+      steal(other);
+    }
+    return *this;
+  }
+  io_ring(const io_ring &) = delete;
+  io_ring &operator=(const io_ring &) = delete;
+
+  [[nodiscard]] unsigned sq_entries() const noexcept { return sq_entries_; }
+
+  // ----- SUBMISSION SIDE -----
+
+  // A zeroed SQE to fill, or nullptr while every slot still waits for the
+  // kernel; submit() publishes it.
+  [[nodiscard]] io_uring_sqe *next_sqe() noexcept {
+    std::uint32_t head = std::atomic_ref<std::uint32_t>(*sq_head_).load(
+        std::memory_order_acquire);
+    if (sq_tail_ - head >= sq_entries_) {
+      return nullptr;
+    }
+    std::uint32_t index = sq_tail_ & sq_mask_;
+    io_uring_sqe *sqe = &sqes_[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sq_array_[index] = index;
+    ++sq_tail_;
+    ++unsubmitted_;
+    return sqe;
+  }
+
+  [[nodiscard]] unsigned unsubmitted() const noexcept { return unsubmitted_; }
+
+  // Publishes the SQEs filled since the last call and hands every queued
+  // one to the kernel; returns how many it took. Throws std::system_error
+  // on failure other than a transient EAGAIN/EBUSY/EINTR.
+  unsigned submit() {
+    if (unsubmitted_ == 0) {
+      return 0;
+    }
+    std::atomic_ref<std::uint32_t>(*sq_ktail_).store(sq_tail_,
+                                                     std::memory_order_release);
+    long taken = enter(unsubmitted_, 0, 0);
+    if (taken < 0) {
+      if (errno == EAGAIN || errno == EBUSY || errno == EINTR) {
+        return 0;
+      }
+      throw std::system_error(errno, std::generic_category(),
+                              "io_uring_enter");
+    }
+    unsubmitted_ -= static_cast<unsigned>(taken);
+    return static_cast<unsigned>(taken);
+  }
+
+  // After submit() threw: takes back the SQEs the kernel has not consumed
+  // and calls fn(user_data) for each, oldest first. Without SQPOLL the
+  // kernel reads the SQ only inside io_uring_enter, so a retracted entry is
+  // never seen and its slot is free again.
+  template <typename Fn> void retract(Fn &&fn) {
+    for (std::uint32_t i = sq_tail_ - unsubmitted_; i != sq_tail_; ++i) {
+      fn(sqes_[i & sq_mask_].user_data);
+    }
+    sq_tail_ -= unsubmitted_;
+    unsubmitted_ = 0;
+    std::atomic_ref<std::uint32_t>(*sq_ktail_).store(sq_tail_,
+                                                     std::memory_order_release);
+  }
+
+  // Pins `buffers` for *_FIXED operations, indexed in order.
+  void register_buffers(std::span<const iovec> buffers) {
+    if (::syscall(__NR_io_uring_register, fd_, IORING_REGISTER_BUFFERS,
+                  buffers.data(), static_cast<unsigned>(buffers.size())) < 0) {
+      throw std::system_error(errno, std::generic_category(),
+                              "io_uring_register");
+    }
+  }
+
+  // ----- COMPLETION SIDE -----
+
+  // Blocks until at least one completion is posted (or a signal arrives).
+  void wait() {
+    if (enter(0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR &&
+        errno != EAGAIN && errno != EBUSY) {
+      throw std::system_error(errno, std::generic_category(),
+                              "io_uring_enter");
+    }
+  }
+
+  // Copies up to out.size() completions out and releases their slots.
+  std::size_t reap(std::span<completion> out) noexcept {
+    std::uint32_t head = *cq_head_;
+    std::uint32_t tail = std::atomic_ref<std::uint32_t>(*cq_tail_).load(
+        std::memory_order_acquire);
+    std::size_t n = std::min<std::size_t>(tail - head, out.size());
+    for (std::size_t i = 0; i < n; ++i) {
+      const io_uring_cqe &cqe = cqes_[(head + i) & cq_mask_];
+      out[i] = completion{cqe.user_data, cqe.res};
+    }
+    std::atomic_ref<std::uint32_t>(*cq_head_).store(
+        head + static_cast<std::uint32_t>(n), std::memory_order_release);
+    return n;
+  }
+
+private:
+  io_ring(int fd, const io_uring_params &p) : fd_(fd) {
+    sq_bytes_ = p.sq_off.array + p.sq_entries * sizeof(std::uint32_t);
+    cq_bytes_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    bool single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single) {
+      sq_bytes_ = cq_bytes_ = std::max(sq_bytes_, cq_bytes_);
+    }
+    sq_map_ = map(sq_bytes_, IORING_OFF_SQ_RING);
+    cq_map_ = single ? sq_map_ : map(cq_bytes_, IORING_OFF_CQ_RING);
+    sqes_bytes_ = p.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe *>(map(sqes_bytes_, IORING_OFF_SQES));
+
+    auto *sq = static_cast<std::byte *>(sq_map_);
+    sq_head_ = reinterpret_cast<std::uint32_t *>(sq + p.sq_off.head);
+    sq_ktail_ = reinterpret_cast<std::uint32_t *>(sq + p.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<std::uint32_t *>(sq + p.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<std::uint32_t *>(sq + p.sq_off.array);
+    sq_entries_ = p.sq_entries;
+    sq_tail_ = *sq_ktail_;
+
+    auto *cq = static_cast<std::byte *>(cq_map_);
+    cq_head_ = reinterpret_cast<std::uint32_t *>(cq + p.cq_off.head);
+    cq_tail_ = reinterpret_cast<std::uint32_t *>(cq + p.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<std::uint32_t *>(cq + p.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe *>(cq + p.cq_off.cqes);
+  }
+
+  void *map(std::size_t bytes, std::uint64_t offset) {
+    void *p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, fd_,
+                     static_cast<off_t>(offset));
+    if (p == MAP_FAILED) {
+      int error = errno;
+      release();
+      throw std::system_error(error, std::generic_category(), "mmap io_uring");
+    }
+    return p;
+  }
+
+  long enter(unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return ::syscall(__NR_io_uring_enter, fd_, to_submit, min_complete, flags,
+                     nullptr, 0);
+  }
+
+  void release() noexcept {
+    if (sqes_ != nullptr) {
+      ::munmap(sqes_, sqes_bytes_);
+    }
+    if (cq_map_ != nullptr && cq_map_ != sq_map_) {
+      ::munmap(cq_map_, cq_bytes_);
+    }
+    if (sq_map_ != nullptr) {
+      ::munmap(sq_map_, sq_bytes_);
+    }
+    if (fd_ >= 0) {
+      ::close(fd_);
+    }
+    sqes_ = nullptr;
+    sq_map_ = cq_map_ = nullptr;
+    fd_ = -1;
+  }
+
+  void steal(io_ring &other) noexcept {
+    fd_ = std::exchange(other.fd_, -1);
+    sq_map_ = std::exchange(other.sq_map_, nullptr);
+    cq_map_ = std::exchange(other.cq_map_, nullptr);
+    sqes_ = std::exchange(other.sqes_, nullptr);
+    sq_bytes_ = other.sq_bytes_;
+    cq_bytes_ = other.cq_bytes_;
+    sqes_bytes_ = other.sqes_bytes_;
+    sq_head_ = other.sq_head_;
+    sq_ktail_ = other.sq_ktail_;
+    sq_array_ = other.sq_array_;
+    sq_mask_ = other.sq_mask_;
+    sq_entries_ = other.sq_entries_;
+    sq_tail_ = other.sq_tail_;
+    unsubmitted_ = other.unsubmitted_;
+    cq_head_ = other.cq_head_;
+    cq_tail_ = other.cq_tail_;
+    cq_mask_ = other.cq_mask_;
+    cqes_ = other.cqes_;
+  }
+
+  int fd_{-1};
+  void *sq_map_{nullptr};
+  void *cq_map_{nullptr};
+  io_uring_sqe *sqes_{nullptr};
+  std::size_t sq_bytes_{0};
+  std::size_t cq_bytes_{0};
+  std::size_t sqes_bytes_{0};
+
+  std::uint32_t *sq_head_{nullptr};
+  std::uint32_t *sq_ktail_{nullptr};
+  std::uint32_t *sq_array_{nullptr};
+  std::uint32_t sq_mask_{0};
+  unsigned sq_entries_{0};
+  std::uint32_t sq_tail_{0};
+  unsigned unsubmitted_{0};
+
+  std::uint32_t *cq_head_{nullptr};
+  std::uint32_t *cq_tail_{nullptr};
+  std::uint32_t cq_mask_{0};
+  io_uring_cqe *cqes_{nullptr};
+};
+
+} // namespace ds
@@ -0,0 +1,253 @@
+#include "io_executor.hpp"
+#include <catch2/catch_test_macros.hpp>
+
+#include <array>
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+// An unlinked temporary file, closed on scope exit.
+struct temp_file {
+  temp_file() {
+    char path[] = "/tmp/ds_io_executor_XXXXXX";
+    fd = ::mkstemp(path);
+    REQUIRE(fd >= 0);
+    ::unlink(path);
+  }
+  ~temp_file() { ::close(fd); }
+  int fd;
+};
+
+std::span<const std::byte> bytes_of(const std::string &s) {
+  return std::as_bytes(std::span(s.data(), s.size()));
+}
+
+std::string text_of(std::span<const std::byte> b) {
+  return {reinterpret_cast<const char *>(b.data()), b.size()};
+}
+
+ds::io_executor::options backend_options(bool fallback) {
+  ds::io_executor::options opts;
+  opts.force_fallback = fallback;
+  return opts;
+}
+
+// Fire-and-forget coroutine; the test waits on a promise instead.
+struct detached {
+  struct promise_type {
+    detached get_return_object() noexcept { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+};
+
+} // namespace
+
+// ------ REQUESTS -------
+
+TEST_CASE("write then read back through futures", "[io]") {
+  for (bool fallback : {false, true}) {
+    ds::thread_pool pool(2);
+    ds::io_executor io(pool, backend_options(fallback));
+    if (fallback) {
+      REQUIRE(io.backend() == ds::io_backend::blocking_thread);
+    }
+    temp_file file;
+
+    std::string text = "journal entry";
+    auto written = io.write(file.fd, bytes_of(text), 0).get();
+    REQUIRE(written.ok());
+    REQUIRE(written.bytes() == text.size());
+    REQUIRE(io.fsync(file.fd).get().ok());
+
+    std::array<std::byte, 64> buffer{};
+    auto read = io.read(file.fd, buffer, 0).get();
+    REQUIRE(read.bytes() == text.size());
+    REQUIRE(text_of(std::span(buffer).first(read.bytes())) == text);
+  }
+}
+
+TEST_CASE("callbacks run on the pool", "[io]") {
+  for (bool fallback : {false, true}) {
+    ds::thread_pool pool(1);
+    std::thread::id worker = pool.submit([] {
+                                   return std::this_thread::get_id();
+                                 }).get();
+    ds::io_executor io(pool, backend_options(fallback));
+    temp_file file;
+
+    std::promise<std::thread::id> ran_on;
+    std::string text = "x";
+    io.write(file.fd, bytes_of(text), 0, [&](ds::io_result r) {
+      REQUIRE(r.ok());
+      ran_on.set_value(std::this_thread::get_id());
+    });
+    REQUIRE(ran_on.get_future().get() == worker);
+    io.drain();
+    REQUIRE(io.in_flight() == 0);
+  }
+}
+
+TEST_CASE("errors come back as -errno", "[io]") {
+  for (bool fallback : {false, true}) {
+    ds::thread_pool pool(1);
+    ds::io_executor io(pool, backend_options(fallback));
+    std::array<std::byte, 8> buffer{};
+    auto result = io.read(-1, buffer, 0).get();
+    REQUIRE_FALSE(result.ok());
+    REQUIRE(result.error() == std::errc::bad_file_descriptor);
+  }
+}
+
+TEST_CASE("destruction waits for the last continuation", "[io]") {
+  ds::thread_pool pool(2);
+  temp_file file;
+  std::array<std::byte, 8> buffer{};
+  std::atomic<int> done{0};
+  for (int round = 0; round < 200; ++round) {
+    ds::io_executor io(pool, backend_options(round % 2 == 1));
+    io.read(file.fd, buffer, 0, [&](ds::io_result) { ++done; });
+  }
+  REQUIRE(done == 200);
+}
+
+TEST_CASE("a batch lands every request", "[io][batch]") {
+  for (bool fallback : {false, true}) {
+    ds::thread_pool pool(2);
+    ds::io_executor io(pool, backend_options(fallback));
+    temp_file file;
+
+    constexpr std::size_t records = 32;
+    std::vector<std::string> blocks;
+    for (std::size_t i = 0; i < records; ++i) {
+      blocks.push_back("record-" + std::to_string(100 + i) + "\n");
+    }
+    std::atomic<std::size_t> done{0};
+    {
+      ds::io_executor::batch batch(io);
+      for (std::size_t i = 0; i < records; ++i) {
+        batch.write(file.fd, bytes_of(blocks[i]), i * blocks[i].size(),
+                    [&](ds::io_result r) {
+                      if (r.ok()) {
+                        ++done;
+                      }
+                    });
+      }
+      REQUIRE(batch.size() == records);
+    }
+    io.drain();
+    REQUIRE(done == records);
+
+    std::vector<std::byte> contents(records * blocks[0].size());
+    REQUIRE(io.read(file.fd, contents, 0).get().bytes() == contents.size());
+    std::string expected;
+    for (const auto &b : blocks) {
+      expected += b;
+    }
+    REQUIRE(text_of(contents) == expected);
+  }
+}
+
+// ------ REGISTERED BUFFERS -------
+
+TEST_CASE("fixed reads and writes use registered buffers", "[io][fixed]") {
+  for (bool fallback : {false, true}) {
+    ds::thread_pool pool(1);
+    ds::io_executor io(pool, backend_options(fallback));
+    temp_file file;
+
+    std::vector<std::byte> out(4096), in(4096);
+    std::span<std::byte> buffers[] = {out, in};
+    io.register_buffers(buffers);
+    REQUIRE_THROWS_AS(io.register_buffers(buffers), std::logic_error);
+
+    std::memcpy(out.data(), "fixed buffer payload", 20);
+    std::promise<ds::io_result> wrote;
+    io.write_fixed(file.fd, 0, std::span(out).first(20), 0,
+                   [&](ds::io_result r) { wrote.set_value(r); });
+    REQUIRE(wrote.get_future().get().bytes() == 20);
+
+    std::promise<ds::io_result> read;
+    io.read_fixed(file.fd, 1, std::span(in).subspan(100, 20), 0,
+                  [&](ds::io_result r) { read.set_value(r); });
+    REQUIRE(read.get_future().get().bytes() == 20);
+    REQUIRE(text_of(std::span(in).subspan(100, 20)) == "fixed buffer payload");
+
+    std::vector<std::byte> stray(16);
+    REQUIRE_THROWS_AS(io.read_fixed(file.fd, 1, stray, 0, [](ds::io_result) {}),
+                      std::out_of_range);
+    REQUIRE_THROWS_AS(io.read_fixed(file.fd, 2, in, 0, [](ds::io_result) {}),
+                      std::out_of_range);
+  }
+}
+
+// ------ RING -------
+
+TEST_CASE("retracted entries never reach the kernel", "[io][ring]") {
+  auto ring = ds::io_ring::create(8);
+  if (!ring) {
+    WARN("io_uring unavailable");
+    return;
+  }
+  for (std::uint64_t id = 1; id <= 3; ++id) {
+    io_uring_sqe *sqe = ring->next_sqe();
+    sqe->opcode = IORING_OP_NOP;
+    sqe->user_data = id;
+  }
+  std::vector<std::uint64_t> retracted;
+  ring->retract([&](std::uint64_t id) { retracted.push_back(id); });
+  REQUIRE(retracted == std::vector<std::uint64_t>{1, 2, 3});
+  REQUIRE(ring->unsubmitted() == 0);
+
+  io_uring_sqe *sqe = ring->next_sqe();
+  sqe->opcode = IORING_OP_NOP;
+  sqe->user_data = 4;
+  REQUIRE(ring->submit() == 1);
+  ring->wait();
+  std::array<ds::io_ring::completion, 8> out{};
+  REQUIRE(ring->reap(out) == 1);
+  REQUIRE(out[0].user_data == 4);
+}
+
+// ------ COROUTINES -------
+
+TEST_CASE("a coroutine awaits I/O and resumes on the pool", "[io][coro]") {
+  for (bool fallback : {false, true}) {
+    ds::thread_pool pool(1);
+    std::thread::id worker = pool.submit([] {
+                                   return std::this_thread::get_id();
+                                 }).get();
+    ds::io_executor io(pool, backend_options(fallback));
+    temp_file file;
+    std::promise<std::string> finished;
+
+    auto task = [&]() -> detached {
+      std::string text = "awaited";
+      ds::io_result w = co_await io.async_write(file.fd, bytes_of(text), 0);
+      bool on_pool = std::this_thread::get_id() == worker;
+      co_await io.async_fsync(file.fd);
+      std::array<std::byte, 16> buffer{};
+      ds::io_result r = co_await io.async_read(file.fd, buffer, 0);
+      finished.set_value(on_pool && w.ok()
+                             ? text_of(std::span(buffer).first(r.bytes()))
+                             : "");
+    };
+    task();
+    REQUIRE(finished.get_future().get() == "awaited");
+  }
+}
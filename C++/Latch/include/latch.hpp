@@ -1,13 +1,24 @@
+#include "profiled_mutex.hpp"
+
 #include <condition_variable>
 #include <cstddef>
 #include <mutex>
+#include <string_view>
+#include <type_traits>
+
+// Mutex may be ds::profiled_mutex to record contention under the
+// "CountDownLatch" lock site (see ProfiledCountDownLatch below).
+template <typename Mutex = std::mutex> class BasicCountDownLatch {
+  // std::condition_variable only works with std::unique_lock<std::mutex>.
+  using condition = std::conditional_t<std::is_same_v<Mutex, std::mutex>,
+                                       std::condition_variable,
+                                       std::condition_variable_any>;
 
-class CountDownLatch {
 public:
-  explicit CountDownLatch(std::size_t count) : count_(count) {}
+  explicit BasicCountDownLatch(std::size_t count) : count_(count) {}
 
   void count_down() {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<Mutex> lock(mutex_);
     if (count_ > 0) {
       if (--count_ == 0) {
         cv_.notify_all();
@@ -16,7 +27,7 @@ public:
   }
 
   void count_down(std::size_t n) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<Mutex> lock(mutex_);
     count_ = count_ >= n ? count_ - n : 0;
     if (count_ == 0) {
       cv_.notify_all();
@@ -24,22 +35,33 @@ public:
   }
 
   void wait() {
-    std::unique_lock<std::mutex> lock(mutex_);
+    std::unique_lock<Mutex> lock(mutex_);
     cv_.wait(lock, [this] { return count_ == 0; });
   }
 
   std::size_t get_count() {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<Mutex> lock(mutex_);
     return count_;
   }
 
   bool is_done() {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<Mutex> lock(mutex_);
     return count_ == 0;
   }
 
 private:
+  static Mutex make_mutex() {
+    if constexpr (std::is_constructible_v<Mutex, std::string_view>) {
+      return Mutex("CountDownLatch");
+    } else {
+      return Mutex();
+    }
+  }
+
   std::size_t count_;
-  std::mutex mutex_;
-  std::condition_variable cv_;
+  Mutex mutex_ = make_mutex();
+  condition cv_;
 };
+
+using CountDownLatch = BasicCountDownLatch<>;
+using ProfiledCountDownLatch = BasicCountDownLatch<ds::profiled_mutex>;
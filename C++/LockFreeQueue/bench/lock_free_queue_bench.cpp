@@ -0,0 +1,61 @@
+#include "benchmark.hpp"
+#include "lock_free_queue.hpp"
+#include "thread_safe_queue.hpp"
+
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace {
+
+template <typename Queue> void push_pop(ds::bench::state &st) {
+  Queue q;
+  std::size_t out = 0;
+  for (std::size_t i = 0; i < st.iterations(); ++i) {
+    q.push(i);
+    q.try_pop(out);
+    ds::bench::do_not_optimize(out);
+  }
+}
+
+// Two producers, two consumers; one op is one element through the queue.
+template <typename Queue> void two_by_two(ds::bench::state &st) {
+  Queue q;
+  std::size_t per_thread = st.iterations() / 2;
+  std::vector<std::thread> threads;
+  for (int p = 0; p < 2; ++p) {
+    threads.emplace_back([&] {
+      for (std::size_t i = 0; i < per_thread; ++i) {
+        q.push(i);
+      }
+    });
+  }
+  for (int c = 0; c < 2; ++c) {
+    threads.emplace_back([&] {
+      std::size_t out = 0;
+      for (std::size_t i = 0; i < per_thread; ++i) {
+        q.wait_and_pop(out);
+      }
+      ds::bench::do_not_optimize(out);
+    });
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  ds::bench::runner runner(argc, argv, "lock_free_queue");
+
+  runner.add("push_pop/single_thread/lock_free",
+             push_pop<ds::lock_free_queue<std::size_t>>);
+  runner.add("push_pop/single_thread/mutex",
+             push_pop<ds::thread_safe_queue<std::size_t>>);
+  runner.add("mpmc/2x2/lock_free",
+             two_by_two<ds::lock_free_queue<std::size_t>>);
+  runner.add("mpmc/2x2/mutex", two_by_two<ds::thread_safe_queue<std::size_t>>);
+
+  return runner.run();
+}
@@ -0,0 +1,336 @@
+#pragma once
+
+#include "epoch_reclamation.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace ds {
+
+/*
+ * lock_free_queue<T, SegmentSize>
+ * Unbounded multi-producer multi-consumer queue with thread_safe_queue's
+ * API, built from a linked list of fixed-size segments:
+ *
+ *   head_                                         tail_
+ *     v                                             v
+ *   [ x x x . . . ] -> [ . . . . . . ] -> [ . . . _ _ _ ]
+ *     deq_idx ^                              enq_idx ^
+ *
+ * 1) push: fetch_add the tail segment's enq_idx to claim a cell, then CAS
+ *    the cell empty -> full
+ * 2) pop: fetch_add the head segment's deq_idx to claim a cell, then
+ *    exchange it to taken; a cell whose producer has not arrived yet is
+ *    poisoned, and that producer claims another
+ * 3) an index past the end means the segment is used up: producers link a
+ *    new segment and swing tail_, consumers swing head_ and retire the old
+ *    one
+ *
+ * Every cell is claimed by one fetch_add, so producers and consumers only
+ * contend on the two indices of a segment, never on a lock. Segments are
+ * retired into an epoch_domain (push and pop run pinned) and, once no
+ * thread can still hold them, recycled through a small pool instead of
+ * going back to the heap.
+ *
+ * Blocking waits are layered on top: a consumer that finds the queue empty
+ * registers in waiters_ and sleeps on a condition variable; a producer only
+ * touches the mutex when waiters_ is non-zero. The queue's atomics are
+ * seq_cst so "push then check waiters" and "register then re-check the
+ * queue" cannot both miss each other.
+ *
+ * size() walks the segments and is only a snapshot under concurrency.
+ */
+
+template <typename T, std::size_t SegmentSize = 1024> class lock_free_queue {
+  static_assert(SegmentSize >= 2);
+
+  enum cell_state : std::uint8_t { cell_empty, cell_full, cell_taken };
+
+  struct cell {
+    std::atomic<std::uint8_t> state{cell_empty};
+    alignas(T) std::byte storage[sizeof(T)];
+
+    T *value() noexcept { return std::launder(reinterpret_cast<T *>(storage)); }
+  };
+
+  struct segment {
+    explicit segment(lock_free_queue *q) : owner(q) {}
+
+    void reset() noexcept {
+      for (cell &c : cells) {
+        c.state.store(cell_empty, std::memory_order_relaxed);
+      }
+      enq_idx.store(0, std::memory_order_relaxed);
+      deq_idx.store(0, std::memory_order_relaxed);
+      next.store(nullptr, std::memory_order_relaxed);
+    }
+
+    alignas(64) std::atomic<std::size_t> enq_idx{0};
+    alignas(64) std::atomic<std::size_t> deq_idx{0};
+    alignas(64) std::atomic<segment *> next{nullptr};
+    lock_free_queue *owner;
+    std::array<cell, SegmentSize> cells;
+  };
+
+public:
+  // Segments kept for reuse; beyond this, retired segments are freed.
+  static constexpr std::size_t max_pooled_segments = 16;
+
+  lock_free_queue() {
+    segment *first = new segment(this);
+    head_.store(first);
+    tail_.store(first);
+  }
+
+  ~lock_free_queue() {
+    shutdown();
+    // No other thread may be using the queue: drain and free directly.
+    while (try_pop()) {
+    }
+    segment *s = head_.load();
+    while (s != nullptr) {
+      delete std::exchange(s, s->next.load());
+    }
+  }
+
+  lock_free_queue(const lock_free_queue &) = delete;
+  lock_free_queue &operator=(const lock_free_queue &) = delete;
+  lock_free_queue(lock_free_queue &&) = delete;
+  lock_free_queue &operator=(lock_free_queue &&) = delete;
+
+  // ----- PRODUCER API ----
+  void push(const T &value) { emplace(value); }
+  void push(T &&value) { emplace(std::move(value)); }
+
+  template <typename... Args> void emplace(Args &&...args) {
+    if (shutdown_.load(std::memory_order_relaxed)) {
+      throw std::runtime_error("emplace() called on shutdown queue");
+    }
+    T value(std::forward<Args>(args)...);
+    enqueue(value);
+    if (waiters_.load() != 0) {
+      // Taking the mutex orders us after a waiter's final re-check.
+      { std::lock_guard<std::mutex> lock(wait_mutex_); }
+      cv_.notify_one();
+    }
+  }
+
+  // ----- CONSUMER API ----
+
+  // Non-blocking - returns false if empty
+  bool try_pop(T &out) { return dequeue(out); }
+  [[nodiscard]] std::optional<T> try_pop() {
+    std::optional<T> out;
+    dequeue(out);
+    return out;
+  }
+
+  // Blocking wait (forever) - returns false only on shutdown
+  bool wait_and_pop(T &out) {
+    return wait_until(out, std::chrono::steady_clock::time_point::max());
+  }
+  [[nodiscard]] std::optional<T> wait_and_pop() {
+    std::optional<T> out;
+    wait_until(out, std::chrono::steady_clock::time_point::max());
+    return out;
+  }
+
+  // Blocking wait with timeout - returns false on shutdown OR timeout
+  template <typename Rep, typename Period>
+  bool wait_for(T &out, std::chrono::duration<Rep, Period> timeout) {
+    return wait_until(out, deadline(timeout));
+  }
+  template <typename Rep, typename Period>
+  [[nodiscard]] std::optional<T>
+  wait_for(std::chrono::duration<Rep, Period> timeout) {
+    std::optional<T> out;
+    wait_until(out, deadline(timeout));
+    return out;
+  }
+
+  // ------ LIFECYCLE -------
+  void shutdown() {
+    {
+      std::lock_guard<std::mutex> lock(wait_mutex_);
+      shutdown_.store(true);
+    }
+    cv_.notify_all();
+  }
+  [[nodiscard]] bool is_shutdown() const { return shutdown_.load(); }
+
+  // ------- CAPACITY -------
+  [[nodiscard]] std::size_t size() const {
+    auto guard = domain_.pin();
+    std::size_t total = 0;
+    for (segment *s = head_.load(); s != nullptr; s = s->next.load()) {
+      std::size_t enq = std::min(s->enq_idx.load(), SegmentSize);
+      std::size_t deq = std::min(s->deq_idx.load(), SegmentSize);
+      total += enq > deq ? enq - deq : 0;
+    }
+    return total;
+  }
+  [[nodiscard]] bool empty() const { return size() == 0; }
+
+private:
+  // ----- SEGMENTS -----
+  segment *acquire_segment() {
+    {
+      std::lock_guard<std::mutex> lock(pool_mutex_);
+      if (!pool_.empty()) {
+        segment *s = pool_.back();
+        pool_.pop_back();
+        return s;
+      }
+    }
+    return new segment(this);
+  }
+
+  // Epoch deleter: runs once no pinned thread can reach the segment.
+  static void recycle(void *p) {
+    auto *s = static_cast<segment *>(p);
+    lock_free_queue *q = s->owner;
+    s->reset();
+    std::lock_guard<std::mutex> lock(q->pool_mutex_);
+    if (q->pool_.size() < max_pooled_segments) {
+      q->pool_.push_back(s);
+    } else {
+      delete s;
+    }
+  }
+
+  // ----- CORE -----
+  void enqueue(T &value) {
+    auto guard = domain_.pin();
+    while (true) {
+      segment *tail = tail_.load();
+      std::size_t i = tail->enq_idx.fetch_add(1);
+      if (i >= SegmentSize) {
+        advance_tail(tail);
+        continue;
+      }
+      cell &c = tail->cells[i];
+      T *slot = ::new (c.storage) T(std::move(value));
+      std::uint8_t expected = cell_empty;
+      if (c.state.compare_exchange_strong(expected, cell_full)) {
+        return;
+      }
+      // A consumer gave up on this cell; take the value back and retry.
+      value = std::move(*slot);
+      slot->~T();
+    }
+  }
+
+  void advance_tail(segment *tail) {
+    segment *next = tail->next.load();
+    if (next == nullptr) {
+      segment *fresh = acquire_segment();
+      segment *expected = nullptr;
+      if (tail->next.compare_exchange_strong(expected, fresh)) {
+        next = fresh;
+      } else {
+        // Never published, so it can go straight back.
+        recycle(fresh);
+        next = expected;
+      }
+    }
+    tail_.compare_exchange_strong(tail, next);
+  }
+
+  // Out is T& or std::optional<T>&.
+  template <typename Out> bool dequeue(Out &out) {
+    auto guard = domain_.pin();
+    while (true) {
+      segment *head = head_.load();
+      if (head->deq_idx.load() >= head->enq_idx.load() &&
+          head->next.load() == nullptr) {
+        return false;
+      }
+      std::size_t i = head->deq_idx.fetch_add(1);
+      if (i >= SegmentSize) {
+        segment *next = head->next.load();
+        if (next == nullptr) {
+          return false;
+        }
+        // tail_ may still lag on this segment; it must not be reachable
+        // from tail_ once retired.
+        segment *lagging = head;
+        tail_.compare_exchange_strong(lagging, next);
+        if (head_.compare_exchange_strong(head, next)) {
+          domain_.retire(head, &lock_free_queue::recycle);
+          domain_.collect();
+        }
+        continue;
+      }
+      cell &c = head->cells[i];
+      if (c.state.exchange(cell_taken) == cell_full) {
+        T *slot = c.value();
+        out = std::move(*slot);
+        slot->~T();
+        return true;
+      }
+    }
+  }
+
+  template <typename Out>
+  bool wait_until(Out &out, std::chrono::steady_clock::time_point until) {
+    if (dequeue(out)) {
+      return true;
+    }
+    std::unique_lock<std::mutex> lock(wait_mutex_);
+    waiters_.fetch_add(1);
+    bool got = false;
+    while (!(got = dequeue(out)) && !shutdown_.load()) {
+      if (cv_.wait_until(lock, until) == std::cv_status::timeout) {
+        got = dequeue(out);
+        break;
+      }
+    }
+    waiters_.fetch_sub(1);
+    return got;
+  }
+
+  template <typename Rep, typename Period>
+  static std::chrono::steady_clock::time_point
+  deadline(std::chrono::duration<Rep, Period> timeout) {
+    return std::chrono::steady_clock::now() +
+           std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+               timeout);
+  }
+
+  alignas(64) std::atomic<segment *> head_{nullptr};
+  alignas(64) std::atomic<segment *> tail_{nullptr};
+  alignas(64) std::atomic<std::size_t> waiters_{0};
+  std::atomic<bool> shutdown_{false};
+  std::mutex wait_mutex_;
+  std::condition_variable cv_;
+
+  // Frees the pooled segments; declared between pool_ and domain_ so it
+  // runs after the domain has recycled its last retired segments.
+  struct pool_cleanup {
+    std::vector<segment *> &pool;
+    ~pool_cleanup() {
+      for (segment *s : pool) {
+        delete s;
+      }
+    }
+  };
+
+  std::mutex pool_mutex_;
+  std::vector<segment *> pool_;
+  pool_cleanup pool_cleanup_{pool_};
+  mutable epoch_domain domain_;
+};
+
+} // namespace ds
@@ -0,0 +1,133 @@
+#include "lock_free_queue.hpp"
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+// ------ SINGLE THREAD -------
+
+TEST_CASE("values come out in FIFO order across segments", "[fifo]") {
+  ds::lock_free_queue<int, 4> q;
+  for (int i = 0; i < 50; ++i) {
+    q.push(i);
+  }
+  REQUIRE(q.size() == 50);
+  for (int i = 0; i < 50; ++i) {
+    auto v = q.try_pop();
+    REQUIRE(v.has_value());
+    REQUIRE(*v == i);
+  }
+  REQUIRE_FALSE(q.try_pop().has_value());
+  REQUIRE(q.empty());
+}
+
+TEST_CASE("non-trivial and move-only values", "[fifo]") {
+  ds::lock_free_queue<std::unique_ptr<std::string>, 2> q;
+  q.push(std::make_unique<std::string>("a"));
+  q.emplace(new std::string("b"));
+  q.push(std::make_unique<std::string>("c"));
+
+  std::unique_ptr<std::string> out;
+  REQUIRE(q.try_pop(out));
+  REQUIRE(*out == "a");
+  REQUIRE(*q.try_pop().value() == "b");
+  // "c" is left for the destructor to free.
+}
+
+TEST_CASE("segments are reused once drained", "[segments]") {
+  ds::lock_free_queue<int, 8> q;
+  int out = 0;
+  for (int round = 0; round < 1000; ++round) {
+    for (int i = 0; i < 20; ++i) {
+      q.push(i);
+    }
+    for (int i = 0; i < 20; ++i) {
+      REQUIRE(q.try_pop(out));
+      REQUIRE(out == i);
+    }
+  }
+  REQUIRE(q.empty());
+}
+
+// ------ BLOCKING -------
+
+TEST_CASE("wait_and_pop wakes on push", "[blocking]") {
+  ds::lock_free_queue<int> q;
+  std::thread producer([&] {
+    std::this_thread::sleep_for(10ms);
+    q.push(42);
+  });
+  int out = 0;
+  REQUIRE(q.wait_and_pop(out));
+  REQUIRE(out == 42);
+  producer.join();
+}
+
+TEST_CASE("wait_for times out on an empty queue", "[blocking]") {
+  ds::lock_free_queue<int> q;
+  auto start = std::chrono::steady_clock::now();
+  REQUIRE_FALSE(q.wait_for(5ms).has_value());
+  REQUIRE(std::chrono::steady_clock::now() - start >= 5ms);
+}
+
+TEST_CASE("shutdown releases waiters and rejects pushes", "[blocking]") {
+  ds::lock_free_queue<int> q;
+  q.push(1);
+  std::thread waiter([&] {
+    int out = 0;
+    REQUIRE(q.wait_and_pop(out)); // drains what is left first
+    REQUIRE_FALSE(q.wait_and_pop(out));
+  });
+  std::this_thread::sleep_for(10ms);
+  q.shutdown();
+  waiter.join();
+  REQUIRE(q.is_shutdown());
+  REQUIRE_THROWS_AS(q.push(2), std::runtime_error);
+}
+
+// ------ CONCURRENCY -------
+
+TEST_CASE("many producers and consumers lose and duplicate nothing",
+          "[mpmc]") {
+  constexpr int producers = 3;
+  constexpr int consumers = 3;
+  constexpr int per_producer = 20000;
+  ds::lock_free_queue<int, 64> q;
+  std::vector<std::atomic<int>> seen(producers * per_producer);
+  std::atomic<int> popped{0};
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; ++p) {
+    threads.emplace_back([&, p] {
+      for (int i = 0; i < per_producer; ++i) {
+        q.push(p * per_producer + i);
+      }
+    });
+  }
+  for (int c = 0; c < consumers; ++c) {
+    threads.emplace_back([&] {
+      int out = 0;
+      while (popped.load() < producers * per_producer) {
+        if (q.wait_for(out, 1ms)) {
+          seen[static_cast<std::size_t>(out)].fetch_add(1);
+          popped.fetch_add(1);
+        }
+      }
+    });
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+  for (auto &s : seen) {
+    REQUIRE(s.load() == 1);
+  }
+  REQUIRE(q.empty());
+}
@@ -0,0 +1,41 @@
+#include "benchmark.hpp"
+#include "make_unique.hpp"
+#include <memory>
+
+namespace {
+
+struct order {
+  long price;
+  long quantity;
+  std::size_t id;
+};
+
+} // namespace
+
+int main(int argc, char **argv) {
+  ds::bench::runner runner(argc, argv, "make_unique");
+
+  runner.add("create_destroy/std_make_unique", [](ds::bench::state &st) {
+    for (std::size_t i = 0; i < st.iterations(); ++i) {
+      auto p = std::make_unique<order>(1, 2, i);
+      ds::bench::do_not_optimize(p.get());
+    }
+  });
+
+  runner.add("create_destroy/pool_make_unique", [](ds::bench::state &st) {
+    for (std::size_t i = 0; i < st.iterations(); ++i) {
+      auto p = ds::pool_make_unique<order>(1, 2, i);
+      ds::bench::do_not_optimize(p.get());
+    }
+  });
+
+  runner.add("create_destroy/allocate_unique", [](ds::bench::state &st) {
+    std::allocator<order> alloc;
+    for (std::size_t i = 0; i < st.iterations(); ++i) {
+      auto p = ds::allocate_unique<order>(alloc, 1, 2, i);
+      ds::bench::do_not_optimize(p.get());
+    }
+  });
+
+  return runner.run();
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <sys/mman.h>
+
+namespace ds {
+
+/*
+ * Huge-page backed mappings for large scratch buffers.
+ *
+ * A multi-MB buffer on 4 KiB pages needs one TLB entry per 4 KiB; on 2 MiB
+ * pages a single entry covers 512x as much, so streaming over the buffer
+ * stops missing in the TLB.
+ *
+ * 1) try an explicit MAP_HUGETLB mapping (needs reserved hugetlbfs pages)
+ * 2) otherwise map normally and ask for transparent huge pages via madvise
+ * 3) on platforms with neither, this degrades to a plain anonymous mapping
+ *
+ * The mapping length is rounded up to a whole number of huge pages.
+ */
+
+inline constexpr std::size_t huge_page_size = std::size_t{2} << 20;
+
+struct huge_mapping {
+  void *address{nullptr};
+  std::size_t length{0};
+  bool explicit_huge_pages{false};
+};
+
+[[nodiscard]] inline huge_mapping map_huge_pages(std::size_t bytes) {
+  std::size_t length =
+      (bytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+  if (length == 0) {
+    length = huge_page_size;
+  }
+
+#ifdef MAP_HUGETLB
+  void *address = ::mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (address != MAP_FAILED) {
+    return {address, length, true};
+  }
+#endif
+
+  void *fallback = ::mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (fallback == MAP_FAILED) {
+    throw std::bad_alloc();
+  }
+#ifdef MADV_HUGEPAGE
+  ::madvise(fallback, length, MADV_HUGEPAGE);
+#endif
+  return {fallback, length, false};
+}
+
+inline void unmap_huge_pages(const huge_mapping &mapping) noexcept {
+  if (mapping.address != nullptr) {
+    ::munmap(mapping.address, mapping.length);
+  }
+}
+
+} // namespace ds
@@ -1,4 +1,13 @@
+#pragma once
+
+#include "huge_pages.hpp"
+#include "object_pool.hpp"
+#include "unique_ptr.hpp"
+
+#include <cstddef>
 #include <memory>
+#include <new>
+#include <type_traits>
 #include <utility>
 
 namespace ds {
@@ -8,4 +17,108 @@ std::unique_ptr<T> make_unique(Args &&...args) {
   return std::unique_ptr<T>(new T(std::forward<Args>(args)...));
 }
 
+// ----- FOR OVERWRITE -----
+// Default-initialize instead of value-initialize: trivial types (and T[]
+// buffers of them) are left uninitialized rather than zeroed, for storage that
+// is about to be filled from I/O anyway.
+
+template <typename T>
+  requires(!std::is_array_v<T>)
+std::unique_ptr<T> make_unique_for_overwrite() {
+  return std::unique_ptr<T>(new T);
+}
+
+template <typename T>
+  requires std::is_unbounded_array_v<T>
+std::unique_ptr<T> make_unique_for_overwrite(std::size_t n) {
+  return std::unique_ptr<T>(new std::remove_extent_t<T>[n]);
+}
+
+// Huge-page backed T[] buffer; see huge_pages.hpp for the fallback order.
+template <typename T> struct huge_page_delete {
+  void operator()(T *pointer) const noexcept {
+    std::destroy_n(pointer, count);
+    unmap_huge_pages(mapping);
+  }
+
+  huge_mapping mapping{};
+  std::size_t count{0};
+};
+
+template <typename T>
+  requires std::is_unbounded_array_v<T>
+std::unique_ptr<T, huge_page_delete<std::remove_extent_t<T>>>
+make_unique_huge_for_overwrite(std::size_t n) {
+  using element = std::remove_extent_t<T>;
+  if (n > static_cast<std::size_t>(-1) / sizeof(element)) {
+    throw std::bad_array_new_length();
+  }
+  huge_mapping mapping = map_huge_pages(n * sizeof(element));
+  auto *pointer = static_cast<element *>(mapping.address);
+  try {
+    std::uninitialized_default_construct_n(pointer, n);
+  } catch (...) {
+    unmap_huge_pages(mapping);
+    throw;
+  }
+  return std::unique_ptr<T, huge_page_delete<element>>(
+      pointer, huge_page_delete<element>{mapping, n});
+}
+
+// ----- ALLOCATOR AWARE -----
+
+// Deleter that destroys the object and hands its storage back to a copy of
+// the allocator that produced it.
+template <typename T, typename Alloc> struct allocator_delete {
+  using allocator_type =
+      typename std::allocator_traits<Alloc>::template rebind_alloc<T>;
+  using traits = std::allocator_traits<allocator_type>;
+
+  allocator_delete() = default;
+  explicit allocator_delete(const allocator_type &a) : alloc(a) {}
+
+  void operator()(T *pointer) {
+    traits::destroy(alloc, pointer);
+    traits::deallocate(alloc, pointer, 1);
+  }
+
+  [[no_unique_address]] allocator_type alloc{};
+};
+
+template <typename T, typename Alloc, typename... Args>
+ds::unique_ptr<T, allocator_delete<T, Alloc>> allocate_unique(const Alloc &alloc,
+                                                              Args &&...args) {
+  using deleter = allocator_delete<T, Alloc>;
+  typename deleter::allocator_type a(alloc);
+  T *pointer = deleter::traits::allocate(a, 1);
+  try {
+    deleter::traits::construct(a, pointer, std::forward<Args>(args)...);
+  } catch (...) {
+    deleter::traits::deallocate(a, pointer, 1);
+    throw;
+  }
+  return ds::unique_ptr<T, deleter>(pointer, deleter(a));
+}
+
+// ----- POOLED -----
+
+template <typename T> struct pool_delete {
+  void operator()(T *pointer) const {
+    pointer->~T();
+    object_pool<T>::deallocate(pointer);
+  }
+};
+
+template <typename T, typename... Args>
+ds::unique_ptr<T, pool_delete<T>> pool_make_unique(Args &&...args) {
+  void *storage = object_pool<T>::allocate();
+  try {
+    return ds::unique_ptr<T, pool_delete<T>>(
+        ::new (storage) T(std::forward<Args>(args)...));
+  } catch (...) {
+    object_pool<T>::deallocate(storage);
+    throw;
+  }
+}
+
 } // namespace ds
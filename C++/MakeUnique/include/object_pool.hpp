@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace ds {
+
+/*
+ * object_pool<T>
+ * A per-type, fixed-size object pool with a thread-local cache in front of a
+ * shared free list.
+ *
+ *   thread A cache --\                       /-- chunk 0 [slot|slot|...]
+ *   thread B cache ----> shared free list --+--- chunk 1 [slot|slot|...]
+ *   thread C cache --/       (mutex)         \-- ...
+ *
+ * 1) allocate() pops from the calling thread's cache - no lock, no malloc
+ * 2) an empty cache refills `batch_size` slots from the shared list at once
+ * 3) an empty shared list carves a fresh chunk of `chunk_size` slots
+ * 4) deallocate() pushes onto the calling thread's cache, and hands a batch
+ *    back to the shared list once the cache holds more than 2 * batch_size
+ *
+ * Free slots are linked intrusively through their own storage, so the pool
+ * has no per-object bookkeeping. Chunks are never returned to the OS.
+ */
+
+template <typename T> class object_pool {
+public:
+  static constexpr std::size_t chunk_size = 256;
+  static constexpr std::size_t batch_size = 32;
+
+  // Raw storage for one T; the caller constructs/destroys the object.
+  [[nodiscard]] static void *allocate() {
+    local_cache &cache = cache_();
+    if (cache.head == nullptr) {
+      refill(cache);
+    }
+    slot *s = cache.head;
+    cache.head = s->next;
+    --cache.count;
+    return s;
+  }
+
+  static void deallocate(void *p) noexcept {
+    local_cache &cache = cache_();
+    auto *s = static_cast<slot *>(p);
+    s->next = cache.head;
+    cache.head = s;
+    if (++cache.count > 2 * batch_size) {
+      drain(cache, batch_size);
+    }
+  }
+
+private:
+  union slot {
+    slot *next;
+    alignas(T) std::byte storage[sizeof(T)];
+  };
+
+  struct shared_state {
+    std::mutex mutex;
+    slot *head{nullptr};
+    std::vector<std::unique_ptr<slot[]>> chunks;
+  };
+
+  struct local_cache {
+    slot *head{nullptr};
+    std::size_t count{0};
+    ~local_cache() { drain(*this, count); }
+  };
+
+  // Intentionally leaked: objects may outlive static destruction order, and
+  // thread caches flush into it on thread exit.
+  static shared_state &shared_() {
+    static shared_state *state = new shared_state;
+    return *state;
+  }
+
+  static local_cache &cache_() {
+    thread_local local_cache cache;
+    return cache;
+  }
+
+  static void refill(local_cache &cache) {
+    shared_state &shared = shared_();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    if (shared.head == nullptr) {
+      auto chunk = std::make_unique_for_overwrite<slot[]>(chunk_size);
+      for (std::size_t i = 0; i < chunk_size; ++i) {
+        chunk[i].next = shared.head;
+        shared.head = &chunk[i];
+      }
+      shared.chunks.push_back(std::move(chunk));
+    }
+    for (std::size_t i = 0; i < batch_size && shared.head != nullptr; ++i) {
+      slot *s = shared.head;
+      shared.head = s->next;
+      s->next = cache.head;
+      cache.head = s;
+      ++cache.count;
+    }
+  }
+
+  static void drain(local_cache &cache, std::size_t n) noexcept {
+    if (n == 0) {
+      return;
+    }
+    // Detach the first n slots locally, then splice them under the lock.
+    slot *first = cache.head;
+    slot *last = first;
+    for (std::size_t i = 1; i < n; ++i) {
+      last = last->next;
+    }
+    cache.head = last->next;
+    cache.count -= n;
+
+    shared_state &shared = shared_();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    last->next = shared.head;
+    shared.head = first;
+  }
+};
+
+} // namespace ds
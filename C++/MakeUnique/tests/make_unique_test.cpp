@@ -1,2 +1,197 @@
 #include <catch2/catch_test_macros.hpp>
 #include "make_unique.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct alloc_stats {
+  std::size_t allocations{0};
+  std::size_t deallocations{0};
+};
+
+template <typename T> struct counting_allocator {
+  using value_type = T;
+
+  explicit counting_allocator(alloc_stats *s) : stats(s) {}
+  template <typename U>
+  counting_allocator(const counting_allocator<U> &other) : stats(other.stats) {}
+
+  T *allocate(std::size_t n) {
+    ++stats->allocations;
+    return std::allocator<T>{}.allocate(n);
+  }
+  void deallocate(T *p, std::size_t n) {
+    ++stats->deallocations;
+    std::allocator<T>{}.deallocate(p, n);
+  }
+
+  alloc_stats *stats;
+};
+
+struct tracked {
+  explicit tracked(int v, int *live) : value(v), live_count(live) {
+    ++*live_count;
+  }
+  ~tracked() { --*live_count; }
+  int value;
+  int *live_count;
+};
+
+struct throws_on_construct {
+  throws_on_construct() { throw std::runtime_error("boom"); }
+};
+
+struct counted {
+  counted() { ++constructed; }
+  ~counted() { ++destroyed; }
+  static inline int constructed = 0;
+  static inline int destroyed = 0;
+};
+
+} // namespace
+
+// ------ FOR OVERWRITE -------
+
+TEST_CASE("make_unique_for_overwrite single object", "[overwrite]") {
+  struct header {
+    std::uint32_t length;
+    std::uint32_t checksum;
+  };
+  auto h = ds::make_unique_for_overwrite<header>();
+  h->length = 16;
+  h->checksum = 0xbeef;
+  REQUIRE(h->length == 16);
+  REQUIRE(h->checksum == 0xbeef);
+}
+
+TEST_CASE("make_unique_for_overwrite array", "[overwrite]") {
+  auto buffer = ds::make_unique_for_overwrite<std::uint8_t[]>(4096);
+  for (std::size_t i = 0; i < 4096; ++i) {
+    buffer[i] = static_cast<std::uint8_t>(i);
+  }
+  REQUIRE(buffer[0] == 0);
+  REQUIRE(buffer[4095] == static_cast<std::uint8_t>(4095));
+}
+
+TEST_CASE("make_unique_huge_for_overwrite maps whole huge pages",
+          "[overwrite][huge]") {
+  constexpr std::size_t count = (3 << 20) / sizeof(std::uint64_t);
+  auto buffer = ds::make_unique_huge_for_overwrite<std::uint64_t[]>(count);
+  REQUIRE(buffer);
+  REQUIRE(buffer.get_deleter().count == count);
+  REQUIRE(buffer.get_deleter().mapping.length % ds::huge_page_size == 0);
+  REQUIRE(buffer.get_deleter().mapping.length >= count * sizeof(std::uint64_t));
+
+  for (std::size_t i = 0; i < count; ++i) {
+    buffer[i] = i;
+  }
+  REQUIRE(buffer[count - 1] == count - 1);
+}
+
+TEST_CASE("make_unique_huge_for_overwrite constructs non-trivial elements",
+          "[overwrite][huge]") {
+  {
+    auto buffer = ds::make_unique_huge_for_overwrite<counted[]>(10);
+    REQUIRE(counted::constructed == 10);
+  }
+  REQUIRE(counted::destroyed == 10);
+}
+
+// ------ ALLOCATE_UNIQUE -------
+
+TEST_CASE("allocate_unique returns memory to its allocator", "[allocate_unique]") {
+  alloc_stats stats;
+  int live = 0;
+  {
+    auto p = ds::allocate_unique<tracked>(counting_allocator<int>(&stats), 7,
+                                          &live);
+    REQUIRE(p);
+    REQUIRE(p->value == 7);
+    REQUIRE(live == 1);
+    REQUIRE(stats.allocations == 1);
+    REQUIRE(stats.deallocations == 0);
+  }
+  REQUIRE(live == 0);
+  REQUIRE(stats.deallocations == 1);
+}
+
+TEST_CASE("allocate_unique ownership follows moves", "[allocate_unique]") {
+  alloc_stats stats;
+  int live = 0;
+  auto a = ds::allocate_unique<tracked>(counting_allocator<tracked>(&stats), 1,
+                                        &live);
+  auto b = std::move(a);
+  REQUIRE_FALSE(a);
+  REQUIRE(b->value == 1);
+  b.reset();
+  REQUIRE(live == 0);
+  REQUIRE(stats.deallocations == 1);
+}
+
+TEST_CASE("allocate_unique deallocates when the constructor throws",
+          "[allocate_unique]") {
+  alloc_stats stats;
+  REQUIRE_THROWS_AS(ds::allocate_unique<throws_on_construct>(
+                        counting_allocator<int>(&stats)),
+                    std::runtime_error);
+  REQUIRE(stats.allocations == 1);
+  REQUIRE(stats.deallocations == 1);
+}
+
+// ------ POOL_MAKE_UNIQUE -------
+
+TEST_CASE("pool_make_unique constructs and destroys", "[pool]") {
+  int live = 0;
+  {
+    auto p = ds::pool_make_unique<tracked>(42, &live);
+    REQUIRE(p->value == 42);
+    REQUIRE(live == 1);
+  }
+  REQUIRE(live == 0);
+}
+
+TEST_CASE("pool_make_unique reuses freed slots", "[pool]") {
+  struct payload {
+    long a, b, c;
+  };
+  void *first = nullptr;
+  {
+    auto p = ds::pool_make_unique<payload>();
+    first = p.get();
+  }
+  auto q = ds::pool_make_unique<payload>();
+  REQUIRE(q.get() == first);
+}
+
+TEST_CASE("pool_make_unique hands out distinct slots", "[pool]") {
+  std::vector<ds::unique_ptr<int, ds::pool_delete<int>>> live;
+  std::set<int *> addresses;
+  for (int i = 0; i < 1000; ++i) {
+    live.push_back(ds::pool_make_unique<int>(i));
+    addresses.insert(live.back().get());
+  }
+  REQUIRE(addresses.size() == 1000);
+  for (int i = 0; i < 1000; ++i) {
+    REQUIRE(*live[static_cast<std::size_t>(i)] == i);
+  }
+}
+
+TEST_CASE("pool objects may be freed on another thread", "[pool][threads]") {
+  std::vector<ds::unique_ptr<int, ds::pool_delete<int>>> batch;
+  for (int i = 0; i < 500; ++i) {
+    batch.push_back(ds::pool_make_unique<int>(i));
+  }
+  std::thread consumer([&] { batch.clear(); });
+  consumer.join();
+  REQUIRE(batch.empty());
+
+  auto p = ds::pool_make_unique<int>(1);
+  REQUIRE(*p == 1);
+}
@@ -0,0 +1,46 @@
+#include "benchmark.hpp"
+#include "memory_resources.hpp"
+#include <memory_resource>
+
+namespace {
+
+// Allocate and free one 48-byte block per iteration.
+void churn(ds::bench::state &st, std::pmr::memory_resource &resource) {
+  for (std::size_t i = 0; i < st.iterations(); ++i) {
+    void *p = resource.allocate(48, 8);
+    ds::bench::do_not_optimize(p);
+    resource.deallocate(p, 48, 8);
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  ds::bench::runner runner(argc, argv, "memory");
+
+  runner.add("alloc_free/new_delete", [](ds::bench::state &st) {
+    churn(st, *std::pmr::new_delete_resource());
+  });
+
+  runner.add("alloc_free/pool_resource", [](ds::bench::state &st) {
+    ds::memory::pool_resource pool;
+    churn(st, pool);
+  });
+
+  runner.add("alloc_free/slab_resource", [](ds::bench::state &st) {
+    ds::memory::slab_resource slab(48);
+    churn(st, slab);
+  });
+
+  runner.add("alloc/monotonic_arena", [](ds::bench::state &st) {
+    ds::memory::monotonic_arena arena;
+    churn(st, arena);
+  });
+
+  runner.add("alloc_free/std_unsynchronized_pool", [](ds::bench::state &st) {
+    std::pmr::unsynchronized_pool_resource pool;
+    churn(st, pool);
+  });
+
+  return runner.run();
+}
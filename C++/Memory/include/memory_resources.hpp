@@ -0,0 +1,16 @@
+#pragma once
+
+// ds::memory - allocation building blocks shared across the library.
+//
+//   monotonic_arena     bump allocation, freed all at once
+//   pool_resource       thread-safe size classes with per-thread caches
+//   slab_resource       single-size blocks, single-threaded
+//   resource_allocator  typed allocator bound to a concrete resource
+//
+// All resources derive from std::pmr::memory_resource, so they plug into
+// std::pmr containers as well as anything taking an Allocator parameter.
+
+#include "monotonic_arena.hpp"
+#include "pool_resource.hpp"
+#include "resource_allocator.hpp"
+#include "slab_resource.hpp"
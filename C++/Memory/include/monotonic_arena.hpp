@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <new>
+
+namespace ds::memory {
+
+/*
+ * monotonic_arena
+ * Bump-pointer allocation out of geometrically growing chunks.
+ *
+ *   [hdr|used......|free     ]   [hdr|used...........|free            ]
+ *                   ^ current_                        grows x2 per chunk
+ *
+ * 1) allocate = align the cursor and bump it; only a chunk refill touches the
+ *    upstream resource
+ * 2) deallocate is a no-op
+ * 3) release() (or the destructor) hands every chunk back at once
+ *
+ * Suited to per-request or per-batch scratch where everything dies together.
+ * Not thread-safe.
+ */
+
+class monotonic_arena final : public std::pmr::memory_resource {
+public:
+  explicit monotonic_arena(
+      std::size_t initial_size = 4096,
+      std::pmr::memory_resource *upstream = std::pmr::new_delete_resource())
+      : upstream_(upstream),
+        next_chunk_size_(
+            std::max<std::size_t>(initial_size, alignof(std::max_align_t))) {}
+
+  // Start from caller-owned storage (e.g. a stack buffer) before going
+  // upstream. The buffer is reused after release().
+  monotonic_arena(
+      void *buffer, std::size_t size,
+      std::pmr::memory_resource *upstream = std::pmr::new_delete_resource())
+      : upstream_(upstream), initial_buffer_(buffer), initial_size_(size),
+        current_(buffer), remaining_(size),
+        next_chunk_size_(size == 0 ? 4096 : size * 2) {}
+
+  ~monotonic_arena() override { release(); }
+
+  monotonic_arena(const monotonic_arena &) = delete;
+  monotonic_arena &operator=(const monotonic_arena &) = delete;
+
+  void release() noexcept {
+    while (chunks_ != nullptr) {
+      chunk_header *prev = chunks_->prev;
+      upstream_->deallocate(chunks_, chunks_->size, alignof(std::max_align_t));
+      chunks_ = prev;
+    }
+    current_ = initial_buffer_;
+    remaining_ = initial_size_;
+    bytes_allocated_ = 0;
+  }
+
+  // Bytes handed out since construction or the last release().
+  [[nodiscard]] std::size_t bytes_allocated() const noexcept {
+    return bytes_allocated_;
+  }
+
+  [[nodiscard]] std::pmr::memory_resource *upstream() const noexcept {
+    return upstream_;
+  }
+
+protected:
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+    void *p = current_;
+    std::size_t space = remaining_;
+    if (p == nullptr || std::align(alignment, bytes, p, space) == nullptr) {
+      // No chunk can hold it, and bytes + alignment would wrap.
+      if (bytes > max_payload - alignment) {
+        throw std::bad_alloc();
+      }
+      grow(bytes + alignment);
+      p = current_;
+      space = remaining_;
+      std::align(alignment, bytes, p, space);
+    }
+    current_ = static_cast<std::byte *>(p) + bytes;
+    remaining_ = space - bytes;
+    bytes_allocated_ += bytes;
+    return p;
+  }
+
+  void do_deallocate(void *, std::size_t, std::size_t) override {}
+
+  bool do_is_equal(
+      const std::pmr::memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+
+private:
+  struct alignas(std::max_align_t) chunk_header {
+    chunk_header *prev;
+    std::size_t size;
+  };
+
+  void grow(std::size_t min_bytes) {
+    // A request bigger than the next chunk gets a chunk of its own size;
+    // the doubling saturates rather than wrapping to zero.
+    std::size_t payload = std::max(next_chunk_size_, min_bytes);
+    std::size_t total = sizeof(chunk_header) + payload;
+    auto *chunk = static_cast<chunk_header *>(
+        upstream_->allocate(total, alignof(std::max_align_t)));
+    chunk->prev = chunks_;
+    chunk->size = total;
+    chunks_ = chunk;
+
+    current_ = chunk + 1;
+    remaining_ = payload;
+    next_chunk_size_ = payload <= max_payload / 2 ? payload * 2 : max_payload;
+  }
+
+  static constexpr std::size_t max_payload =
+      std::numeric_limits<std::size_t>::max() - sizeof(chunk_header);
+
+  std::pmr::memory_resource *upstream_;
+  void *initial_buffer_{nullptr};
+  std::size_t initial_size_{0};
+  void *current_{nullptr};
+  std::size_t remaining_{0};
+  std::size_t next_chunk_size_;
+  std::size_t bytes_allocated_{0};
+  chunk_header *chunks_{nullptr};
+};
+
+} // namespace ds::memory
@@ -0,0 +1,233 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+namespace ds::memory {
+
+/*
+ * pool_resource
+ * Thread-safe size-class pools with a per-thread cache in front.
+ *
+ *   request -> size class (8, 16, 32, ... 4096 bytes)
+ *           -> this thread's free list for that class    (no lock)
+ *           -> refill `batch_size` blocks from the class  (one lock)
+ *           -> carve a new `chunk_size` chunk from upstream
+ *
+ * 1) requests above max_block or with alignment above 64 go straight upstream
+ * 2) freed blocks go onto the freeing thread's list; a list that grows past
+ *    2 * batch_size hands a batch back to the shared class list
+ * 3) a thread's lists are returned to the shared lists when the thread exits
+ *
+ * Chunks are only returned upstream when the resource is destroyed.
+ */
+
+class pool_resource final : public std::pmr::memory_resource {
+public:
+  static constexpr std::size_t min_block = 8;
+  static constexpr std::size_t max_block = 4096;
+  static constexpr std::size_t max_alignment = 64;
+  static constexpr std::size_t num_classes = 10; // 8 .. 4096
+  static constexpr std::size_t chunk_size = std::size_t{64} << 10;
+  static constexpr std::size_t batch_size = 32;
+
+  explicit pool_resource(
+      std::pmr::memory_resource *upstream = std::pmr::new_delete_resource())
+      : state_(std::make_shared<shared_state>()), upstream_(upstream) {}
+
+  // No thread may be allocating from the resource while it is destroyed.
+  ~pool_resource() override {
+    // Flip `alive` before taking the class locks, so an exiting thread either
+    // finishes its flush first or sees the flag and drops its cache.
+    state_->alive.store(false);
+    for (auto &cls : state_->classes) {
+      std::lock_guard<std::mutex> lock(cls.mutex);
+      cls.head = nullptr;
+    }
+    for (void *chunk : state_->chunks) {
+      upstream_->deallocate(chunk, chunk_size, max_alignment);
+    }
+  }
+
+  pool_resource(const pool_resource &) = delete;
+  pool_resource &operator=(const pool_resource &) = delete;
+
+  [[nodiscard]] std::pmr::memory_resource *upstream() const noexcept {
+    return upstream_;
+  }
+
+protected:
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+    std::size_t cls = class_of(bytes, alignment);
+    if (cls == num_classes) {
+      return upstream_->allocate(bytes, alignment);
+    }
+    local_lists &lists = local();
+    if (lists.head[cls] == nullptr) {
+      refill(lists, cls);
+    }
+    free_block *block = lists.head[cls];
+    lists.head[cls] = block->next;
+    --lists.count[cls];
+    return block;
+  }
+
+  void do_deallocate(void *p, std::size_t bytes,
+                     std::size_t alignment) override {
+    std::size_t cls = class_of(bytes, alignment);
+    if (cls == num_classes) {
+      upstream_->deallocate(p, bytes, alignment);
+      return;
+    }
+    local_lists &lists = local();
+    auto *block = static_cast<free_block *>(p);
+    block->next = lists.head[cls];
+    lists.head[cls] = block;
+    if (++lists.count[cls] > 2 * batch_size) {
+      flush(*state_, lists, cls, batch_size);
+    }
+  }
+
+  bool do_is_equal(
+      const std::pmr::memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+
+private:
+  struct free_block {
+    free_block *next;
+  };
+
+  struct size_class {
+    std::mutex mutex;
+    free_block *head{nullptr};
+  };
+
+  struct shared_state {
+    std::atomic<bool> alive{true};
+    std::array<size_class, num_classes> classes;
+    std::mutex chunk_mutex;
+    std::vector<void *> chunks;
+  };
+
+  struct local_lists {
+    std::array<free_block *, num_classes> head{};
+    std::array<std::size_t, num_classes> count{};
+  };
+
+  // Same shape as epoch_domain's thread registration: the cache keeps the
+  // shared state alive so a thread that outlives the resource can still look
+  // at the `alive` flag on exit.
+  struct thread_cache {
+    struct entry {
+      std::shared_ptr<shared_state> owner;
+      std::unique_ptr<local_lists> lists;
+    };
+    std::vector<entry> entries;
+
+    ~thread_cache() {
+      for (auto &e : entries) {
+        flush_all(*e.owner, *e.lists);
+      }
+    }
+  };
+
+  static std::size_t class_of(std::size_t bytes, std::size_t alignment) {
+    std::size_t size = bytes < alignment ? alignment : bytes;
+    if (size > max_block || alignment > max_alignment) {
+      return num_classes;
+    }
+    size = size < min_block ? min_block : size;
+    return static_cast<std::size_t>(std::bit_width(size - 1)) - 3;
+  }
+
+  static constexpr std::size_t block_bytes(std::size_t cls) {
+    return min_block << cls;
+  }
+
+  local_lists &local() {
+    thread_local thread_cache cache;
+    for (auto &e : cache.entries) {
+      if (e.owner == state_) {
+        return *e.lists;
+      }
+    }
+    std::erase_if(cache.entries,
+                  [](const thread_cache::entry &e) { return !e.owner->alive; });
+    cache.entries.push_back({state_, std::make_unique<local_lists>()});
+    return *cache.entries.back().lists;
+  }
+
+  void refill(local_lists &lists, std::size_t cls) {
+    size_class &shared = state_->classes[cls];
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    if (shared.head == nullptr) {
+      carve_chunk(shared, cls);
+    }
+    take_batch(shared, lists, cls);
+  }
+
+  static void take_batch(size_class &shared, local_lists &lists,
+                         std::size_t cls) {
+    for (std::size_t i = 0; i < batch_size && shared.head != nullptr; ++i) {
+      free_block *block = shared.head;
+      shared.head = block->next;
+      block->next = lists.head[cls];
+      lists.head[cls] = block;
+      ++lists.count[cls];
+    }
+  }
+
+  // Caller holds the class lock.
+  void carve_chunk(size_class &shared, std::size_t cls) {
+    void *chunk = upstream_->allocate(chunk_size, max_alignment);
+    {
+      std::lock_guard<std::mutex> lock(state_->chunk_mutex);
+      state_->chunks.push_back(chunk);
+    }
+    auto *bytes = static_cast<std::byte *>(chunk);
+    std::size_t size = block_bytes(cls);
+    for (std::size_t offset = chunk_size; offset >= size; offset -= size) {
+      void *raw = bytes + offset - size;
+      auto *block = static_cast<free_block *>(raw);
+      block->next = shared.head;
+      shared.head = block;
+    }
+  }
+
+  static void flush(shared_state &state, local_lists &lists, std::size_t cls,
+                    std::size_t n) {
+    if (n == 0) {
+      return;
+    }
+    size_class &shared = state.classes[cls];
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    if (!state.alive.load()) {
+      return;
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+      free_block *block = lists.head[cls];
+      lists.head[cls] = block->next;
+      block->next = shared.head;
+      shared.head = block;
+    }
+    lists.count[cls] -= n;
+  }
+
+  static void flush_all(shared_state &state, local_lists &lists) {
+    for (std::size_t cls = 0; cls < num_classes; ++cls) {
+      flush(state, lists, cls, lists.count[cls]);
+    }
+  }
+
+  std::shared_ptr<shared_state> state_;
+  std::pmr::memory_resource *upstream_;
+};
+
+} // namespace ds::memory
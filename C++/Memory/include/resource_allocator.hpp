@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace ds::memory {
+
+/*
+ * resource_allocator<T, Resource>
+ * A standard allocator over a specific memory resource type.
+ *
+ * std::pmr::polymorphic_allocator always dispatches through the virtual
+ * memory_resource interface. Naming the concrete (final) resource type lets
+ * the compiler call its allocate/deallocate directly, and the allocator is
+ * still just one pointer wide.
+ */
+
+template <typename T, typename Resource = std::pmr::memory_resource>
+class resource_allocator {
+public:
+  using value_type = T;
+
+  explicit resource_allocator(Resource *resource) noexcept
+      : resource_(resource) {}
+
+  template <typename U>
+  resource_allocator(const resource_allocator<U, Resource> &other) noexcept
+      : resource_(other.resource()) {}
+
+  [[nodiscard]] T *allocate(std::size_t n) {
+    return static_cast<T *>(resource_->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T *p, std::size_t n) noexcept {
+    resource_->deallocate(p, n * sizeof(T), alignof(T));
+  }
+
+  [[nodiscard]] Resource *resource() const noexcept { return resource_; }
+
+  template <typename U>
+  friend bool operator==(const resource_allocator &a,
+                         const resource_allocator<U, Resource> &b) noexcept {
+    return a.resource() == b.resource();
+  }
+
+private:
+  Resource *resource_;
+};
+
+} // namespace ds::memory
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+
+namespace ds::memory {
+
+/*
+ * slab_resource
+ * Fixed-size blocks carved from slabs of `blocks_per_slab` blocks.
+ *
+ *   slab: [blk|blk|blk|blk|...]  free list threads through the free blocks
+ *
+ * Every request must fit in one block (node-based containers, order and task
+ * objects). allocate/deallocate are a pop/push on an intrusive free list, so
+ * the only upstream traffic is one call per slab. Slabs are returned when the
+ * resource is destroyed. Not thread-safe.
+ *
+ * Blocks are rounded up to alignof(std::max_align_t), which is also the
+ * largest alignment served.
+ */
+
+class slab_resource final : public std::pmr::memory_resource {
+public:
+  explicit slab_resource(
+      std::size_t block_size, std::size_t blocks_per_slab = 256,
+      std::pmr::memory_resource *upstream = std::pmr::new_delete_resource())
+      : upstream_(upstream), block_size_(round_up(block_size)),
+        blocks_per_slab_(blocks_per_slab == 0 ? 1 : blocks_per_slab) {}
+
+  ~slab_resource() override {
+    while (slabs_ != nullptr) {
+      slab_header *prev = slabs_->prev;
+      upstream_->deallocate(slabs_, slab_bytes(), alignof(std::max_align_t));
+      slabs_ = prev;
+    }
+  }
+
+  slab_resource(const slab_resource &) = delete;
+  slab_resource &operator=(const slab_resource &) = delete;
+
+  [[nodiscard]] std::size_t block_size() const noexcept { return block_size_; }
+  [[nodiscard]] std::size_t blocks_in_use() const noexcept { return in_use_; }
+
+protected:
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+    if (bytes > block_size_ || alignment > alignof(std::max_align_t)) {
+      throw std::bad_alloc();
+    }
+    if (free_ == nullptr) {
+      add_slab();
+    }
+    free_block *block = free_;
+    free_ = block->next;
+    ++in_use_;
+    return block;
+  }
+
+  void do_deallocate(void *p, std::size_t, std::size_t) override {
+    auto *block = static_cast<free_block *>(p);
+    block->next = free_;
+    free_ = block;
+    --in_use_;
+  }
+
+  bool do_is_equal(
+      const std::pmr::memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+
+private:
+  struct free_block {
+    free_block *next;
+  };
+
+  struct alignas(std::max_align_t) slab_header {
+    slab_header *prev;
+  };
+
+  static std::size_t round_up(std::size_t n) {
+    constexpr std::size_t a = alignof(std::max_align_t);
+    n = n < sizeof(free_block) ? sizeof(free_block) : n;
+    return (n + a - 1) / a * a;
+  }
+
+  std::size_t slab_bytes() const noexcept {
+    return sizeof(slab_header) + block_size_ * blocks_per_slab_;
+  }
+
+  void add_slab() {
+    auto *slab = static_cast<slab_header *>(
+        upstream_->allocate(slab_bytes(), alignof(std::max_align_t)));
+    slab->prev = slabs_;
+    slabs_ = slab;
+
+    auto *first = static_cast<std::byte *>(static_cast<void *>(slab + 1));
+    // Thread back to front so blocks are handed out in address order.
+    for (std::size_t i = blocks_per_slab_; i-- > 0;) {
+      void *raw = first + i * block_size_;
+      auto *block = static_cast<free_block *>(raw);
+      block->next = free_;
+      free_ = block;
+    }
+  }
+
+  std::pmr::memory_resource *upstream_;
+  std::size_t block_size_;
+  std::size_t blocks_per_slab_;
+  free_block *free_{nullptr};
+  slab_header *slabs_{nullptr};
+  std::size_t in_use_{0};
+};
+
+} // namespace ds::memory
@@ -0,0 +1,262 @@
+#include "memory_resources.hpp"
+#include "thread_safe_queue.hpp"
+#include "vector.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory_resource>
+#include <new>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Upstream that counts traffic so tests can see when a resource goes to it.
+class counting_resource final : public std::pmr::memory_resource {
+public:
+  std::size_t allocations{0};
+  std::size_t deallocations{0};
+
+private:
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+    ++allocations;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+  void do_deallocate(void *p, std::size_t bytes,
+                     std::size_t alignment) override {
+    ++deallocations;
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+  bool do_is_equal(
+      const std::pmr::memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+};
+
+bool aligned(const void *p, std::size_t alignment) {
+  return reinterpret_cast<std::uintptr_t>(p) % alignment == 0;
+}
+
+} // namespace
+
+// ------ MONOTONIC ARENA -------
+
+TEST_CASE("arena bumps within a chunk", "[arena]") {
+  counting_resource upstream;
+  {
+    ds::memory::monotonic_arena arena(1024, &upstream);
+    void *a = arena.allocate(16, 8);
+    void *b = arena.allocate(16, 8);
+    REQUIRE(static_cast<std::byte *>(b) - static_cast<std::byte *>(a) == 16);
+    REQUIRE(upstream.allocations == 1);
+    REQUIRE(arena.bytes_allocated() == 32);
+  }
+  REQUIRE(upstream.deallocations == 1);
+}
+
+TEST_CASE("arena honours alignment and grows", "[arena]") {
+  counting_resource upstream;
+  ds::memory::monotonic_arena arena(64, &upstream);
+  (void)arena.allocate(1, 1);
+  void *p = arena.allocate(8, 64);
+  REQUIRE(aligned(p, 64));
+  void *big = arena.allocate(10000, 16);
+  REQUIRE(aligned(big, 16));
+  REQUIRE(upstream.allocations >= 2);
+
+  arena.release();
+  REQUIRE(upstream.deallocations == upstream.allocations);
+  REQUIRE(arena.bytes_allocated() == 0);
+}
+
+TEST_CASE("arena copes with degenerate sizes", "[arena]") {
+  counting_resource upstream;
+  ds::memory::monotonic_arena arena(0, &upstream);
+  void *a = arena.allocate(8, 8);
+  void *b = arena.allocate(100, 8);
+  REQUIRE(a != b);
+  REQUIRE(upstream.allocations >= 1);
+
+  // Too large to ever fit: refused instead of wrapping the chunk size.
+  REQUIRE_THROWS_AS(
+      arena.allocate(std::numeric_limits<std::size_t>::max() - 8, 16),
+      std::bad_alloc);
+}
+
+TEST_CASE("arena serves from a caller buffer first", "[arena]") {
+  counting_resource upstream;
+  alignas(16) std::byte buffer[256];
+  ds::memory::monotonic_arena arena(buffer, sizeof(buffer), &upstream);
+  void *p = arena.allocate(128, 16);
+  REQUIRE(p == buffer);
+  REQUIRE(upstream.allocations == 0);
+  (void)arena.allocate(256, 16);
+  REQUIRE(upstream.allocations == 1);
+
+  arena.release();
+  REQUIRE(arena.allocate(8, 8) == buffer);
+}
+
+TEST_CASE("arena backs std::pmr containers", "[arena]") {
+  ds::memory::monotonic_arena arena;
+  std::pmr::vector<int> v(&arena);
+  for (int i = 0; i < 1000; ++i) {
+    v.push_back(i);
+  }
+  REQUIRE(v[999] == 999);
+}
+
+// ------ POOL RESOURCE -------
+
+TEST_CASE("pool reuses freed blocks of the same class", "[pool]") {
+  counting_resource upstream;
+  ds::memory::pool_resource pool(&upstream);
+  void *a = pool.allocate(24, 8);
+  pool.deallocate(a, 24, 8);
+  void *b = pool.allocate(32, 8);
+  REQUIRE(a == b);
+  pool.deallocate(b, 32, 8);
+  REQUIRE(upstream.allocations == 1);
+}
+
+TEST_CASE("pool blocks are aligned and distinct", "[pool]") {
+  ds::memory::pool_resource pool;
+  std::set<void *> seen;
+  std::vector<void *> blocks;
+  for (int i = 0; i < 5000; ++i) {
+    void *p = pool.allocate(64, 64);
+    REQUIRE(aligned(p, 64));
+    REQUIRE(seen.insert(p).second);
+    blocks.push_back(p);
+  }
+  for (void *p : blocks) {
+    pool.deallocate(p, 64, 64);
+  }
+}
+
+TEST_CASE("pool forwards oversized requests upstream", "[pool]") {
+  counting_resource upstream;
+  ds::memory::pool_resource pool(&upstream);
+  void *p = pool.allocate(ds::memory::pool_resource::max_block + 1, 8);
+  REQUIRE(upstream.allocations == 1);
+  pool.deallocate(p, ds::memory::pool_resource::max_block + 1, 8);
+  REQUIRE(upstream.deallocations == 1);
+}
+
+TEST_CASE("pool blocks may be freed by another thread", "[pool][threads]") {
+  counting_resource upstream;
+  ds::memory::pool_resource pool(&upstream);
+  std::vector<void *> blocks;
+  for (int i = 0; i < 1000; ++i) {
+    blocks.push_back(pool.allocate(16, 8));
+  }
+  std::thread other([&] {
+    for (void *p : blocks) {
+      pool.deallocate(p, 16, 8);
+    }
+  });
+  other.join();
+
+  // The exiting thread flushed its cache, so these come back without
+  // another trip upstream.
+  std::size_t before = upstream.allocations;
+  for (int i = 0; i < 1000; ++i) {
+    blocks[static_cast<std::size_t>(i)] = pool.allocate(16, 8);
+  }
+  REQUIRE(upstream.allocations == before);
+  for (void *p : blocks) {
+    pool.deallocate(p, 16, 8);
+  }
+}
+
+TEST_CASE("pool survives concurrent churn", "[pool][threads]") {
+  ds::memory::pool_resource pool;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&pool, t] {
+      std::vector<std::pair<void *, std::size_t>> live;
+      for (int i = 0; i < 20000; ++i) {
+        std::size_t size = 8u << static_cast<unsigned>((i + t) % 8);
+        void *p = pool.allocate(size, 8);
+        static_cast<std::byte *>(p)[0] = std::byte{1};
+        live.emplace_back(p, size);
+        if (live.size() > 64) {
+          pool.deallocate(live.front().first, live.front().second, 8);
+          live.erase(live.begin());
+        }
+      }
+      for (auto [p, size] : live) {
+        pool.deallocate(p, size, 8);
+      }
+    });
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+}
+
+// ------ SLAB RESOURCE -------
+
+TEST_CASE("slab hands out fixed blocks", "[slab]") {
+  counting_resource upstream;
+  {
+    ds::memory::slab_resource slab(40, 4, &upstream);
+    REQUIRE(slab.block_size() % alignof(std::max_align_t) == 0);
+
+    std::vector<void *> blocks;
+    for (int i = 0; i < 10; ++i) {
+      blocks.push_back(slab.allocate(40, 8));
+    }
+    REQUIRE(upstream.allocations == 3);
+    REQUIRE(slab.blocks_in_use() == 10);
+
+    slab.deallocate(blocks.back(), 40, 8);
+    REQUIRE(slab.allocate(8, 8) == blocks.back());
+    REQUIRE_THROWS_AS(slab.allocate(slab.block_size() + 1, 8), std::bad_alloc);
+  }
+  REQUIRE(upstream.deallocations == 3);
+}
+
+// ------ ALLOCATOR + CONTAINERS -------
+
+TEST_CASE("resource_allocator rebinds and compares by resource",
+          "[allocator]") {
+  ds::memory::pool_resource pool;
+  ds::memory::resource_allocator<int, ds::memory::pool_resource> a(&pool);
+  ds::memory::resource_allocator<double, ds::memory::pool_resource> b(a);
+  REQUIRE(a == b);
+
+  double *p = b.allocate(4);
+  p[3] = 1.5;
+  b.deallocate(p, 4);
+}
+
+TEST_CASE("ds::vector allocates through a resource", "[allocator]") {
+  counting_resource upstream;
+  ds::memory::monotonic_arena arena(4096, &upstream);
+  using alloc =
+      ds::memory::resource_allocator<int, ds::memory::monotonic_arena>;
+  {
+    ds::vector<int, alloc> v{alloc(&arena)};
+    for (int i = 0; i < 100; ++i) {
+      v.push_back(i);
+    }
+    REQUIRE(v.at(99) == 99);
+    REQUIRE(v.get_allocator().resource() == &arena);
+  }
+  REQUIRE(upstream.allocations == 1);
+}
+
+TEST_CASE("thread_safe_queue over a pooled deque", "[allocator]") {
+  ds::memory::pool_resource pool;
+  std::pmr::polymorphic_allocator<int> alloc(&pool);
+  ds::thread_safe_queue<int, std::pmr::deque<int>> q(alloc);
+  for (int i = 0; i < 1000; ++i) {
+    q.push(i);
+  }
+  REQUIRE(q.size() == 1000);
+  REQUIRE(q.try_pop() == 0);
+}
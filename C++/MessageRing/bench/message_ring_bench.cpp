@@ -0,0 +1,95 @@
+#include "benchmark.hpp"
+#include "message_ring.hpp"
+#include "thread_safe_queue.hpp"
+
+#include <array>
+#include <cstdint>
+#include <thread>
+#include <variant>
+
+namespace {
+
+// A feed-like mix: mostly small trades, some quotes, the odd large record.
+struct trade {
+  std::uint32_t symbol;
+  std::uint32_t size;
+};
+struct quote {
+  std::uint64_t symbol;
+  double bid;
+  double ask;
+};
+struct snapshot {
+  std::uint64_t symbol;
+  std::array<double, 30> levels;
+};
+
+using message = std::variant<trade, quote, snapshot>;
+
+// The variant is as large as `snapshot` whatever it holds; the ring stores
+// each record at its own size. One op is one message through the queue.
+void variant_queue(ds::bench::state &st) {
+  ds::thread_safe_queue<message> q;
+  std::uint64_t sum = 0;
+  std::thread consumer([&] {
+    message m;
+    for (std::size_t i = 0; i < st.iterations(); ++i) {
+      q.wait_and_pop(m);
+      sum += m.index();
+    }
+  });
+  for (std::size_t i = 0; i < st.iterations(); ++i) {
+    if (i % 64 == 0) {
+      q.push(snapshot{i, {}});
+    } else if (i % 4 == 0) {
+      q.push(quote{i, 1.0, 1.5});
+    } else {
+      q.push(trade{static_cast<std::uint32_t>(i), 100});
+    }
+  }
+  consumer.join();
+  ds::bench::do_not_optimize(sum);
+}
+
+void message_ring(ds::bench::state &st) {
+  ds::message_ring ring(64 * 1024);
+  std::uint64_t sum = 0;
+  std::thread consumer([&] {
+    std::size_t seen = 0;
+    while (seen < st.iterations()) {
+      std::size_t n = ring.poll(
+          [&](const ds::message_ring::record &r) { sum += r.tag; });
+      if (n == 0) {
+        std::this_thread::yield();
+      }
+      seen += n;
+    }
+  });
+  for (std::size_t i = 0; i < st.iterations(); ++i) {
+    bool pushed = false;
+    while (!pushed) {
+      if (i % 64 == 0) {
+        pushed = ring.try_emplace<snapshot>(2, snapshot{i, {}});
+      } else if (i % 4 == 0) {
+        pushed = ring.try_emplace<quote>(1, quote{i, 1.0, 1.5});
+      } else {
+        pushed = ring.try_emplace<trade>(
+            0, trade{static_cast<std::uint32_t>(i), 100});
+      }
+      if (!pushed) {
+        std::this_thread::yield();
+      }
+    }
+  }
+  consumer.join();
+  ds::bench::do_not_optimize(sum);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  ds::bench::runner runner(argc, argv, "message_ring");
+  runner.add("mixed/variant_thread_safe_queue", variant_queue);
+  runner.add("mixed/message_ring", message_ring);
+  return runner.run();
+}
@@ -0,0 +1,242 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace ds {
+
+/*
+ * message_ring
+ * Single-producer single-consumer ring of variable-length records, for
+ * streams that mix message types of different sizes without paying for a
+ * std::variant sized to the largest one or a unique_ptr per message.
+ *
+ *   [hdr|payload..][hdr|payload....][hdr|pl][pad........]
+ *    ^tail (consumer)                        ^head (producer)
+ *
+ * Each record is an 8-byte header { size, tag } followed by its payload,
+ * rounded up to 8 bytes. A record never straddles the end of the buffer:
+ * when it would not fit in the bytes left before the end, the producer
+ * writes a padding header there and places the record at offset 0; the
+ * consumer skips padding when it meets it.
+ *
+ *   producer   p = try_reserve(n, tag)   claim n bytes, nullptr if full
+ *              construct the record at p
+ *              commit() / commit(used)   publish it (optionally shorter)
+ *   consumer   peek() -> record          a span over the payload, in place
+ *              advance()                 hand the bytes back
+ *
+ * head_ and tail_ count bytes since construction and each side caches the
+ * other's, so a reserve or a read only touches the shared line when the
+ * cache says the ring is full or empty.
+ */
+class message_ring {
+  struct header {
+    std::uint32_t size;
+    std::uint32_t tag;
+  };
+
+public:
+  // Records are 8-byte aligned; payload types may not ask for more.
+  static constexpr std::size_t alignment = 8;
+  static constexpr std::uint32_t padding_tag = 0xffffffff;
+
+  struct record {
+    std::uint32_t tag;
+    std::span<const std::byte> bytes;
+
+    // The object a producer constructed with try_emplace<T>().
+    template <typename T> [[nodiscard]] const T &as() const noexcept {
+      return *std::launder(reinterpret_cast<const T *>(bytes.data()));
+    }
+  };
+
+  // Capacity in bytes, rounded up to a power of two.
+  explicit message_ring(std::size_t capacity)
+      : mask_(std::bit_ceil(std::max<std::size_t>(capacity, 64)) - 1),
+        words_(std::make_unique<std::uint64_t[]>((mask_ + 1) / alignment)),
+        buffer_(reinterpret_cast<std::byte *>(words_.get())) {}
+
+  message_ring(const message_ring &) = delete;
+  message_ring &operator=(const message_ring &) = delete;
+
+  [[nodiscard]] std::size_t capacity() const noexcept { return mask_ + 1; }
+
+  // Largest payload try_reserve() accepts.
+  [[nodiscard]] std::size_t max_record() const noexcept {
+    return capacity() / 2 - sizeof(header);
+  }
+
+  // ----- PRODUCER API -----
+
+  // Space for an n-byte payload, or nullptr while the consumer holds too
+  // much of the ring. Throws std::length_error if n > max_record(); `tag`
+  // may be anything but padding_tag.
+  [[nodiscard]] std::byte *try_reserve(std::size_t n,
+                                       std::uint32_t tag = 0) {
+    if (n > max_record()) {
+      throw std::length_error("message_ring: record larger than max_record()");
+    }
+    if (tag == padding_tag) {
+      throw std::invalid_argument("message_ring: padding_tag is reserved");
+    }
+    std::size_t need = footprint(n);
+    std::uint64_t head = head_cache_;
+    std::size_t offset = static_cast<std::size_t>(head & mask_);
+    std::size_t to_end = capacity() - offset;
+    std::size_t total = to_end < need ? to_end + need : need;
+
+    if (capacity() - (head - tail_cache_) < total) {
+      tail_cache_ = tail_.load(std::memory_order_acquire);
+      if (capacity() - (head - tail_cache_) < total) {
+        return nullptr;
+      }
+    }
+    if (to_end < need) {
+      write_header(offset, header{0, padding_tag});
+      head += to_end;
+      offset = 0;
+    }
+    write_header(offset, header{static_cast<std::uint32_t>(n), tag});
+    reserved_at_ = head;
+    reserved_ = n;
+    return buffer_ + offset + sizeof(header);
+  }
+
+  // Spins (yielding) until the consumer frees enough space.
+  [[nodiscard]] std::byte *reserve(std::size_t n, std::uint32_t tag = 0) {
+    std::byte *p = nullptr;
+    while ((p = try_reserve(n, tag)) == nullptr) {
+      std::this_thread::yield();
+    }
+    return p;
+  }
+
+  // Publishes the reserved record, trimmed to `used` bytes if given.
+  void commit() { commit(reserved_); }
+  void commit(std::size_t used) {
+    if (used > reserved_) {
+      throw std::length_error("message_ring: commit() past the reservation");
+    }
+    std::size_t offset = static_cast<std::size_t>(reserved_at_ & mask_);
+    if (used != reserved_) {
+      std::uint32_t size = static_cast<std::uint32_t>(used);
+      std::memcpy(buffer_ + offset, &size, sizeof(size));
+    }
+    head_cache_ = reserved_at_ + footprint(used);
+    head_.store(head_cache_, std::memory_order_release);
+  }
+
+  // Constructs a T as the payload of a `tag` record and commits it.
+  template <typename T, typename... Args>
+  bool try_emplace(std::uint32_t tag, Args &&...args) {
+    static_assert(alignof(T) <= alignment);
+    static_assert(std::is_trivially_destructible_v<T>,
+                  "records are released without running destructors");
+    std::byte *p = try_reserve(sizeof(T), tag);
+    if (p == nullptr) {
+      return false;
+    }
+    ::new (p) T(std::forward<Args>(args)...);
+    commit();
+    return true;
+  }
+
+  // ----- CONSUMER API -----
+
+  // The oldest committed record, valid until advance().
+  [[nodiscard]] std::optional<record> peek() {
+    while (true) {
+      if (tail_local_ == head_seen_) {
+        head_seen_ = head_.load(std::memory_order_acquire);
+        if (tail_local_ == head_seen_) {
+          return std::nullopt;
+        }
+      }
+      std::size_t offset = static_cast<std::size_t>(tail_local_ & mask_);
+      header h = read_header(offset);
+      if (h.tag == padding_tag) {
+        tail_local_ += capacity() - offset;
+        continue;
+      }
+      return record{h.tag, {buffer_ + offset + sizeof(header), h.size}};
+    }
+  }
+
+  // Releases the record peek() returned.
+  void advance() {
+    std::size_t offset = static_cast<std::size_t>(tail_local_ & mask_);
+    tail_local_ += footprint(read_header(offset).size);
+    tail_.store(tail_local_, std::memory_order_release);
+  }
+
+  // Hands every available record to fn(const record&), then releases them
+  // with a single store. Returns the count.
+  template <typename Fn> std::size_t poll(Fn &&fn) {
+    std::size_t count = 0;
+    while (std::optional<record> r = peek()) {
+      fn(static_cast<const record &>(*r));
+      std::size_t offset = static_cast<std::size_t>(tail_local_ & mask_);
+      tail_local_ += footprint(read_header(offset).size);
+      ++count;
+    }
+    if (count != 0) {
+      tail_.store(tail_local_, std::memory_order_release);
+    }
+    return count;
+  }
+
+  // Committed bytes not yet released, padding included (approximate while
+  // the other side is active). tail is read first so the later head read
+  // cannot be behind it.
+  [[nodiscard]] std::size_t used_bytes() const noexcept {
+    std::uint64_t tail = tail_.load(std::memory_order_acquire);
+    std::uint64_t head = head_.load(std::memory_order_acquire);
+    return static_cast<std::size_t>(head - tail);
+  }
+
+private:
+  static constexpr std::size_t footprint(std::size_t n) noexcept {
+    return (sizeof(header) + n + alignment - 1) & ~(alignment - 1);
+  }
+
+  void write_header(std::size_t offset, header h) noexcept {
+    std::memcpy(buffer_ + offset, &h, sizeof(h));
+  }
+
+  [[nodiscard]] header read_header(std::size_t offset) const noexcept {
+    header h;
+    std::memcpy(&h, buffer_ + offset, sizeof(h));
+    return h;
+  }
+
+  std::size_t mask_;
+  std::unique_ptr<std::uint64_t[]> words_; // 8-byte aligned storage
+  std::byte *buffer_;
+
+  // Producer-owned.
+  alignas(64) std::uint64_t head_cache_{0};
+  std::uint64_t tail_cache_{0};
+  std::uint64_t reserved_at_{0};
+  std::size_t reserved_{0};
+  alignas(64) std::atomic<std::uint64_t> head_{0};
+
+  // Consumer-owned.
+  alignas(64) std::uint64_t tail_local_{0};
+  std::uint64_t head_seen_{0};
+  alignas(64) std::atomic<std::uint64_t> tail_{0};
+};
+
+} // namespace ds
@@ -0,0 +1,160 @@
+#include "message_ring.hpp"
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+enum tag : std::uint32_t { quote_tag = 1, trade_tag = 2, text_tag = 3 };
+
+struct quote {
+  std::uint64_t symbol;
+  double bid;
+  double ask;
+};
+
+struct trade {
+  std::uint32_t symbol;
+  std::uint32_t size;
+};
+
+bool push_text(ds::message_ring &ring, std::string_view text) {
+  std::byte *p = ring.try_reserve(text.size(), text_tag);
+  if (p == nullptr) {
+    return false;
+  }
+  std::memcpy(p, text.data(), text.size());
+  ring.commit();
+  return true;
+}
+
+std::string_view as_text(const ds::message_ring::record &r) {
+  return {reinterpret_cast<const char *>(r.bytes.data()), r.bytes.size()};
+}
+
+} // namespace
+
+// ------ SINGLE THREAD -------
+
+TEST_CASE("records of different types come out in order", "[ring]") {
+  ds::message_ring ring(256);
+  REQUIRE(ring.try_emplace<quote>(quote_tag, quote{7, 99.5, 100.0}));
+  REQUIRE(ring.try_emplace<trade>(trade_tag, trade{7, 300}));
+  REQUIRE(push_text(ring, "halt"));
+
+  auto r = ring.peek();
+  REQUIRE(r.has_value());
+  REQUIRE(r->tag == quote_tag);
+  REQUIRE(r->bytes.size() == sizeof(quote));
+  REQUIRE(r->as<quote>().ask == 100.0);
+  ring.advance();
+
+  r = ring.peek();
+  REQUIRE(r->tag == trade_tag);
+  REQUIRE(r->as<trade>().size == 300);
+  ring.advance();
+
+  r = ring.peek();
+  REQUIRE(r->tag == text_tag);
+  REQUIRE(as_text(*r) == "halt");
+  ring.advance();
+
+  REQUIRE_FALSE(ring.peek().has_value());
+  REQUIRE(ring.used_bytes() == 0);
+}
+
+TEST_CASE("space used follows the record sizes", "[ring]") {
+  ds::message_ring ring(256);
+  REQUIRE(ring.try_emplace<trade>(trade_tag, trade{1, 1})); // 8 + 8
+  REQUIRE(push_text(ring, "abc"));                          // 8 + 3 -> 16
+  REQUIRE(ring.used_bytes() == 32);
+}
+
+TEST_CASE("commit may trim the reservation", "[ring]") {
+  ds::message_ring ring(128);
+  std::byte *p = ring.try_reserve(40, text_tag);
+  REQUIRE(p != nullptr);
+  std::memcpy(p, "hello", 5);
+  ring.commit(5);
+  REQUIRE(ring.used_bytes() == 16);
+  REQUIRE(as_text(*ring.peek()) == "hello");
+  REQUIRE_THROWS_AS(ring.commit(41), std::length_error);
+}
+
+TEST_CASE("a full ring refuses until the consumer frees space", "[ring]") {
+  ds::message_ring ring(64);
+  REQUIRE(ring.try_emplace<quote>(quote_tag, quote{})); // 32 bytes
+  REQUIRE(ring.try_emplace<quote>(quote_tag, quote{})); // 64 bytes
+  REQUIRE_FALSE(ring.try_emplace<trade>(trade_tag, trade{}));
+  REQUIRE(ring.peek().has_value());
+  ring.advance();
+  REQUIRE(ring.try_emplace<trade>(trade_tag, trade{}));
+  REQUIRE_THROWS_AS(ring.try_reserve(ring.max_record() + 1),
+                    std::length_error);
+  REQUIRE_THROWS_AS(ring.try_reserve(8, ds::message_ring::padding_tag),
+                    std::invalid_argument);
+}
+
+TEST_CASE("records never straddle the end; padding is skipped", "[ring]") {
+  ds::message_ring ring(64);
+  // 24 + 24 bytes, leaving 16 before the end.
+  REQUIRE(push_text(ring, "0123456789abcdef"));
+  REQUIRE(push_text(ring, "ghijklmnopqrstuv"));
+  REQUIRE(as_text(*ring.peek()) == "0123456789abcdef");
+  ring.advance();
+
+  // Needs 24: pads the last 16 bytes and wraps to offset 0.
+  REQUIRE(push_text(ring, "wrapped-record!!"));
+  REQUIRE(ring.used_bytes() == 24 + 16 + 24);
+
+  std::vector<std::string_view> seen;
+  REQUIRE(ring.poll([&](const ds::message_ring::record &r) {
+    seen.push_back(as_text(r));
+  }) == 2);
+  REQUIRE(seen[0] == "ghijklmnopqrstuv");
+  REQUIRE(seen[1] == "wrapped-record!!");
+  REQUIRE(ring.used_bytes() == 0);
+}
+
+// ------ THREADED -------
+
+TEST_CASE("a producer and a consumer thread agree on every record",
+          "[ring][threaded]") {
+  ds::message_ring ring(1024);
+  constexpr std::uint32_t count = 50'000;
+
+  std::thread producer([&] {
+    for (std::uint32_t i = 0; i < count; ++i) {
+      // Sizes 0..99 so the ring wraps at every possible offset.
+      std::size_t size = i % 100;
+      std::byte *p = ring.reserve(size, i);
+      for (std::size_t b = 0; b < size; ++b) {
+        p[b] = static_cast<std::byte>(i + b);
+      }
+      ring.commit();
+    }
+  });
+
+  bool intact = true;
+  std::uint32_t next = 0;
+  while (next < count) {
+    std::size_t n = ring.poll([&](const ds::message_ring::record &r) {
+      intact = intact && r.tag == next && r.bytes.size() == next % 100;
+      for (std::size_t b = 0; b < r.bytes.size(); ++b) {
+        intact = intact && r.bytes[b] == static_cast<std::byte>(next + b);
+      }
+      ++next;
+    });
+    if (n == 0) {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+  REQUIRE(intact);
+  REQUIRE_FALSE(ring.peek().has_value());
+}
@@ -0,0 +1,145 @@
+#include "benchmark.hpp"
+#include "order_book.hpp"
+
+namespace {
+
+// Resting orders spread over `levels` prices either side of 1000.
+template <typename Book>
+void fill(Book &book, std::size_t orders, long levels) {
+  using order = typename Book::order_type;
+  using id_type = typename order::id_type;
+  using price_type = typename order::price_type;
+  for (std::size_t i = 0; i < orders; ++i) {
+    bool buy = i % 2 == 0;
+    long offset = 1 + static_cast<long>(i / 2) % levels;
+    auto price = static_cast<price_type>(buy ? 1000 - offset : 1000 + offset);
+    book.AddOrder(order(static_cast<id_type>(i), price, buy, 10));
+  }
+}
+
+template <typename Book> void add_resting(ds::bench::state &st) {
+  Book book;
+  fill(book, st.iterations(), 100);
+}
+
+template <typename Book> void add_crossing(ds::bench::state &st) {
+  using order = typename Book::order_type;
+  Book book;
+  st.pause();
+  fill(book, 1000, 100);
+  st.resume();
+  typename order::id_type id = 1000;
+  for (std::size_t i = 0; i < st.iterations(); ++i) {
+    // Replenish the best ask, then take it.
+    book.AddOrder(order(id++, 1001, false, 1));
+    auto trades = book.AddOrder(order(id++, 1001, true, 1));
+    ds::bench::do_not_optimize(trades);
+  }
+}
+
+template <typename Book> void cancel(ds::bench::state &st) {
+  using order = typename Book::order_type;
+  Book book;
+  st.pause();
+  fill(book, 1000, 100);
+  st.resume();
+  typename order::id_type id = 1000;
+  for (std::size_t i = 0; i < st.iterations(); ++i) {
+    book.AddOrder(order(id, 900, true, 1));
+    book.CancelOrder(id++);
+  }
+}
+
+// One session with `per_owner` orders over 10 levels pulls everything.
+template <typename Book> void mass_cancel(ds::bench::state &st) {
+  using order = typename Book::order_type;
+  using id_type = typename order::id_type;
+  using price_type = typename order::price_type;
+  constexpr std::size_t per_owner = 100;
+  Book book;
+  st.pause();
+  fill(book, 1000, 100);
+  st.resume();
+  id_type id = 1000;
+  for (std::size_t i = 0; i < st.iterations(); ++i) {
+    st.pause();
+    for (std::size_t j = 0; j < per_owner; ++j) {
+      auto price = static_cast<price_type>(950 - static_cast<long>(j % 10));
+      book.AddOrder(order(id++, price, true, 1), 1);
+    }
+    st.resume();
+    auto updates = book.MassCancel(1);
+    ds::bench::do_not_optimize(updates);
+  }
+}
+
+// Snapshot taken after every crossing add; each one is held until the next,
+// so every update after it has to copy its path.
+template <typename Book> void snapshot_per_trade(ds::bench::state &st) {
+  using order = typename Book::order_type;
+  Book book;
+  st.pause();
+  fill(book, 1000, 100);
+  st.resume();
+  typename order::id_type id = 1000;
+  typename Book::depth_type held;
+  for (std::size_t i = 0; i < st.iterations(); ++i) {
+    book.AddOrder(order(id++, 1001, false, 1));
+    auto trades = book.AddOrder(order(id++, 1001, true, 1));
+    held = book.snapshot();
+    ds::bench::do_not_optimize(trades);
+    ds::bench::do_not_optimize(held);
+  }
+}
+
+// 10000 sell stops rest far below the market; each iteration parks one
+// more just under it and prints a trade that fires only that one.
+template <typename Book> void stop_fire(ds::bench::state &st) {
+  using order = typename Book::order_type;
+  using id_type = typename order::id_type;
+  using price_type = typename order::price_type;
+  Book book;
+  st.pause();
+  fill(book, 1000, 100);
+  id_type id = 1000;
+  for (std::size_t i = 0; i < 10000; ++i) {
+    auto trigger = static_cast<price_type>(500 + static_cast<long>(i % 100));
+    book.AddStopOrder(order(id++, trigger, false, 1), trigger);
+  }
+  st.resume();
+  for (std::size_t i = 0; i < st.iterations(); ++i) {
+    book.AddStopOrder(order(id++, 999, false, 1), 999);
+    book.AddOrder(order(id++, 999, true, 1));
+    auto trades = book.AddOrder(order(id++, 999, false, 1));
+    ds::bench::do_not_optimize(trades);
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  ds::bench::runner runner(argc, argv, "order_book");
+
+  runner.add("add/resting_100_levels", add_resting<ds::Orderbook>);
+  runner.add("add/resting_100_levels/compact",
+             add_resting<ds::CompactOrderbook>);
+  runner.add("add/crossing_against_1000_resting", add_crossing<ds::Orderbook>);
+  runner.add("add/crossing_against_1000_resting/compact",
+             add_crossing<ds::CompactOrderbook>);
+  runner.add("cancel/from_1000_resting", cancel<ds::Orderbook>);
+  runner.add("cancel/from_1000_resting/compact", cancel<ds::CompactOrderbook>);
+
+  runner.add("mass_cancel/100_orders_10_levels", mass_cancel<ds::Orderbook>);
+  runner.add("mass_cancel/100_orders_10_levels/compact",
+             mass_cancel<ds::CompactOrderbook>);
+
+  runner.add("snapshot/per_crossing_add", snapshot_per_trade<ds::Orderbook>);
+  runner.add("snapshot/per_crossing_add/compact",
+             snapshot_per_trade<ds::CompactOrderbook>);
+
+  runner.add("stops/fire_1_of_10000_pending", stop_fire<ds::Orderbook>);
+  runner.add("stops/fire_1_of_10000_pending/compact",
+             stop_fire<ds::CompactOrderbook>);
+
+  return runner.run();
+}
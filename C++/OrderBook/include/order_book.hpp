@@ -1,6 +1,16 @@
+#pragma once
+
+#include "persistent_levels.hpp"
+
 #include <algorithm>
 #include <cstddef>
-#include <unordered_set>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
 
 namespace ds {
@@ -9,35 +19,103 @@ using Id = size_t;
 using Price = long;
 using Quantity = int;
 
-class Order {
+/*
+ * Order widths
+ * The book is templated on a traits type naming the id, price and quantity
+ * types of a resting order. The side shares the quantity word: its top bit
+ * is the buy flag, so quantities are limited to the remaining bits.
+ *
+ *   default_order_traits   size_t / long / int      24 bytes (was 32)
+ *   compact_order_traits   uint32 / int32 / uint32  12 bytes
+ *
+ * Trade keeps the wide public types; values are widened when a trade is
+ * reported.
+ */
+
+template <typename IdT, typename PriceT, typename QuantityT,
+          typename OwnerT = std::uint32_t>
+struct order_traits {
+  static_assert(std::is_integral_v<IdT> && std::is_integral_v<PriceT> &&
+                std::is_integral_v<QuantityT>);
+  using id_type = IdT;
+  using price_type = PriceT;
+  using quantity_type = QuantityT;
+  // Session / participant tag used by MassCancel; kept in the book's side
+  // table, not in the order record.
+  using owner_type = OwnerT;
+};
+
+using default_order_traits = order_traits<Id, Price, Quantity>;
+using compact_order_traits =
+    order_traits<std::uint32_t, std::int32_t, std::uint32_t>;
+
+template <typename Traits = default_order_traits> class basic_order {
 public:
-  Order(Id orderId, Price level, bool isBuy, Quantity quantity)
-      : order_id_(orderId), level_(level), is_buy_(isBuy), quantity_(quantity) {
-  }
+  using id_type = typename Traits::id_type;
+  using price_type = typename Traits::price_type;
+  using quantity_type = typename Traits::quantity_type;
 
-  Id get_order_id() const { return order_id_; }
+private:
+  using quantity_bits = std::make_unsigned_t<quantity_type>;
+  static constexpr quantity_bits side_bit = quantity_bits{1}
+                                            << (sizeof(quantity_bits) * 8 - 1);
 
-  Id OrderId() const { return order_id_; }
+public:
+  // Largest quantity that still leaves the top bit for the side.
+  static constexpr quantity_type max_quantity =
+      static_cast<quantity_type>(std::min<quantity_bits>(
+          static_cast<quantity_bits>(side_bit - 1),
+          static_cast<quantity_bits>(
+              std::numeric_limits<quantity_type>::max())));
 
-  bool is_buy_order() const { return is_buy_; }
+  basic_order(id_type orderId, price_type level, bool isBuy,
+              quantity_type quantity)
+      : order_id_(orderId), level_(level),
+        quantity_side_(pack(quantity, isBuy)) {}
 
-  Price get_level() const { return level_; }
+  id_type get_order_id() const { return order_id_; }
 
-  Quantity get_quantity() const { return quantity_; }
+  id_type OrderId() const { return order_id_; }
 
-  void decrease_quantity(Quantity q) {
-    if (q > quantity_)
+  bool is_buy_order() const { return (quantity_side_ & side_bit) != 0; }
+
+  price_type get_level() const { return level_; }
+
+  quantity_type get_quantity() const {
+    return static_cast<quantity_type>(quantity_side_ & ~side_bit);
+  }
+
+  void decrease_quantity(quantity_type q) {
+    if (q > get_quantity())
       return;
-    quantity_ -= q;
+    quantity_side_ = static_cast<quantity_bits>(quantity_side_ -
+                                                static_cast<quantity_bits>(q));
   }
 
 private:
-  Id order_id_{};
-  Price level_{};
-  bool is_buy_{};
-  Quantity quantity_{};
+  static quantity_bits pack(quantity_type quantity, bool is_buy) {
+    bool negative = false;
+    if constexpr (std::is_signed_v<quantity_type>) {
+      negative = quantity < 0;
+    }
+    if (negative || quantity > max_quantity) {
+      throw std::out_of_range("order quantity does not fit the traits");
+    }
+    auto bits = static_cast<quantity_bits>(quantity);
+    return is_buy ? static_cast<quantity_bits>(bits | side_bit) : bits;
+  }
+
+  id_type order_id_{};
+  price_type level_{};
+  quantity_bits quantity_side_{};
 };
 
+using Order = basic_order<>;
+using CompactOrder = basic_order<compact_order_traits>;
+
+static_assert(sizeof(Order) <= 24);
+static_assert(sizeof(CompactOrder) == 12);
+
 using Orders = std::vector<Order>;
 
 // DO NOT MODIFY.
@@ -52,97 +130,515 @@ struct Trade {
 
 using Trades = std::vector<Trade>;
 
-inline bool sort_bids(const Order &bid1, const Order &bid2) {
-  return bid1.get_level() > bid2.get_level();
-}
+// Aggregate resting quantity at one price after a change; 0 means the level
+// is gone. Emitted in bulk by MassCancel.
+struct LevelUpdate {
+  bool IsBuy;
+  Price Level;
+  std::int64_t Size;
+};
+
+using LevelUpdates = std::vector<LevelUpdate>;
 
-inline bool sort_asks(const Order &ask1, const Order &ask2) {
-  return ask1.get_level() < ask2.get_level();
-}
+namespace detail {
 
-class Orderbook {
+// Index-addressed storage whose elements never move: fixed chunks of a
+// power-of-two size, so operator[] is a shift and a mask. std::deque would
+// divide by a block length that depends on sizeof(T).
+template <typename T, std::size_t ChunkBits = 10> class chunked_pool {
 public:
-  // Implement AddOrder and CancelOrder.
-  Trades AddOrder(const Order &order) {
-    // check if this order already exists in the order book
-    if (existing_order_ids_.contains(order.get_order_id())) {
-      return {};
+  static constexpr std::size_t chunk_size = std::size_t{1} << ChunkBits;
+
+  [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+  T &operator[](std::size_t i) noexcept {
+    return chunks_[i >> ChunkBits][i & (chunk_size - 1)];
+  }
+  const T &operator[](std::size_t i) const noexcept {
+    return chunks_[i >> ChunkBits][i & (chunk_size - 1)];
+  }
+
+  void push_back(const T &value) {
+    if (size_ == chunks_.size() * chunk_size) {
+      chunks_.emplace_back().reserve(chunk_size);
     }
-    // add the order_id of the order
-    existing_order_ids_.insert(order.get_order_id());
-    // add the order in the appropriate list
+    chunks_.back().push_back(value);
+    ++size_;
+  }
+
+private:
+  // Each inner vector is reserved once and never grows past it.
+  std::vector<std::vector<T>> chunks_;
+  std::size_t size_{0};
+};
+
+} // namespace detail
+
+/*
+ * Book layout
+ *
+ *   bids_ / asks_   price -> price_level, best price first
+ *   price_level     FIFO of order_nodes (time priority) + total quantity
+ *   nodes_[i]       order_node: the order and its prev/next links within
+ *                   its price level - all that matching touches
+ *   meta_[i]        node_meta side table: owner, owner_prev/owner_next
+ *                   within its owner's orders, level, stop flag
+ *   orders_         id -> node       (CancelOrder without searching)
+ *   owners_         owner -> first node of that owner's list
+ *
+ * Links are 32-bit indices into the two pools, so a resting order costs
+ * sizeof(order) + 8 bytes on the matching path (20 compact, 32 default)
+ * and the owner bookkeeping stays out of the levels' cache lines. Freed
+ * indices go on a free list and are reused after the first fill.
+ * MassCancel(owner) walks the owner's list once, unlinking each node from
+ * its level in O(1), then emits one LevelUpdate per level it touched.
+ *
+ * Every level change is mirrored into depth_, a persistent_levels pair, so
+ * snapshot() is a copy of two root pointers. The matcher pays one
+ * O(log levels) tree update per changed level, in place unless a snapshot
+ * still shares the path.
+ *
+ * Stop-limit orders wait in trigger buckets - the same price_level/node
+ * FIFO, keyed by trigger price and invisible to matching and depth:
+ *
+ *   buy_stops_    trigger ascending   fire once a trade prints >= trigger
+ *   sell_stops_   trigger descending  fire once a trade prints <= trigger
+ *
+ * After an AddOrder trades, whole buckets are popped off the front of each
+ * map while they are crossed - nothing uncrossed is looked at - and the
+ * fired orders go back through AddOrder one by one: buy stops (lowest
+ * trigger first), then sell stops (highest first), FIFO within a bucket.
+ * Their trades can fire further stops; all of it is reported as the
+ * original AddOrder's trades.
+ */
+template <typename Traits = default_order_traits> class basic_orderbook {
+public:
+  using order_type = basic_order<Traits>;
+  using id_type = typename order_type::id_type;
+  using price_type = typename order_type::price_type;
+  using quantity_type = typename order_type::quantity_type;
+  using owner_type = typename Traits::owner_type;
+  using depth_type = book_depth<price_type>;
+
+  basic_orderbook() = default;
+  basic_orderbook(const basic_orderbook &) = delete;
+  basic_orderbook &operator=(const basic_orderbook &) = delete;
+  basic_orderbook(basic_orderbook &&) noexcept = default;
+  basic_orderbook &operator=(basic_orderbook &&) noexcept = default;
+
+  // Orders added without an owner all share owner_type{}.
+  Trades AddOrder(const order_type &order, owner_type owner = owner_type{}) {
+    Trades trades = add_limit(order, owner);
+    if (!trades.empty() && (!buy_stops_.empty() || !sell_stops_.empty())) {
+      fire_stops(trades);
+    }
+    return trades;
+  }
+
+  // Parks `order` until a trade prints at or through `trigger`, then adds it
+  // as a limit order at its own price. A plain stop is a stop-limit whose
+  // limit is far enough through the market to fill. Ids share the space of
+  // resting orders; CancelOrder and MassCancel remove pending stops too.
+  bool AddStopOrder(const order_type &order, price_type trigger,
+                    owner_type owner = owner_type{}) {
+    if (orders_.contains(order.get_order_id())) {
+      return false;
+    }
+    node_index node = make_node(order, owner);
+    meta_[node].stop = true;
     if (order.is_buy_order()) {
-      bids_.emplace_back(order);
-      std::stable_sort(bids_.begin(), bids_.end(), sort_bids);
+      park(buy_stops_, node, trigger);
     } else {
-      asks_.emplace_back(order);
-      std::stable_sort(asks_.begin(), asks_.end(), sort_asks);
+      park(sell_stops_, node, trigger);
     }
-    // execute the order
-    return ExecuteTrades(order.get_order_id());
+    orders_.emplace(order.get_order_id(), node);
+    link_owner(node);
+    return true;
   }
 
-  void CancelOrder(Id orderId) {
-    if (!existing_order_ids_.contains(orderId)) {
+  void CancelOrder(id_type orderId) {
+    auto it = orders_.find(orderId);
+    if (it == orders_.end()) {
       return;
     }
-    auto remove = [&](Orders &orders) {
-      for (auto it = orders.begin(); it != orders.end(); ++it) {
-        if (it->get_order_id() == orderId) {
-          orders.erase(it);
-          existing_order_ids_.erase(orderId);
-          return true;
-        }
+    node_index node = it->second;
+    orders_.erase(it);
+    if (meta_[node].stop) {
+      unpark(node);
+    } else {
+      unlink_level(node);
+      settle(meta_[node].level);
+    }
+    unlink_owner(node);
+    free_node(node);
+  }
+
+  // Cancels every resting order of `owner`; cost is proportional to the
+  // number of orders cancelled plus the levels they sat on.
+  LevelUpdates MassCancel(owner_type owner) {
+    LevelUpdates updates;
+    auto it = owners_.find(owner);
+    if (it == owners_.end()) {
+      return updates;
+    }
+    node_index node = it->second;
+    owners_.erase(it);
+
+    ++cancel_epoch_;
+    touched_.clear();
+    while (node != no_node) {
+      const node_meta &meta = meta_[node];
+      node_index next = meta.owner_next;
+      price_level *level = meta.level;
+      if (meta.stop) {
+        // Pending stops are not in the depth; no update to report.
+        orders_.erase(nodes_[node].order.get_order_id());
+        unpark(node);
+        free_node(node);
+        node = next;
+        continue;
       }
-      return false;
-    };
-    if (!remove(bids_)) {
-      remove(asks_);
+      if (level->touched != cancel_epoch_) {
+        level->touched = cancel_epoch_;
+        touched_.push_back(level);
+      }
+      orders_.erase(nodes_[node].order.get_order_id());
+      unlink_level(node);
+      free_node(node);
+      node = next;
+    }
+
+    updates.reserve(touched_.size());
+    for (price_level *level : touched_) {
+      updates.push_back(LevelUpdate{.IsBuy = level->is_buy,
+                                    .Level = static_cast<Price>(level->price),
+                                    .Size = level->quantity});
+      settle(level);
     }
+    return updates;
   }
 
-  Trades ExecuteTrades(Id aggressor_id) {
+  Trades ExecuteTrades(id_type aggressor_id) {
     Trades trades;
 
     while (!bids_.empty() && !asks_.empty()) {
-      Order &bid = bids_.front();
-      Order &ask = asks_.front();
+      price_level &bid_level = bids_.begin()->second;
+      price_level &ask_level = asks_.begin()->second;
 
-      if (bid.get_level() < ask.get_level()) {
+      if (bid_level.price < ask_level.price) {
         break;
       }
 
-      Quantity traded_qty = std::min(bid.get_quantity(), ask.get_quantity());
+      const order_type &bid = nodes_[bid_level.head].order;
+      const order_type &ask = nodes_[ask_level.head].order;
+      auto traded_qty = std::min(bid.get_quantity(), ask.get_quantity());
 
       bool aggressor_is_buy = (aggressor_id == bid.get_order_id());
 
-      trades.push_back(
-          Trade{.OrderIdA = bid.get_order_id(),
-                .OrderIdB = ask.get_order_id(),
-                .AggressorOrderId = aggressor_id,
-                .AggressorIsBuy = aggressor_is_buy,
-                .Level = aggressor_is_buy ? bid.get_level() : ask.get_level(),
-                .Size = traded_qty});
+      trades.push_back(Trade{
+          .OrderIdA = static_cast<Id>(bid.get_order_id()),
+          .OrderIdB = static_cast<Id>(ask.get_order_id()),
+          .AggressorOrderId = static_cast<Id>(aggressor_id),
+          .AggressorIsBuy = aggressor_is_buy,
+          .Level = static_cast<Price>(aggressor_is_buy ? bid_level.price
+                                                       : ask_level.price),
+          .Size = static_cast<Quantity>(traded_qty)});
+
+      fill(bid_level, traded_qty);
+      fill(ask_level, traded_qty);
+    }
+    return trades;
+  }
+
+  // ----- QUERIES -----
+  // Orders in the book, pending stops included.
+  [[nodiscard]] std::size_t resting_orders() const { return orders_.size(); }
+
+  [[nodiscard]] std::size_t pending_stops() const { return stop_count_; }
+
+  // Total resting quantity at a price; 0 when there is no level there.
+  [[nodiscard]] std::int64_t level_size(bool is_buy, price_type price) const {
+    if (is_buy) {
+      auto it = bids_.find(price);
+      return it == bids_.end() ? 0 : it->second.quantity;
+    }
+    auto it = asks_.find(price);
+    return it == asks_.end() ? 0 : it->second.quantity;
+  }
+
+  // Full depth of both sides as of now, in O(1). The result is immutable and
+  // may be read and dropped on any thread while the book keeps trading.
+  [[nodiscard]] depth_type snapshot() const { return depth_; }
+
+private:
+  struct price_level;
 
-      bid.decrease_quantity(traded_qty);
-      ask.decrease_quantity(traded_qty);
+  using node_index = std::uint32_t;
+  static constexpr node_index no_node = std::numeric_limits<node_index>::max();
 
-      if (bid.get_quantity() == 0) {
-        existing_order_ids_.erase(bid.get_order_id());
-        bids_.erase(bids_.begin());
+  // What matching touches: the order and its place in the level FIFO.
+  struct order_node {
+    order_type order;
+    node_index prev{no_node};
+    node_index next{no_node};
+  };
+
+  static_assert(sizeof(order_node) ==
+                sizeof(order_type) + 2 * sizeof(node_index));
+
+  // Everything else about a node, at the same index in meta_.
+  struct node_meta {
+    owner_type owner{};
+    node_index owner_prev{no_node};
+    node_index owner_next{no_node};
+    bool stop{false};
+    price_level *level{nullptr};
+  };
+
+  struct price_level {
+    price_type price{};
+    bool is_buy{};
+    node_index head{no_node};
+    node_index tail{no_node};
+    std::int64_t quantity{0};
+    std::uint32_t orders{0};
+    std::uint64_t touched{0};
+  };
+
+  using bid_levels = std::map<price_type, price_level, std::greater<>>;
+  using ask_levels = std::map<price_type, price_level, std::less<>>;
+  // Keyed by trigger; the front bucket is always the next to fire.
+  using buy_stop_buckets = std::map<price_type, price_level, std::less<>>;
+  using sell_stop_buckets = std::map<price_type, price_level, std::greater<>>;
+
+  struct fired_stop {
+    order_type order;
+    owner_type owner;
+  };
+
+  // Adds a limit order and matches it; no stop handling.
+  Trades add_limit(const order_type &order, owner_type owner) {
+    // check if this order already exists in the order book
+    if (orders_.contains(order.get_order_id())) {
+      return {};
+    }
+    // rest the order at the back of its price level, then match
+    node_index node = make_node(order, owner);
+    if (order.is_buy_order()) {
+      insert(bids_, node);
+    } else {
+      insert(asks_, node);
+    }
+    orders_.emplace(order.get_order_id(), node);
+    link_owner(node);
+    return ExecuteTrades(order.get_order_id());
+  }
+
+  // ----- NODES -----
+  node_index make_node(const order_type &order, owner_type owner) {
+    if (free_ == no_node) {
+      if (nodes_.size() == no_node) {
+        throw std::length_error("order book node pool is full");
       }
+      nodes_.push_back(order_node{order});
+      meta_.push_back(node_meta{owner});
+      return static_cast<node_index>(nodes_.size() - 1);
+    }
+    node_index node = free_;
+    free_ = nodes_[node].next;
+    nodes_[node] = order_node{order};
+    meta_[node] = node_meta{owner};
+    return node;
+  }
 
-      if (ask.get_quantity() == 0) {
-        existing_order_ids_.erase(ask.get_order_id());
-        asks_.erase(asks_.begin());
+  void free_node(node_index node) {
+    nodes_[node].next = free_;
+    free_ = node;
+  }
+
+  // ----- PRICE LEVELS -----
+  template <typename Levels> void insert(Levels &levels, node_index node) {
+    price_level &level =
+        link_back(levels, node, nodes_[node].order.get_level());
+    settle(&level);
+  }
+
+  // Appends `node` to the FIFO at `price`, creating the level if needed.
+  template <typename Levels>
+  price_level &link_back(Levels &levels, node_index node, price_type price) {
+    auto [it, inserted] = levels.try_emplace(price);
+    price_level &level = it->second;
+    order_node &n = nodes_[node];
+    if (inserted) {
+      level.price = price;
+      level.is_buy = n.order.is_buy_order();
+    }
+    meta_[node].level = &level;
+    n.prev = level.tail;
+    if (level.tail != no_node) {
+      nodes_[level.tail].next = node;
+    } else {
+      level.head = node;
+    }
+    level.tail = node;
+    level.quantity += n.order.get_quantity();
+    ++level.orders;
+    return level;
+  }
+
+  void unlink_level(node_index node) {
+    const order_node &n = nodes_[node];
+    price_level *level = meta_[node].level;
+    (n.prev != no_node ? nodes_[n.prev].next : level->head) = n.next;
+    (n.next != no_node ? nodes_[n.next].prev : level->tail) = n.prev;
+    level->quantity -= n.order.get_quantity();
+    --level->orders;
+  }
+
+  // Publishes a changed level to depth_, dropping it once it is empty.
+  void settle(price_level *level) {
+    if (level->head != no_node) {
+      if (level->is_buy) {
+        depth_.bids.assign(level->price, level->quantity, level->orders);
+      } else {
+        depth_.asks.assign(level->price, level->quantity, level->orders);
       }
+      return;
+    }
+    if (level->is_buy) {
+      depth_.bids.erase(level->price);
+      bids_.erase(level->price);
+    } else {
+      depth_.asks.erase(level->price);
+      asks_.erase(level->price);
     }
-    return trades;
   }
 
-private:
-  Orders bids_;
-  Orders asks_;
-  std::unordered_set<Id> existing_order_ids_;
+  // ----- STOPS -----
+  template <typename Buckets>
+  void park(Buckets &buckets, node_index node, price_type trigger) {
+    link_back(buckets, node, trigger);
+    ++stop_count_;
+  }
+
+  // Takes a pending stop out of its bucket, dropping the bucket if empty.
+  void unpark(node_index node) {
+    price_level *bucket = meta_[node].level;
+    unlink_level(node);
+    --stop_count_;
+    if (bucket->head != no_node) {
+      return;
+    }
+    if (bucket->is_buy) {
+      buy_stops_.erase(bucket->price);
+    } else {
+      sell_stops_.erase(bucket->price);
+    }
+  }
+
+  // Re-adds every stop crossed by `trades`, including those crossed by
+  // the trades of stops it fires, appending all trades to `trades`.
+  void fire_stops(Trades &trades) {
+    std::vector<fired_stop> fired;
+    std::size_t scanned = 0;
+    while (scanned < trades.size()) {
+      auto high = static_cast<price_type>(trades[scanned].Level);
+      auto low = high;
+      for (; scanned < trades.size(); ++scanned) {
+        auto price = static_cast<price_type>(trades[scanned].Level);
+        high = std::max(high, price);
+        low = std::min(low, price);
+      }
+
+      fired.clear();
+      while (!buy_stops_.empty() && buy_stops_.begin()->first <= high) {
+        drain(buy_stops_, fired);
+      }
+      while (!sell_stops_.empty() && sell_stops_.begin()->first >= low) {
+        drain(sell_stops_, fired);
+      }
+      for (const fired_stop &stop : fired) {
+        Trades more = add_limit(stop.order, stop.owner);
+        trades.insert(trades.end(), more.begin(), more.end());
+      }
+    }
+  }
+
+  // Pops the front bucket, FIFO, out of the book and into `fired`.
+  template <typename Buckets>
+  void drain(Buckets &buckets, std::vector<fired_stop> &fired) {
+    auto front = buckets.begin();
+    for (node_index node = front->second.head; node != no_node;) {
+      const order_type &order = nodes_[node].order;
+      node_index next = nodes_[node].next;
+      fired.push_back({order, meta_[node].owner});
+      orders_.erase(order.get_order_id());
+      unlink_owner(node);
+      free_node(node);
+      --stop_count_;
+      node = next;
+    }
+    buckets.erase(front);
+  }
+
+  // Takes `quantity` off the front order of `level`, removing it if done.
+  void fill(price_level &level, quantity_type quantity) {
+    node_index node = level.head;
+    order_type &order = nodes_[node].order;
+    order.decrease_quantity(quantity);
+    level.quantity -= quantity;
+    if (order.get_quantity() != 0) {
+      settle(&level);
+      return;
+    }
+    orders_.erase(order.get_order_id());
+    unlink_level(node);
+    unlink_owner(node);
+    free_node(node);
+    settle(&level);
+  }
+
+  // ----- OWNERS -----
+  void link_owner(node_index node) {
+    node_meta &meta = meta_[node];
+    auto [it, inserted] = owners_.try_emplace(meta.owner, node);
+    if (!inserted) {
+      meta.owner_next = it->second;
+      meta_[it->second].owner_prev = node;
+      it->second = node;
+    }
+  }
+
+  void unlink_owner(node_index node) {
+    const node_meta &meta = meta_[node];
+    if (meta.owner_next != no_node) {
+      meta_[meta.owner_next].owner_prev = meta.owner_prev;
+    }
+    if (meta.owner_prev != no_node) {
+      meta_[meta.owner_prev].owner_next = meta.owner_next;
+    } else if (meta.owner_next != no_node) {
+      owners_[meta.owner] = meta.owner_next;
+    } else {
+      owners_.erase(meta.owner);
+    }
+  }
+
+  bid_levels bids_;
+  ask_levels asks_;
+  depth_type depth_;
+  buy_stop_buckets buy_stops_;
+  sell_stop_buckets sell_stops_;
+  std::size_t stop_count_{0};
+  std::unordered_map<id_type, node_index> orders_;
+  std::unordered_map<owner_type, node_index> owners_;
+  detail::chunked_pool<order_node> nodes_;
+  detail::chunked_pool<node_meta> meta_;
+  node_index free_{no_node};
+  std::vector<price_level *> touched_;
+  std::uint64_t cancel_epoch_{0};
 };
+
+using Orderbook = basic_orderbook<>;
+using CompactOrderbook = basic_orderbook<compact_order_traits>;
+
 } // namespace ds
@@ -0,0 +1,234 @@
+#pragma once
+
+#include "intrusive_ptr.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+namespace ds {
+
+/*
+ * persistent_levels<PriceT, Compare>
+ * Price -> (quantity, order count) map with value semantics and O(1) copies,
+ * used to hand full-depth views of the book to other threads.
+ *
+ *   writer:  v0 ----assign/erase----> v1 ----assign/erase----> v2
+ *                 \                        \
+ *   readers:       snapshot a (== v0)       snapshot b (== v1)
+ *
+ * The map is an AVL tree of reference-counted, immutable-once-shared
+ * nodes. Copying the map copies the root pointer. A writer that changes a
+ * level walks root -> level and, for each node on the way:
+ *
+ *   use_count() == 1   only this map can reach it: modify in place
+ *   use_count() >  1   a snapshot shares it: copy the node, then modify
+ *
+ * So between snapshots updates allocate nothing, and the first update
+ * after a snapshot copies one root-to-leaf path (O(log levels) nodes);
+ * everything else stays shared. A node is freed when the last map - the
+ * writer's or a snapshot - that reaches it lets go.
+ *
+ * Counts are atomic, so a snapshot may be read, copied and dropped on any
+ * thread. Only one thread may modify a given map object.
+ */
+
+template <typename PriceT, typename Compare = std::less<>>
+class persistent_levels {
+public:
+  struct level {
+    PriceT price;
+    std::int64_t quantity;
+    std::uint32_t orders;
+  };
+
+  persistent_levels() = default;
+
+  [[nodiscard]] bool empty() const noexcept { return root_ == nullptr; }
+  [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+  // Best level first (the smallest key under Compare); nullptr when empty.
+  [[nodiscard]] const level *best() const noexcept {
+    const node *n = root_.get();
+    if (n == nullptr) {
+      return nullptr;
+    }
+    while (n->left) {
+      n = n->left.get();
+    }
+    return &n->value;
+  }
+
+  [[nodiscard]] const level *find(const PriceT &price) const noexcept {
+    const node *n = root_.get();
+    while (n != nullptr) {
+      if (less_(price, n->value.price)) {
+        n = n->left.get();
+      } else if (less_(n->value.price, price)) {
+        n = n->right.get();
+      } else {
+        return &n->value;
+      }
+    }
+    return nullptr;
+  }
+
+  // Visits levels best first.
+  template <typename Fn> void for_each(Fn &&fn) const {
+    visit(root_.get(), fn);
+  }
+
+  // Inserts the level or overwrites its quantity and order count.
+  void assign(const PriceT &price, std::int64_t quantity,
+              std::uint32_t orders) {
+    if (insert(root_, level{price, quantity, orders})) {
+      ++size_;
+    }
+  }
+
+  void erase(const PriceT &price) {
+    if (find(price) != nullptr) {
+      remove(root_, price);
+      --size_;
+    }
+  }
+
+private:
+  struct node : intrusive_ref_counter<node, thread_safe_counter> {
+    explicit node(const level &v) : value(v) {}
+
+    level value;
+    intrusive_ptr<node> left;
+    intrusive_ptr<node> right;
+    int height{1};
+  };
+
+  using link = intrusive_ptr<node>;
+
+  // ----- COPY ON WRITE -----
+  // Makes `n` safe to modify, copying it if a snapshot can still see it.
+  static node &own(link &n) {
+    if (n->use_count() != 1) {
+      n = make_intrusive<node>(*n);
+    }
+    return *n;
+  }
+
+  // ----- AVL -----
+  static int height(const link &n) noexcept { return n ? n->height : 0; }
+
+  static void update(node &n) noexcept {
+    n.height = 1 + std::max(height(n.left), height(n.right));
+  }
+
+  static void rotate_right(link &n) {
+    link pivot = std::move(own(n).left);
+    node &p = own(pivot);
+    n->left = std::move(p.right);
+    update(*n);
+    p.right = std::move(n);
+    update(p);
+    n = std::move(pivot);
+  }
+
+  static void rotate_left(link &n) {
+    link pivot = std::move(own(n).right);
+    node &p = own(pivot);
+    n->right = std::move(p.left);
+    update(*n);
+    p.left = std::move(n);
+    update(p);
+    n = std::move(pivot);
+  }
+
+  // `n` must already be owned.
+  static void rebalance(link &n) {
+    update(*n);
+    int balance = height(n->left) - height(n->right);
+    if (balance > 1) {
+      if (height(n->left->left) < height(n->left->right)) {
+        rotate_left(n->left);
+      }
+      rotate_right(n);
+    } else if (balance < -1) {
+      if (height(n->right->right) < height(n->right->left)) {
+        rotate_right(n->right);
+      }
+      rotate_left(n);
+    }
+  }
+
+  // Returns true when a new level was added (the tree may need rebalancing).
+  bool insert(link &n, const level &value) {
+    if (!n) {
+      n = make_intrusive<node>(value);
+      return true;
+    }
+    node &m = own(n);
+    bool added = false;
+    if (less_(value.price, m.value.price)) {
+      added = insert(m.left, value);
+    } else if (less_(m.value.price, value.price)) {
+      added = insert(m.right, value);
+    } else {
+      m.value = value;
+    }
+    if (added) {
+      rebalance(n);
+    }
+    return added;
+  }
+
+  // `price` must be present.
+  void remove(link &n, const PriceT &price) {
+    node &m = own(n);
+    if (less_(price, m.value.price)) {
+      remove(m.left, price);
+    } else if (less_(m.value.price, price)) {
+      remove(m.right, price);
+    } else if (!m.left || !m.right) {
+      link child = std::move(m.left ? m.left : m.right);
+      n = std::move(child);
+      return;
+    } else {
+      m.value = take_min(m.right);
+    }
+    rebalance(n);
+  }
+
+  static level take_min(link &n) {
+    node &m = own(n);
+    if (!m.left) {
+      level value = m.value;
+      link right = std::move(m.right);
+      n = std::move(right);
+      return value;
+    }
+    level value = take_min(m.left);
+    rebalance(n);
+    return value;
+  }
+
+  template <typename Fn> static void visit(const node *n, Fn &fn) {
+    if (n == nullptr) {
+      return;
+    }
+    visit(n->left.get(), fn);
+    fn(n->value);
+    visit(n->right.get(), fn);
+  }
+
+  link root_;
+  std::size_t size_{0};
+  [[no_unique_address]] Compare less_{};
+};
+
+// Both sides of a book at one instant; bids best (highest) first.
+template <typename PriceT> struct book_depth {
+  persistent_levels<PriceT, std::greater<>> bids;
+  persistent_levels<PriceT, std::less<>> asks;
+};
+
+} // namespace ds
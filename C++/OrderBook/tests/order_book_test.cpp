@@ -1,2 +1,292 @@
+#include <catch2/catch_template_test_macros.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include "order_book.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// ------ ORDER LAYOUT -------
+
+TEST_CASE("side bit shares the quantity word", "[order]") {
+  ds::CompactOrder buy(7, 100, true, 50);
+  ds::CompactOrder sell(8, 101, false, 50);
+  REQUIRE(buy.is_buy_order());
+  REQUIRE_FALSE(sell.is_buy_order());
+  REQUIRE(buy.get_quantity() == 50);
+
+  buy.decrease_quantity(20);
+  REQUIRE(buy.get_quantity() == 30);
+  REQUIRE(buy.is_buy_order());
+  buy.decrease_quantity(31);
+  REQUIRE(buy.get_quantity() == 30);
+}
+
+TEST_CASE("quantities that collide with the side bit are rejected",
+          "[order]") {
+  auto max = ds::CompactOrder::max_quantity;
+  REQUIRE(ds::CompactOrder(1, 1, true, max).get_quantity() == max);
+  REQUIRE_THROWS_AS(ds::CompactOrder(1, 1, true, max + 1), std::out_of_range);
+  REQUIRE_THROWS_AS(ds::Order(1, 1, true, -1), std::out_of_range);
+}
+
+// ------ MATCHING -------
+
+TEMPLATE_TEST_CASE("books match identically at every width", "[book]",
+                   ds::Orderbook, ds::CompactOrderbook) {
+  using order = typename TestType::order_type;
+  TestType book;
+  REQUIRE(book.AddOrder(order(1, 100, true, 10)).empty());
+  REQUIRE(book.AddOrder(order(2, 101, true, 5)).empty());
+
+  auto trades = book.AddOrder(order(3, 99, false, 12));
+  REQUIRE(trades.size() == 2);
+  REQUIRE(trades[0].OrderIdA == 2);
+  REQUIRE(trades[0].Size == 5);
+  REQUIRE(trades[0].Level == 99); // the aggressor's price
+  REQUIRE(trades[1].OrderIdA == 1);
+  REQUIRE(trades[1].Size == 7);
+  REQUIRE(trades[1].AggressorOrderId == 3);
+  REQUIRE_FALSE(trades[1].AggressorIsBuy);
+
+  book.CancelOrder(1);
+  REQUIRE(book.AddOrder(order(4, 100, false, 1)).empty());
+}
+
+TEMPLATE_TEST_CASE("cancel keeps time priority of the rest of the level",
+                   "[book]", ds::Orderbook, ds::CompactOrderbook) {
+  using order = typename TestType::order_type;
+  TestType book;
+  book.AddOrder(order(1, 100, true, 10));
+  book.AddOrder(order(2, 100, true, 10));
+  book.AddOrder(order(3, 100, true, 10));
+  book.CancelOrder(2);
+  REQUIRE(book.level_size(true, 100) == 20);
+
+  auto trades = book.AddOrder(order(4, 100, false, 15));
+  REQUIRE(trades.size() == 2);
+  REQUIRE(trades[0].OrderIdA == 1);
+  REQUIRE(trades[1].OrderIdA == 3);
+  REQUIRE(trades[1].Size == 5);
+  REQUIRE(book.level_size(true, 100) == 5);
+  REQUIRE(book.resting_orders() == 1);
+}
+
+// ------ MASS CANCEL -------
+
+TEMPLATE_TEST_CASE("mass cancel removes only the owner's orders", "[book]",
+                   ds::Orderbook, ds::CompactOrderbook) {
+  using order = typename TestType::order_type;
+  TestType book;
+  book.AddOrder(order(1, 100, true, 10), 7);
+  book.AddOrder(order(2, 100, true, 5), 8);
+  book.AddOrder(order(3, 100, true, 10), 7);
+  book.AddOrder(order(4, 99, true, 10), 7);
+  book.AddOrder(order(5, 105, false, 10), 7);
+
+  auto updates = book.MassCancel(7);
+  REQUIRE(updates.size() == 3); // one per level, not per order
+  for (const auto &u : updates) {
+    if (u.IsBuy && u.Level == 100) {
+      REQUIRE(u.Size == 5);
+    } else {
+      REQUIRE(u.Size == 0);
+    }
+  }
+  REQUIRE(book.resting_orders() == 1);
+  REQUIRE(book.level_size(true, 99) == 0);
+  REQUIRE(book.level_size(false, 105) == 0);
+  REQUIRE(book.MassCancel(7).empty());
+
+  // The survivor still trades, and cancelled ids can be reused.
+  auto trades = book.AddOrder(order(1, 100, false, 5), 7);
+  REQUIRE(trades.size() == 1);
+  REQUIRE(trades[0].OrderIdA == 2);
+  REQUIRE(book.resting_orders() == 0);
+}
+
+TEST_CASE("mass cancel skips orders already filled or cancelled", "[book]") {
+  ds::Orderbook book;
+  book.AddOrder(ds::Order(1, 100, true, 10), 1);
+  book.AddOrder(ds::Order(2, 101, true, 10), 1);
+  book.AddOrder(ds::Order(3, 102, true, 10), 1);
+  book.CancelOrder(2);
+  book.AddOrder(ds::Order(4, 102, false, 10), 2); // fills order 3
+  book.AddOrder(ds::Order(5, 100, false, 4), 2);  // partially fills order 1
+
+  auto updates = book.MassCancel(1);
+  REQUIRE(updates.size() == 1);
+  REQUIRE(updates[0].Level == 100);
+  REQUIRE(updates[0].Size == 0);
+  REQUIRE(book.resting_orders() == 0);
+}
+
+// ------ PERSISTENT LEVELS -------
+
+TEST_CASE("persistent levels stay sorted and balanced", "[depth]") {
+  ds::persistent_levels<int> levels;
+  for (int i = 0; i < 1000; ++i) {
+    levels.assign((i * 7919) % 1000, i, 1);
+  }
+  REQUIRE(levels.size() == 1000);
+  for (int i = 0; i < 1000; i += 2) {
+    levels.erase(i);
+  }
+  levels.erase(-1);
+  REQUIRE(levels.size() == 500);
+
+  std::vector<int> prices;
+  levels.for_each([&](const auto &l) { prices.push_back(l.price); });
+  REQUIRE(prices.size() == 500);
+  for (std::size_t i = 0; i < prices.size(); ++i) {
+    REQUIRE(prices[i] == static_cast<int>(2 * i + 1));
+  }
+  REQUIRE(levels.best()->price == 1);
+}
+
+TEST_CASE("copies are unaffected by later writes", "[depth]") {
+  ds::persistent_levels<int, std::greater<>> levels;
+  for (int i = 0; i < 64; ++i) {
+    levels.assign(i, 10, 1);
+  }
+  auto before = levels;
+  levels.assign(5, 99, 2);
+  levels.erase(63);
+  levels.assign(100, 1, 1);
+
+  REQUIRE(before.size() == 64);
+  REQUIRE(before.find(5)->quantity == 10);
+  REQUIRE(before.find(100) == nullptr);
+  REQUIRE(before.best()->price == 63);
+
+  REQUIRE(levels.find(5)->quantity == 99);
+  REQUIRE(levels.find(63) == nullptr);
+  REQUIRE(levels.best()->price == 100);
+}
+
+// ------ SNAPSHOTS -------
+
+TEMPLATE_TEST_CASE("snapshot reflects the book at the time it was taken",
+                   "[depth]", ds::Orderbook, ds::CompactOrderbook) {
+  using order = typename TestType::order_type;
+  TestType book;
+  book.AddOrder(order(1, 100, true, 10));
+  book.AddOrder(order(2, 100, true, 5));
+  book.AddOrder(order(3, 99, true, 7));
+  book.AddOrder(order(4, 102, false, 8));
+  auto snap = book.snapshot();
+
+  book.AddOrder(order(5, 100, false, 12)); // takes 10 then 2 at 100
+  book.CancelOrder(4);
+  auto now = book.snapshot();
+
+  REQUIRE(snap.bids.size() == 2);
+  REQUIRE(snap.bids.best()->price == 100);
+  REQUIRE(snap.bids.best()->quantity == 15);
+  REQUIRE(snap.bids.best()->orders == 2);
+  REQUIRE(snap.asks.best()->price == 102);
+
+  REQUIRE(now.bids.best()->quantity == 3);
+  REQUIRE(now.bids.best()->orders == 1);
+  REQUIRE(now.bids.find(99)->quantity == 7);
+  REQUIRE(now.asks.empty());
+}
+
+TEST_CASE("readers drop snapshots on other threads while the book trades",
+          "[depth]") {
+  ds::Orderbook book;
+  ds::Orderbook::depth_type shared = book.snapshot();
+  std::atomic<bool> published{false};
+  std::atomic<bool> done{false};
+
+  std::thread reader([&] {
+    while (!published.load(std::memory_order_acquire)) {
+    }
+    ds::Orderbook::depth_type snap = std::move(shared);
+    std::int64_t total = 0;
+    while (!done.load(std::memory_order_acquire)) {
+      snap.bids.for_each([&](const auto &l) { total += l.quantity; });
+    }
+    REQUIRE(total >= 0);
+  });
+
+  for (std::size_t i = 0; i < 200; ++i) {
+    book.AddOrder(ds::Order(i, static_cast<long>(900 + i % 50), true, 1));
+  }
+  shared = book.snapshot();
+  published.store(true, std::memory_order_release);
+  for (std::size_t i = 200; i < 20000; ++i) {
+    book.AddOrder(ds::Order(i, static_cast<long>(900 + i % 50), true, 1));
+    book.CancelOrder(i - 100);
+  }
+  done.store(true, std::memory_order_release);
+  reader.join();
+  REQUIRE(book.snapshot().bids.size() == 50);
+}
+
+// ------ STOPS -------
+
+TEMPLATE_TEST_CASE("crossed stops fire in trigger then time order", "[stops]",
+                   ds::Orderbook, ds::CompactOrderbook) {
+  using order = typename TestType::order_type;
+  TestType book;
+  // Liquidity the stops will take.
+  book.AddOrder(order(1, 105, false, 100));
+  REQUIRE(book.AddStopOrder(order(10, 105, true, 1), 103));
+  REQUIRE(book.AddStopOrder(order(11, 105, true, 2), 101));
+  REQUIRE(book.AddStopOrder(order(12, 105, true, 3), 101));
+  REQUIRE(book.AddStopOrder(order(13, 105, true, 4), 106)); // not crossed
+  REQUIRE(book.AddStopOrder(order(14, 90, false, 5), 90));  // other side
+  REQUIRE_FALSE(book.AddStopOrder(order(1, 105, true, 1), 100)); // dup id
+  REQUIRE(book.pending_stops() == 5);
+
+  // A trade at 103 crosses the 101 and 103 buckets.
+  book.AddOrder(order(2, 103, false, 1));
+  auto trades = book.AddOrder(order(3, 103, true, 1));
+  REQUIRE(trades.size() == 4);
+  REQUIRE(trades[0].Level == 103);
+  REQUIRE(trades[1].OrderIdA == 11);
+  REQUIRE(trades[2].OrderIdA == 12);
+  REQUIRE(trades[3].OrderIdA == 10);
+  REQUIRE(book.pending_stops() == 2);
+  REQUIRE(book.level_size(false, 105) == 94);
+}
+
+TEST_CASE("fired stops can fire further stops", "[stops]") {
+  ds::Orderbook book;
+  book.AddOrder(ds::Order(1, 100, true, 10));
+  book.AddOrder(ds::Order(2, 98, true, 10));
+  book.AddOrder(ds::Order(3, 95, true, 10));
+  // Sell stop at 100 sells into 98; the print at 98 fires the stop at 98.
+  book.AddStopOrder(ds::Order(10, 98, false, 10), 100);
+  book.AddStopOrder(ds::Order(11, 95, false, 10), 98);
+
+  auto trades = book.AddOrder(ds::Order(4, 100, false, 10));
+  REQUIRE(trades.size() == 3);
+  REQUIRE(trades[1].AggressorOrderId == 10);
+  REQUIRE(trades[1].Level == 98);
+  REQUIRE(trades[2].AggressorOrderId == 11);
+  REQUIRE(trades[2].Level == 95);
+  REQUIRE(book.pending_stops() == 0);
+  REQUIRE(book.resting_orders() == 0);
+}
+
+TEST_CASE("pending stops can be cancelled singly or by owner", "[stops]") {
+  ds::Orderbook book;
+  book.AddOrder(ds::Order(1, 100, false, 10));
+  book.AddStopOrder(ds::Order(10, 100, true, 1), 100, 5);
+  book.AddStopOrder(ds::Order(11, 100, true, 1), 100, 5);
+  book.AddStopOrder(ds::Order(12, 100, true, 1), 100, 6);
+  book.AddOrder(ds::Order(2, 90, true, 1), 5);
+
+  book.CancelOrder(12);
+  auto updates = book.MassCancel(5);
+  REQUIRE(updates.size() == 1); // only the visible bid
+  REQUIRE(book.pending_stops() == 0);
+
+  auto trades = book.AddOrder(ds::Order(3, 100, true, 1));
+  REQUIRE(trades.size() == 1);
+  REQUIRE(book.level_size(false, 100) == 9);
+}
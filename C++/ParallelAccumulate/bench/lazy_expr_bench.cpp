@@ -0,0 +1,67 @@
+#include "benchmark.hpp"
+#include "lazy_expr.hpp"
+#include "parallel_accumulate.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t elements = std::size_t{1} << 22;
+
+auto odd = [](int x) { return x % 2 != 0; };
+auto square = [](int x) { return static_cast<long long>(x) * x; };
+
+} // namespace
+
+// One op is one "sum of squares of odd values" pass over 4M ints.
+int main(int argc, char **argv) {
+  ds::bench::runner runner(argc, argv, "lazy_expr");
+  ds::thread_pool pool(4);
+  std::vector<int> data(elements);
+  std::iota(data.begin(), data.end(), 0);
+
+  // Today's approach: one vector per step, then parallel_accumulate.
+  runner.add("sum_sq_odd/materialized_pool", [&](ds::bench::state &st) {
+    for (std::size_t i = 0; i < st.iterations(); ++i) {
+      std::vector<int> kept;
+      std::copy_if(data.begin(), data.end(), std::back_inserter(kept), odd);
+      std::vector<long long> squares(kept.size());
+      std::transform(kept.begin(), kept.end(), squares.begin(), square);
+      ds::bench::do_not_optimize(parallel_accumulate_pool(
+          squares.begin(), squares.end(), 0LL, pool));
+    }
+  });
+
+  // What the fused expression should compile down to.
+  runner.add("sum_sq_odd/hand_loop", [&](ds::bench::state &st) {
+    for (std::size_t i = 0; i < st.iterations(); ++i) {
+      long long sum = 0;
+      for (int x : data) {
+        if (odd(x)) {
+          sum += square(x);
+        }
+      }
+      ds::bench::do_not_optimize(sum);
+    }
+  });
+
+  runner.add("sum_sq_odd/fused", [&](ds::bench::state &st) {
+    auto e = ds::lazy::from(data).filter(odd).map(square);
+    for (std::size_t i = 0; i < st.iterations(); ++i) {
+      ds::bench::do_not_optimize(e.reduce(0LL, std::plus<>{}));
+    }
+  });
+
+  runner.add("sum_sq_odd/fused_pool", [&](ds::bench::state &st) {
+    auto e = ds::lazy::from(data).filter(odd).map(square);
+    for (std::size_t i = 0; i < st.iterations(); ++i) {
+      ds::bench::do_not_optimize(e.reduce(pool, 0LL, std::plus<>{}));
+    }
+  });
+
+  return runner.run();
+}
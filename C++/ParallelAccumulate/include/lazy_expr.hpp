@@ -0,0 +1,396 @@
+#pragma once
+
+#include "intrusive_ptr.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ds::lazy {
+
+/*
+ * Lazy range expressions
+ * Builds a pipeline of element-wise steps as nested templates and runs it
+ * in one pass, instead of materialising a vector per step.
+ *
+ *   from(v).filter(odd).map(square).reduce(pool, 0L, std::plus<>{})
+ *
+ *   reduce --> map<filter<source>> --> for i in [first, last):
+ *                                        x = v[i]
+ *                                        if (odd(x)) acc = acc + square(x)
+ *
+ * Every node has feed(first, last, sink), which pushes the elements for
+ * source positions [first, last) into `sink`. Each node wraps the sink of
+ * the node after it, and after inlining the whole expression is a single
+ * index loop the compiler can vectorise. Nothing is stored between steps.
+ *
+ * Nodes that keep a 1:1 mapping from position to element (source, iota,
+ * map, zip, enumerate) are indexable: at(i) computes element i directly,
+ * which zip and enumerate need. filter breaks that mapping, so it can only
+ * be followed by map, filter or a terminal.
+ *
+ * The parallel terminals split [0, extent) into chunks that the calling
+ * thread and the pool workers claim dynamically. Each chunk reduces into
+ * its own cache-line-padded slot, and the slots are combined in chunk
+ * order, so results do not depend on scheduling. The caller works too, so
+ * a terminal called from a pool worker cannot deadlock.
+ *
+ * Expressions hold their source by iterator: the source range must outlive
+ * the expression. Callables are stored by value; pass lambdas or function
+ * objects, since a plain function name decays to a pointer that GCC does
+ * not always inline through the nested sinks.
+ */
+
+template <typename Derived> class expr;
+
+namespace detail {
+
+template <typename T> struct alignas(64) padded {
+  T value;
+};
+
+// Smallest chunk worth handing to another thread.
+inline constexpr std::size_t min_chunk = 4096;
+
+// Runs `body(first, last, chunk)` over [0, n) in chunks claimed by the
+// caller and up to thread_count() pool workers; returns when all are done
+// and rethrows the first exception a chunk threw.
+//
+// The caller waits only for helpers that have started. One still queued
+// when the caller finishes (say, behind the caller itself on a one-thread
+// pool) finds the run closed and leaves; the shared context outlives it.
+template <typename Body>
+void run_chunks(thread_pool &pool, std::size_t n, std::size_t chunk,
+                Body &body) {
+  struct context : intrusive_ref_counter<context, thread_safe_counter> {
+    context(Body &b, std::size_t total, std::size_t size)
+        : body(b), n(total), chunk(size), chunks((total + size - 1) / size) {}
+
+    Body &body;
+    std::size_t n;
+    std::size_t chunk;
+    std::size_t chunks;
+    std::atomic<std::size_t> next{0};
+    std::mutex mutex;
+    std::condition_variable done;
+    std::size_t active{0};
+    bool closed{false};
+    std::exception_ptr error;
+
+    void work() {
+      try {
+        for (std::size_t c = next.fetch_add(1, std::memory_order_relaxed);
+             c < chunks; c = next.fetch_add(1, std::memory_order_relaxed)) {
+          std::size_t first = c * chunk;
+          body(first, std::min(n, first + chunk), c);
+        }
+      } catch (...) {
+        next.store(chunks, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!error) {
+          error = std::current_exception();
+        }
+      }
+    }
+
+    void help() {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (closed) {
+          return;
+        }
+        ++active;
+      }
+      work();
+      std::lock_guard<std::mutex> lock(mutex);
+      if (--active == 0) {
+        done.notify_all();
+      }
+    }
+  };
+
+  auto ctx = make_intrusive<context>(body, n, chunk);
+  const std::size_t helpers = std::min(pool.thread_count(), ctx->chunks - 1);
+  for (std::size_t h = 0; h < helpers; ++h) {
+    // One pointer: std::function keeps it without allocating.
+    intrusive_ptr<context> ref(ctx);
+    pool.post([c = ref.get()] {
+      intrusive_ptr<context> owned(c, false);
+      owned->help();
+    });
+    static_cast<void>(ref.detach());
+  }
+  ctx->work();
+
+  std::unique_lock<std::mutex> lock(ctx->mutex);
+  ctx->closed = true;
+  ctx->done.wait(lock, [&] { return ctx->active == 0; });
+  if (ctx->error) {
+    std::rethrow_exception(ctx->error);
+  }
+}
+
+inline std::size_t chunk_for(const thread_pool &pool, std::size_t n) {
+  const std::size_t target = (pool.thread_count() + 1) * 4;
+  return std::max(min_chunk, (n + target - 1) / target);
+}
+
+} // namespace detail
+
+// ----- NODES -----
+
+template <typename It> class source : public expr<source<It>> {
+public:
+  static constexpr bool indexable = true;
+
+  source(It first, std::size_t n) : first_(first), n_(n) {}
+
+  [[nodiscard]] std::size_t extent() const noexcept { return n_; }
+  [[nodiscard]] decltype(auto) at(std::size_t i) const {
+    return first_[static_cast<std::iter_difference_t<It>>(i)];
+  }
+  template <typename Sink>
+  void feed(std::size_t first, std::size_t last, Sink &sink) const {
+    for (std::size_t i = first; i < last; ++i) {
+      sink(at(i));
+    }
+  }
+
+private:
+  It first_;
+  std::size_t n_;
+};
+
+template <typename I> class iota_source : public expr<iota_source<I>> {
+public:
+  static constexpr bool indexable = true;
+
+  iota_source(I first, I last)
+      : first_(first),
+        n_(last > first ? static_cast<std::size_t>(last - first) : 0) {}
+
+  [[nodiscard]] std::size_t extent() const noexcept { return n_; }
+  [[nodiscard]] I at(std::size_t i) const {
+    return static_cast<I>(first_ + static_cast<I>(i));
+  }
+  template <typename Sink>
+  void feed(std::size_t first, std::size_t last, Sink &sink) const {
+    for (std::size_t i = first; i < last; ++i) {
+      sink(at(i));
+    }
+  }
+
+private:
+  I first_;
+  std::size_t n_;
+};
+
+template <typename E, typename F> class map_expr : public expr<map_expr<E, F>> {
+public:
+  static constexpr bool indexable = E::indexable;
+
+  map_expr(E e, F f) : e_(std::move(e)), f_(std::move(f)) {}
+
+  [[nodiscard]] std::size_t extent() const noexcept { return e_.extent(); }
+  [[nodiscard]] decltype(auto) at(std::size_t i) const
+    requires E::indexable
+  {
+    return std::invoke(f_, e_.at(i));
+  }
+  template <typename Sink>
+  void feed(std::size_t first, std::size_t last, Sink &sink) const {
+    auto mapped = [&](auto &&v) {
+      sink(std::invoke(f_, std::forward<decltype(v)>(v)));
+    };
+    e_.feed(first, last, mapped);
+  }
+
+private:
+  E e_;
+  F f_;
+};
+
+template <typename E, typename P>
+class filter_expr : public expr<filter_expr<E, P>> {
+public:
+  static constexpr bool indexable = false;
+
+  filter_expr(E e, P p) : e_(std::move(e)), p_(std::move(p)) {}
+
+  [[nodiscard]] std::size_t extent() const noexcept { return e_.extent(); }
+  template <typename Sink>
+  void feed(std::size_t first, std::size_t last, Sink &sink) const {
+    auto kept = [&](auto &&v) {
+      if (std::invoke(p_, std::as_const(v))) {
+        sink(std::forward<decltype(v)>(v));
+      }
+    };
+    e_.feed(first, last, kept);
+  }
+
+private:
+  E e_;
+  P p_;
+};
+
+template <typename A, typename B> class zip_expr : public expr<zip_expr<A, B>> {
+public:
+  static constexpr bool indexable = true;
+
+  zip_expr(A a, B b) : a_(std::move(a)), b_(std::move(b)) {}
+
+  // The shorter side sets the length.
+  [[nodiscard]] std::size_t extent() const noexcept {
+    return std::min(a_.extent(), b_.extent());
+  }
+  [[nodiscard]] auto at(std::size_t i) const {
+    return std::pair<decltype(a_.at(i)), decltype(b_.at(i))>(a_.at(i),
+                                                              b_.at(i));
+  }
+  template <typename Sink>
+  void feed(std::size_t first, std::size_t last, Sink &sink) const {
+    for (std::size_t i = first; i < last; ++i) {
+      sink(at(i));
+    }
+  }
+
+private:
+  A a_;
+  B b_;
+};
+
+template <typename E> class enumerate_expr : public expr<enumerate_expr<E>> {
+public:
+  static constexpr bool indexable = true;
+
+  explicit enumerate_expr(E e) : e_(std::move(e)) {}
+
+  [[nodiscard]] std::size_t extent() const noexcept { return e_.extent(); }
+  [[nodiscard]] auto at(std::size_t i) const {
+    return std::pair<std::size_t, decltype(e_.at(i))>(i, e_.at(i));
+  }
+  template <typename Sink>
+  void feed(std::size_t first, std::size_t last, Sink &sink) const {
+    for (std::size_t i = first; i < last; ++i) {
+      sink(at(i));
+    }
+  }
+
+private:
+  E e_;
+};
+
+// ----- BUILDERS AND TERMINALS -----
+
+template <typename Derived> class expr {
+public:
+  template <typename F> [[nodiscard]] auto map(F f) const {
+    return map_expr<Derived, F>(self(), std::move(f));
+  }
+
+  template <typename P> [[nodiscard]] auto filter(P p) const {
+    return filter_expr<Derived, P>(self(), std::move(p));
+  }
+
+  // Pairs elements position by position.
+  template <typename Other> [[nodiscard]] auto zip(const Other &other) const {
+    static_assert(Derived::indexable && Other::indexable,
+                  "zip needs indexable expressions; filter last");
+    return zip_expr<Derived, Other>(self(), other);
+  }
+
+  // Pairs each element with its source position.
+  [[nodiscard]] auto enumerate() const {
+    static_assert(Derived::indexable,
+                  "enumerate needs an indexable expression; filter last");
+    return enumerate_expr<Derived>(self());
+  }
+
+  // Folds every element into `identity` with op(T, element) -> T.
+  template <typename T, typename Op> [[nodiscard]] T reduce(T identity, Op op) const {
+    T acc = std::move(identity);
+    auto step = [&](auto &&v) {
+      acc = op(std::move(acc), std::forward<decltype(v)>(v));
+    };
+    self().feed(0, self().extent(), step);
+    return acc;
+  }
+
+  // Parallel fold: every chunk starts from `identity`, so it must be
+  // neutral for `op`, and op must be associative and also accept (T, T)
+  // to combine chunks.
+  template <typename T, typename Op>
+  [[nodiscard]] T reduce(thread_pool &pool, T identity, Op op) const {
+    const std::size_t n = self().extent();
+    const std::size_t chunk = detail::chunk_for(pool, n);
+    if (n <= chunk) {
+      return reduce(std::move(identity), std::move(op));
+    }
+    std::vector<detail::padded<T>> partials((n + chunk - 1) / chunk,
+                                            detail::padded<T>{identity});
+    auto body = [&](std::size_t first, std::size_t last, std::size_t c) {
+      T acc = identity;
+      auto step = [&](auto &&v) {
+        acc = op(std::move(acc), std::forward<decltype(v)>(v));
+      };
+      self().feed(first, last, step);
+      partials[c].value = std::move(acc);
+    };
+    detail::run_chunks(pool, n, chunk, body);
+
+    T result = std::move(identity);
+    for (auto &p : partials) {
+      result = op(std::move(result), std::move(p.value));
+    }
+    return result;
+  }
+
+  template <typename F> void for_each(F f) const {
+    self().feed(0, self().extent(), f);
+  }
+
+  // Calls `f` concurrently from several threads.
+  template <typename F> void for_each(thread_pool &pool, F f) const {
+    const std::size_t n = self().extent();
+    const std::size_t chunk = detail::chunk_for(pool, n);
+    if (n <= chunk) {
+      for_each(std::move(f));
+      return;
+    }
+    auto body = [&](std::size_t first, std::size_t last, std::size_t) {
+      self().feed(first, last, f);
+    };
+    detail::run_chunks(pool, n, chunk, body);
+  }
+
+private:
+  [[nodiscard]] const Derived &self() const noexcept {
+    return static_cast<const Derived &>(*this);
+  }
+};
+
+// ----- SOURCES -----
+
+// Any random-access range; it must outlive the expression.
+template <std::ranges::random_access_range R> [[nodiscard]] auto from(R &range) {
+  using It = std::ranges::iterator_t<R>;
+  return source<It>(std::ranges::begin(range),
+                    static_cast<std::size_t>(std::ranges::size(range)));
+}
+
+// The integers [first, last).
+template <std::integral I> [[nodiscard]] auto iota(I first, I last) {
+  return iota_source<I>(first, last);
+}
+
+} // namespace ds::lazy
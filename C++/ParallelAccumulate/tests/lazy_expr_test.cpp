@@ -0,0 +1,138 @@
+#include "lazy_expr.hpp"
+#include "require_no_alloc.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+std::vector<int> values(std::size_t n) {
+  std::vector<int> v(n);
+  std::iota(v.begin(), v.end(), 0);
+  return v;
+}
+
+auto odd = [](int x) { return x % 2 != 0; };
+auto square = [](int x) { return static_cast<long long>(x) * x; };
+
+} // namespace
+
+// ------ FUSED EXPRESSIONS -------
+
+TEST_CASE("sum of squares of filtered values", "[lazy]") {
+  ds::thread_pool pool(3);
+  for (std::size_t n : {0u, 1u, 1000u, 1'000'003u}) {
+    auto v = values(n);
+    long long expected = 0;
+    for (int x : v) {
+      if (odd(x)) {
+        expected += square(x);
+      }
+    }
+    auto e = ds::lazy::from(v).filter(odd).map(square);
+    REQUIRE(e.reduce(0LL, std::plus<>{}) == expected);
+    REQUIRE(e.reduce(pool, 0LL, std::plus<>{}) == expected);
+  }
+}
+
+TEST_CASE("steps compose in any order", "[lazy]") {
+  auto v = values(100);
+  auto e = ds::lazy::from(v)
+               .map([](int x) { return x * 3; })
+               .filter([](int x) { return x % 2 == 0; })
+               .map([](int x) { return x + 1; })
+               .filter([](int x) { return x > 50; });
+  std::vector<int> seen;
+  e.for_each([&](int x) { seen.push_back(x); });
+  REQUIRE(seen.size() == 41);
+  REQUIRE(seen.front() == 55);
+  REQUIRE(seen.back() == 295);
+}
+
+TEST_CASE("zip pairs positions and stops at the shorter side", "[lazy]") {
+  ds::thread_pool pool(2);
+  std::vector<double> a(200'000), b(150'000);
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    a[i] = static_cast<double>(i % 7);
+  }
+  for (std::size_t i = 0; i < b.size(); ++i) {
+    b[i] = static_cast<double>(i % 5);
+  }
+  double expected = 0;
+  for (std::size_t i = 0; i < b.size(); ++i) {
+    expected += a[i] * b[i];
+  }
+  auto dot = ds::lazy::from(a).zip(ds::lazy::from(b)).map([](auto p) {
+    return p.first * p.second;
+  });
+  REQUIRE(dot.extent() == b.size());
+  // Small integers: every partial sum is exact, whatever the chunking.
+  REQUIRE(dot.reduce(0.0, std::plus<>{}) == expected);
+  REQUIRE(dot.reduce(pool, 0.0, std::plus<>{}) == expected);
+}
+
+TEST_CASE("enumerate gives source positions", "[lazy]") {
+  ds::thread_pool pool(3);
+  std::vector<int> v(100'000, 2);
+  std::vector<long long> out(v.size());
+  ds::lazy::from(v).enumerate().for_each(pool, [&](auto p) {
+    out[p.first] = static_cast<long long>(p.first) * p.second;
+  });
+  for (std::size_t i = 0; i < out.size(); i += 997) {
+    REQUIRE(out[i] == static_cast<long long>(2 * i));
+  }
+
+  // Positions survive a later filter.
+  auto picked = ds::lazy::from(v)
+                    .enumerate()
+                    .filter([](auto p) { return p.first % 1000 == 0; })
+                    .reduce(std::size_t{0}, [](std::size_t acc, auto p) {
+                      return acc + p.first;
+                    });
+  REQUIRE(picked == 4'950'000);
+}
+
+TEST_CASE("iota is a source without storage", "[lazy]") {
+  ds::thread_pool pool(2);
+  auto evens = ds::lazy::iota(0L, 1'000'000L).filter([](long x) {
+    return x % 2 == 0;
+  });
+  REQUIRE(evens.reduce(pool, 0L, std::plus<>{}) == 249'999'500'000L);
+  REQUIRE(ds::lazy::iota(5, 3).reduce(7, std::plus<>{}) == 7);
+}
+
+// ------ EXECUTION -------
+
+TEST_CASE("a fused pass allocates nothing", "[lazy][alloc]") {
+  auto v = values(10'000);
+  long long sum = 0;
+  REQUIRE_NO_ALLOC {
+    sum = ds::lazy::from(v).filter(odd).map(square).reduce(0LL,
+                                                           std::plus<>{});
+  }
+  REQUIRE(sum > 0);
+}
+
+TEST_CASE("parallel terminals run from a pool worker", "[lazy]") {
+  ds::thread_pool pool(1);
+  auto v = values(500'000);
+  auto e = ds::lazy::from(v).map(square);
+  long long total = pool.submit([&] {
+                          return e.reduce(pool, 0LL, std::plus<>{});
+                        }).get();
+  REQUIRE(total == e.reduce(0LL, std::plus<>{}));
+}
+
+TEST_CASE("a throwing step surfaces from the terminal", "[lazy]") {
+  ds::thread_pool pool(2);
+  auto v = values(300'000);
+  auto e = ds::lazy::from(v).map([](int x) {
+    if (x == 250'000) {
+      throw std::domain_error("bad value");
+    }
+    return x;
+  });
+  REQUIRE_THROWS_AS(e.reduce(pool, 0LL, std::plus<>{}), std::domain_error);
+}
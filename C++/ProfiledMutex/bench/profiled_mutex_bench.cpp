@@ -0,0 +1,31 @@
+#include "benchmark.hpp"
+#include "profiled_mutex.hpp"
+#include <mutex>
+
+namespace {
+
+template <typename Mutex> void lock_unlock(ds::bench::state &st, Mutex &m) {
+  for (std::size_t i = 0; i < st.iterations(); ++i) {
+    m.lock();
+    ds::bench::clobber_memory();
+    m.unlock();
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  ds::bench::runner runner(argc, argv, "profiled_mutex");
+
+  runner.add("uncontended/std_mutex", [](ds::bench::state &st) {
+    std::mutex m;
+    lock_unlock(st, m);
+  });
+
+  runner.add("uncontended/profiled_mutex", [](ds::bench::state &st) {
+    ds::profiled_mutex m("bench::uncontended");
+    lock_unlock(st, m);
+  });
+
+  return runner.run();
+}
@@ -0,0 +1,296 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace ds {
+
+/*
+ * profiled_mutex
+ * Drop-in mutex that records, per named lock site:
+ *
+ *   acquisitions   successful lock()/try_lock() calls
+ *   contended      lock() calls that found the mutex held (and timed
+ *                  try_lock_for/until calls that gave up)
+ *   wait time      time spent blocked in those calls
+ *   max hold       longest stretch between acquire and unlock
+ *
+ * Uncontended path: one try_lock on the underlying mutex, two timestamp
+ * reads (rdtsc where available) and plain stores into counters owned by the
+ * mutex. Only the holder writes acquisitions and max hold, so they need no
+ * read-modify-write; the contended path is already slow and uses fetch_add.
+ * The timestamps dominate the overhead: a few ns each on bare metal, more
+ * where the hypervisor traps rdtsc (see PROFILEDMUTEX_bench).
+ *
+ * Every mutex registers its counters with the lock_registry under a site
+ * name. Mutexes sharing a name are reported together, and a destroyed
+ * mutex's counts are folded into its site so they survive the object.
+ */
+
+namespace detail {
+
+inline std::uint64_t lock_ticks() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+#endif
+}
+
+// Measured once, on the first report; the lock path never converts.
+inline double ns_per_lock_tick() {
+#if defined(__x86_64__) || defined(__i386__)
+  static const double value = [] {
+    using clock = std::chrono::steady_clock;
+    auto start = clock::now();
+    std::uint64_t ticks = lock_ticks();
+    while (clock::now() - start < std::chrono::milliseconds(2)) {
+    }
+    double ns = std::chrono::duration<double, std::nano>(clock::now() - start)
+                    .count();
+    return ns / static_cast<double>(lock_ticks() - ticks);
+  }();
+  return value;
+#else
+  return 1.0;
+#endif
+}
+
+struct alignas(64) lock_counters {
+  std::atomic<std::uint64_t> acquisitions{0};
+  std::atomic<std::uint64_t> contended{0};
+  std::atomic<std::uint64_t> wait_ticks{0};
+  std::atomic<std::uint64_t> max_hold_ticks{0};
+};
+
+} // namespace detail
+
+struct lock_site_stats {
+  std::string name;
+  std::uint64_t acquisitions{0};
+  std::uint64_t contended{0};
+  double wait_ns{0.0};
+  double max_hold_ns{0.0};
+};
+
+class lock_registry {
+public:
+  // Leaked so mutexes with static storage can still detach during exit.
+  static lock_registry &instance() {
+    static auto *registry = new lock_registry();
+    return *registry;
+  }
+
+  // One entry per site, most contended first (ties broken by wait time).
+  [[nodiscard]] std::vector<lock_site_stats> report() const {
+    double scale = detail::ns_per_lock_tick();
+    std::vector<lock_site_stats> out;
+    std::lock_guard<std::mutex> lock(mutex_);
+    out.reserve(sites_.size());
+    for (const auto &s : sites_) {
+      lock_site_stats stats{s->name, s->acquisitions, s->contended, 0.0, 0.0};
+      std::uint64_t wait = s->wait_ticks;
+      std::uint64_t max_hold = s->max_hold_ticks;
+      for (const detail::lock_counters *c : s->live) {
+        stats.acquisitions += c->acquisitions.load(std::memory_order_relaxed);
+        stats.contended += c->contended.load(std::memory_order_relaxed);
+        wait += c->wait_ticks.load(std::memory_order_relaxed);
+        max_hold = std::max(max_hold,
+                            c->max_hold_ticks.load(std::memory_order_relaxed));
+      }
+      stats.wait_ns = static_cast<double>(wait) * scale;
+      stats.max_hold_ns = static_cast<double>(max_hold) * scale;
+      out.push_back(std::move(stats));
+    }
+    std::sort(out.begin(), out.end(), [](const auto &a, const auto &b) {
+      return a.contended != b.contended ? a.contended > b.contended
+                                        : a.wait_ns > b.wait_ns;
+    });
+    return out;
+  }
+
+  void dump(std::ostream &out) const {
+    char line[200];
+    std::snprintf(line, sizeof(line), "%-32s %14s %12s %8s %12s %14s\n",
+                  "lock site", "acquisitions", "contended", "cont %",
+                  "wait ms", "max hold us");
+    out << line;
+    for (const auto &s : report()) {
+      double pct = s.acquisitions == 0
+                       ? 0.0
+                       : 100.0 * static_cast<double>(s.contended) /
+                             static_cast<double>(s.acquisitions);
+      std::snprintf(line, sizeof(line),
+                    "%-32s %14llu %12llu %8.2f %12.3f %14.3f\n",
+                    s.name.c_str(),
+                    static_cast<unsigned long long>(s.acquisitions),
+                    static_cast<unsigned long long>(s.contended), pct,
+                    s.wait_ns / 1e6, s.max_hold_ns / 1e3);
+      out << line;
+    }
+  }
+
+  // Zeroes every site, live mutexes included.
+  void reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto &s : sites_) {
+      s->acquisitions = s->contended = s->wait_ticks = s->max_hold_ticks = 0;
+      for (detail::lock_counters *c : s->live) {
+        c->acquisitions.store(0, std::memory_order_relaxed);
+        c->contended.store(0, std::memory_order_relaxed);
+        c->wait_ticks.store(0, std::memory_order_relaxed);
+        c->max_hold_ticks.store(0, std::memory_order_relaxed);
+      }
+    }
+  }
+
+private:
+  template <typename Mutex> friend class basic_profiled_mutex;
+
+  struct site {
+    std::string name;
+    std::uint64_t acquisitions{0};
+    std::uint64_t contended{0};
+    std::uint64_t wait_ticks{0};
+    std::uint64_t max_hold_ticks{0};
+    std::vector<detail::lock_counters *> live;
+  };
+
+  lock_registry() = default;
+
+  site *attach(std::string_view name, detail::lock_counters *counters) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::find_if(sites_.begin(), sites_.end(),
+                           [&](const auto &s) { return s->name == name; });
+    if (it == sites_.end()) {
+      sites_.push_back(std::make_unique<site>());
+      sites_.back()->name = name;
+      it = sites_.end() - 1;
+    }
+    (*it)->live.push_back(counters);
+    return it->get();
+  }
+
+  void detach(site *s, detail::lock_counters *counters) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    s->acquisitions += counters->acquisitions.load(std::memory_order_relaxed);
+    s->contended += counters->contended.load(std::memory_order_relaxed);
+    s->wait_ticks += counters->wait_ticks.load(std::memory_order_relaxed);
+    s->max_hold_ticks =
+        std::max(s->max_hold_ticks,
+                 counters->max_hold_ticks.load(std::memory_order_relaxed));
+    std::erase(s->live, counters);
+  }
+
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<site>> sites_;
+};
+
+template <typename Mutex> class basic_profiled_mutex {
+public:
+  explicit basic_profiled_mutex(std::string_view site = "unnamed")
+      : site_(lock_registry::instance().attach(site, &counters_)) {}
+
+  ~basic_profiled_mutex() {
+    lock_registry::instance().detach(site_, &counters_);
+  }
+
+  basic_profiled_mutex(const basic_profiled_mutex &) = delete;
+  basic_profiled_mutex &operator=(const basic_profiled_mutex &) = delete;
+
+  // ----- LOCKABLE -----
+  void lock() {
+    if (!mutex_.try_lock()) {
+      std::uint64_t start = detail::lock_ticks();
+      mutex_.lock();
+      record_wait(start);
+    }
+    acquired();
+  }
+
+  bool try_lock() {
+    if (!mutex_.try_lock()) {
+      return false;
+    }
+    acquired();
+    return true;
+  }
+
+  void unlock() {
+    std::uint64_t held = detail::lock_ticks() - hold_start_;
+    if (held > counters_.max_hold_ticks.load(std::memory_order_relaxed)) {
+      counters_.max_hold_ticks.store(held, std::memory_order_relaxed);
+    }
+    mutex_.unlock();
+  }
+
+  // ----- TIMED LOCKABLE (when Mutex is) -----
+  template <typename Rep, typename Period>
+  bool try_lock_for(const std::chrono::duration<Rep, Period> &timeout)
+    requires requires(Mutex m) { m.try_lock_for(timeout); }
+  {
+    return timed([&] { return mutex_.try_lock_for(timeout); });
+  }
+
+  template <typename Clock, typename Duration>
+  bool try_lock_until(const std::chrono::time_point<Clock, Duration> &deadline)
+    requires requires(Mutex m) { m.try_lock_until(deadline); }
+  {
+    return timed([&] { return mutex_.try_lock_until(deadline); });
+  }
+
+private:
+  void acquired() {
+    counters_.acquisitions.store(
+        counters_.acquisitions.load(std::memory_order_relaxed) + 1,
+        std::memory_order_relaxed);
+    hold_start_ = detail::lock_ticks();
+  }
+
+  void record_wait(std::uint64_t start) {
+    counters_.contended.fetch_add(1, std::memory_order_relaxed);
+    counters_.wait_ticks.fetch_add(detail::lock_ticks() - start,
+                                   std::memory_order_relaxed);
+  }
+
+  template <typename Attempt> bool timed(Attempt attempt) {
+    if (mutex_.try_lock()) {
+      acquired();
+      return true;
+    }
+    std::uint64_t start = detail::lock_ticks();
+    bool locked = attempt();
+    record_wait(start);
+    if (locked) {
+      acquired();
+    }
+    return locked;
+  }
+
+  Mutex mutex_;
+  std::uint64_t hold_start_{0};
+  detail::lock_counters counters_;
+  lock_registry::site *site_;
+};
+
+using profiled_mutex = basic_profiled_mutex<std::mutex>;
+using profiled_timed_mutex = basic_profiled_mutex<std::timed_mutex>;
+
+} // namespace ds
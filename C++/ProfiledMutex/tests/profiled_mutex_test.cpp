@@ -0,0 +1,140 @@
+#include "latch.hpp"
+#include "profiled_mutex.hpp"
+#include "thread_safe_queue.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+ds::lock_site_stats site_stats(const std::string &name) {
+  for (auto &s : ds::lock_registry::instance().report()) {
+    if (s.name == name) {
+      return s;
+    }
+  }
+  return {};
+}
+
+} // namespace
+
+// ------ COUNTING -------
+
+TEST_CASE("uncontended acquisitions are counted", "[profiled_mutex]") {
+  ds::profiled_mutex m("test::uncontended");
+  for (int i = 0; i < 100; ++i) {
+    std::lock_guard<ds::profiled_mutex> lock(m);
+  }
+  REQUIRE(m.try_lock());
+  m.unlock();
+
+  auto s = site_stats("test::uncontended");
+  REQUIRE(s.acquisitions == 101);
+  REQUIRE(s.contended == 0);
+  REQUIRE(s.wait_ns == 0.0);
+}
+
+TEST_CASE("blocked lock() counts as contended with wait time",
+          "[profiled_mutex]") {
+  ds::profiled_mutex m("test::contended");
+  m.lock();
+  std::thread waiter([&] {
+    std::lock_guard<ds::profiled_mutex> lock(m);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  m.unlock();
+  waiter.join();
+
+  auto s = site_stats("test::contended");
+  REQUIRE(s.acquisitions == 2);
+  REQUIRE(s.contended == 1);
+  REQUIRE(s.wait_ns > 1e6);
+  REQUIRE(s.max_hold_ns > 1e6);
+}
+
+TEST_CASE("timed try_lock that gives up is still contention",
+          "[profiled_mutex]") {
+  ds::profiled_timed_mutex m("test::timed");
+  m.lock();
+  std::thread other([&] {
+    REQUIRE_FALSE(m.try_lock_for(std::chrono::milliseconds(5)));
+  });
+  other.join();
+  m.unlock();
+
+  auto s = site_stats("test::timed");
+  REQUIRE(s.acquisitions == 1);
+  REQUIRE(s.contended == 1);
+}
+
+// ------ REGISTRY -------
+
+TEST_CASE("sites aggregate and outlive their mutexes", "[registry]") {
+  {
+    ds::profiled_mutex a("test::shared_site");
+    ds::profiled_mutex b("test::shared_site");
+    a.lock();
+    a.unlock();
+    b.lock();
+    b.unlock();
+  }
+  REQUIRE(site_stats("test::shared_site").acquisitions == 2);
+}
+
+TEST_CASE("report is sorted by contention", "[registry]") {
+  ds::profiled_mutex hot("test::hot");
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < 2000; ++i) {
+        std::lock_guard<ds::profiled_mutex> lock(hot);
+      }
+    });
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+
+  auto report = ds::lock_registry::instance().report();
+  for (std::size_t i = 1; i < report.size(); ++i) {
+    REQUIRE(report[i - 1].contended >= report[i].contended);
+  }
+  REQUIRE(site_stats("test::hot").acquisitions == 8000);
+
+  std::ostringstream out;
+  ds::lock_registry::instance().dump(out);
+  REQUIRE(out.str().find("test::hot") != std::string::npos);
+}
+
+// ------ USERS -------
+
+TEST_CASE("profiled thread_safe_queue reports its lock site", "[users]") {
+  auto before = site_stats("thread_safe_queue").acquisitions;
+  ds::profiled_thread_safe_queue<int> q;
+  std::thread consumer([&] {
+    int value = 0;
+    for (int i = 0; i < 100; ++i) {
+      q.wait_and_pop(value);
+    }
+  });
+  for (int i = 0; i < 100; ++i) {
+    q.push(i);
+  }
+  consumer.join();
+  REQUIRE(site_stats("thread_safe_queue").acquisitions >= before + 200);
+}
+
+TEST_CASE("profiled CountDownLatch reports its lock site", "[users]") {
+  auto before = site_stats("CountDownLatch").acquisitions;
+  ProfiledCountDownLatch latch(2);
+  std::thread worker([&] { latch.count_down(); });
+  latch.count_down();
+  latch.wait();
+  worker.join();
+  REQUIRE(latch.is_done());
+  REQUIRE(site_stats("CountDownLatch").acquisitions >= before + 4);
+}
@@ -0,0 +1,56 @@
+#include "atomic_unique_ptr.hpp"
+#include "benchmark.hpp"
+#include "epoch_reclamation.hpp"
+#include "hazard_pointers.hpp"
+#include <atomic>
+
+int main(int argc, char **argv) {
+  ds::bench::runner runner(argc, argv, "reclamation");
+
+  runner.add("epoch/pin_unpin", [](ds::bench::state &st) {
+    ds::epoch_domain domain;
+    for (std::size_t i = 0; i < st.iterations(); ++i) {
+      auto guard = domain.pin();
+      ds::bench::clobber_memory();
+    }
+  });
+
+  runner.add("epoch/retire", [](ds::bench::state &st) {
+    ds::epoch_domain domain;
+    for (std::size_t i = 0; i < st.iterations(); ++i) {
+      domain.retire(new int(0));
+    }
+    domain.collect();
+  });
+
+  runner.add("hazard/protect_reset", [](ds::bench::state &st) {
+    ds::hazard_domain domain;
+    int value = 0;
+    std::atomic<int *> source{&value};
+    auto hp = domain.make_hazard_pointer();
+    for (std::size_t i = 0; i < st.iterations(); ++i) {
+      ds::bench::do_not_optimize(hp.protect(source));
+      hp.reset();
+    }
+  });
+
+  runner.add("atomic_unique_ptr/read", [](ds::bench::state &st) {
+    ds::epoch_domain domain;
+    ds::atomic_unique_ptr<int> p(ds::unique_ptr<int>(new int(1)), domain);
+    for (std::size_t i = 0; i < st.iterations(); ++i) {
+      auto handle = p.read();
+      ds::bench::do_not_optimize(*handle);
+    }
+  });
+
+  runner.add("atomic_unique_ptr/exchange", [](ds::bench::state &st) {
+    ds::epoch_domain domain;
+    ds::atomic_unique_ptr<int> p(domain);
+    for (std::size_t i = 0; i < st.iterations(); ++i) {
+      auto old = p.exchange(ds::unique_ptr<int>(new int(1)));
+      ds::bench::do_not_optimize(old.get());
+    }
+  });
+
+  return runner.run();
+}
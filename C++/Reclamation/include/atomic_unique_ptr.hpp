@@ -0,0 +1,127 @@
+#pragma once
+
+#include "epoch_reclamation.hpp"
+#include "unique_ptr.hpp"
+
+#include <atomic>
+#include <utility>
+
+/*
+ * atomic_unique_ptr<T>
+ * A single-owner slot for publishing immutable objects (configs, routing
+ * tables, book snapshots) from a writer to many readers.
+ *
+ *   writer: build new T -> store()/exchange() -> old value retired
+ *   reader: read() -> pin epoch, load pointer -> use -> unpin
+ *
+ * Readers never block and never touch a reference count: a read is one
+ * epoch announcement plus one acquire load. The slot owns whatever it points
+ * to; a replaced value is handed to the epoch domain and freed only after
+ * every reader that could have loaded it has unpinned.
+ */
+
+namespace ds {
+
+// Deleter for values that have left an atomic_unique_ptr: instead of deleting
+// immediately it retires into the domain, since readers may still hold them.
+template <typename T> struct retire_delete {
+  void operator()(T *pointer) const { domain->retire(pointer); }
+  epoch_domain *domain{&default_epoch_domain()};
+};
+
+template <typename T> using retired_ptr = ds::unique_ptr<T, retire_delete<T>>;
+
+template <typename T> class atomic_unique_ptr {
+public:
+  // Pinned view of the current value; valid for as long as it is alive.
+  class read_handle {
+  public:
+    [[nodiscard]] const T *get() const noexcept { return pointer_; }
+    const T &operator*() const noexcept { return *pointer_; }
+    const T *operator->() const noexcept { return pointer_; }
+    explicit operator bool() const noexcept { return pointer_ != nullptr; }
+
+  private:
+    friend class atomic_unique_ptr;
+    read_handle(epoch_domain::guard guard, const T *pointer)
+        : guard_(std::move(guard)), pointer_(pointer) {}
+
+    epoch_domain::guard guard_;
+    const T *pointer_;
+  };
+
+  explicit atomic_unique_ptr(epoch_domain &domain = default_epoch_domain())
+      : domain_(domain) {}
+
+  explicit atomic_unique_ptr(ds::unique_ptr<T> initial,
+                             epoch_domain &domain = default_epoch_domain())
+      : domain_(domain), pointer_(initial.release()) {}
+
+  ~atomic_unique_ptr() {
+    if (T *p = pointer_.load(std::memory_order_acquire)) {
+      domain_.retire(p);
+    }
+  }
+
+  atomic_unique_ptr(const atomic_unique_ptr &) = delete;
+  atomic_unique_ptr &operator=(const atomic_unique_ptr &) = delete;
+  atomic_unique_ptr(atomic_unique_ptr &&) = delete;
+  atomic_unique_ptr &operator=(atomic_unique_ptr &&) = delete;
+
+  // ----- READER API -----
+
+  [[nodiscard]] read_handle read() const {
+    auto guard = domain_.pin();
+    return read_handle(std::move(guard),
+                       pointer_.load(std::memory_order_acquire));
+  }
+
+  // For callers that already hold a guard across several loads.
+  [[nodiscard]] const T *load(const epoch_domain::guard &) const noexcept {
+    return pointer_.load(std::memory_order_acquire);
+  }
+
+  // ----- WRITER API -----
+
+  // Publish desired; the previous value is retired.
+  void store(ds::unique_ptr<T> desired) {
+    T *old = pointer_.exchange(desired.release(), std::memory_order_acq_rel);
+    if (old != nullptr) {
+      domain_.retire(old);
+    }
+  }
+
+  // Publish desired and take over the previous value. Readers may still be
+  // looking at it, so it can only be read, and it is retired (not deleted)
+  // when the returned pointer goes away.
+  [[nodiscard]] retired_ptr<T> exchange(ds::unique_ptr<T> desired) {
+    T *old = pointer_.exchange(desired.release(), std::memory_order_acq_rel);
+    return retired_ptr<T>(old, retire_delete<T>{&domain_});
+  }
+
+  // Publish desired only if the slot still holds expected. On success
+  // desired is consumed and expected's object retired; on failure expected is
+  // updated to the current value and desired is left untouched.
+  bool compare_exchange(const T *&expected, ds::unique_ptr<T> &desired) {
+    T *current = const_cast<T *>(expected);
+    if (pointer_.compare_exchange_strong(current, desired.get(),
+                                         std::memory_order_acq_rel,
+                                         std::memory_order_acquire)) {
+      desired.release();
+      if (current != nullptr) {
+        domain_.retire(current);
+      }
+      return true;
+    }
+    expected = current;
+    return false;
+  }
+
+  [[nodiscard]] epoch_domain &domain() const noexcept { return domain_; }
+
+private:
+  epoch_domain &domain_;
+  std::atomic<T *> pointer_{nullptr};
+};
+
+} // namespace ds
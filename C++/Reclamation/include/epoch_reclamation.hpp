@@ -0,0 +1,310 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/*
+ * Epoch-based reclamation (EBR)
+ *
+ * Lock-free containers unlink a node with a CAS, but another thread may still
+ * be reading it. EBR defers the free until every such reader has moved on:
+ *
+ * 1) a global epoch counter E
+ * 2) each thread announces the epoch it saw when it pins (enters a read-side
+ *    critical section) and announces "idle" when it unpins
+ * 3) an unlinked node is retired into the calling thread's list, tagged with
+ *    the epoch at retirement
+ * 4) E can only move from e to e+1 once every pinned thread has announced e
+ * 5) a node retired in epoch r is therefore unreachable once E >= r + 2
+ *
+ *   retire(n) @ r     E = r + 1            E = r + 2
+ *   ---------+-------------+-------------------+----------> free(n)
+ *            readers that could still see n have all unpinned
+ *
+ * Reads only touch thread-local state plus one store and a fence on pin; no
+ * read-modify-write on shared memory. Freeing is batched: a thread scans its
+ * retire list once it holds `collect_threshold` entries.
+ *
+ * Garbage is unbounded while a thread stays pinned; hazard_pointers.hpp has the
+ * bounded alternative.
+ */
+
+namespace ds {
+
+namespace detail {
+
+// Full store-load barrier. GCC rejects atomic_thread_fence under
+// -fsanitize=thread, so TSAN builds use a seq_cst read-modify-write
+// instead, which is a full barrier on the x86 hosts TSAN runs on.
+inline void store_load_fence() noexcept {
+#if defined(__SANITIZE_THREAD__)
+  static std::atomic<int> dummy{0};
+  dummy.fetch_add(0, std::memory_order_seq_cst);
+#else
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+#endif
+}
+
+} // namespace detail
+
+class epoch_domain {
+  using deleter_fn = void (*)(void *);
+
+  struct retired {
+    void *pointer;
+    deleter_fn deleter;
+    std::uint64_t epoch;
+  };
+
+  static constexpr std::uint64_t idle =
+      std::numeric_limits<std::uint64_t>::max();
+
+  struct alignas(64) thread_record {
+    std::atomic<std::uint64_t> announced{idle};
+    std::atomic<bool> in_use{false};
+    thread_record *next{nullptr};
+    // Only touched by the owning thread.
+    std::size_t nesting{0};
+    std::vector<retired> retired_list;
+  };
+
+  struct state {
+    alignas(64) std::atomic<std::uint64_t> global_epoch{0};
+    alignas(64) std::atomic<thread_record *> records{nullptr};
+    std::atomic<bool> alive{true};
+    std::mutex orphan_mutex;
+    std::vector<retired> orphans;
+    std::atomic<bool> has_orphans{false};
+
+    ~state() {
+      thread_record *r = records.load();
+      while (r != nullptr) {
+        delete std::exchange(r, r->next);
+      }
+    }
+  };
+
+public:
+  static constexpr std::size_t collect_threshold = 64;
+
+  // RAII read-side critical section. Pointers loaded from a structure guarded
+  // by this domain stay valid until the guard is destroyed.
+  class guard {
+  public:
+    guard(guard &&other) noexcept
+        : record_(std::exchange(other.record_, nullptr)) {}
+    guard &operator=(guard &&) = delete;
+    guard(const guard &) = delete;
+    guard &operator=(const guard &) = delete;
+
+    ~guard() {
+      if (record_ != nullptr && --record_->nesting == 0) {
+        record_->announced.store(idle, std::memory_order_release);
+      }
+    }
+
+  private:
+    friend class epoch_domain;
+    explicit guard(thread_record *record) : record_(record) {}
+    thread_record *record_;
+  };
+
+  epoch_domain() : state_(std::make_shared<state>()) {}
+
+  // Frees everything still retired. No thread may be using the domain.
+  ~epoch_domain() {
+    state_->alive.store(false);
+    for (thread_record *r = state_->records.load(); r != nullptr; r = r->next) {
+      free_all(r->retired_list);
+    }
+    free_all(state_->orphans);
+  }
+
+  epoch_domain(const epoch_domain &) = delete;
+  epoch_domain &operator=(const epoch_domain &) = delete;
+  epoch_domain(epoch_domain &&) = delete;
+  epoch_domain &operator=(epoch_domain &&) = delete;
+
+  [[nodiscard]] guard pin() {
+    thread_record *record = local_record();
+    if (record->nesting++ == 0) {
+      // The fence orders the announcement before every later load, acquire
+      // ones included, and pairs with the fence in try_advance(): either
+      // the reclaimer sees this announcement, or this reader sees the
+      // unlink that preceded the retire. A seq_cst store alone would not
+      // stop a later acquire load from moving ahead of it.
+      record->announced.store(
+          state_->global_epoch.load(std::memory_order_relaxed),
+          std::memory_order_relaxed);
+      detail::store_load_fence();
+    }
+    return guard(record);
+  }
+
+  // Hand over an unlinked object; it is deleted once no reader can hold it.
+  template <typename T> void retire(T *pointer) {
+    retire(static_cast<void *>(pointer),
+           [](void *p) { delete static_cast<T *>(p); });
+  }
+
+  void retire(void *pointer, deleter_fn deleter) {
+    thread_record *record = local_record();
+    record->retired_list.push_back(
+        {pointer, deleter,
+         state_->global_epoch.load(std::memory_order_acquire)});
+    if (record->retired_list.size() >= collect_threshold) {
+      collect(record);
+    }
+  }
+
+  // Try to advance the epoch and free whatever the calling thread may free.
+  void collect() { collect(local_record()); }
+
+  [[nodiscard]] std::uint64_t epoch() const noexcept {
+    return state_->global_epoch.load(std::memory_order_acquire);
+  }
+
+  // Objects retired by the calling thread that are not yet freed.
+  [[nodiscard]] std::size_t pending() {
+    return local_record()->retired_list.size();
+  }
+
+private:
+  // ----- THREAD REGISTRATION -----
+
+  // One record per (thread, domain), found through a small thread-local list.
+  // The list keeps the domain's state alive so a thread exiting after the
+  // domain is gone still has somewhere to hand its record back to.
+  struct thread_cache {
+    struct entry {
+      std::shared_ptr<state> owner;
+      thread_record *record;
+    };
+    std::vector<entry> entries;
+
+    ~thread_cache() {
+      for (auto &e : entries) {
+        release(*e.owner, e.record);
+      }
+    }
+  };
+
+  thread_record *local_record() {
+    thread_local thread_cache cache;
+    for (auto &e : cache.entries) {
+      if (e.owner == state_) {
+        return e.record;
+      }
+    }
+    // Miss: drop entries for domains that no longer exist, then register.
+    std::erase_if(cache.entries, [](thread_cache::entry &e) {
+      if (e.owner->alive.load()) {
+        return false;
+      }
+      release(*e.owner, e.record);
+      return true;
+    });
+    thread_record *record = acquire(*state_);
+    cache.entries.push_back({state_, record});
+    return record;
+  }
+
+  static thread_record *acquire(state &s) {
+    for (thread_record *r = s.records.load(std::memory_order_acquire);
+         r != nullptr; r = r->next) {
+      bool expected = false;
+      if (!r->in_use.load(std::memory_order_relaxed) &&
+          r->in_use.compare_exchange_strong(expected, true)) {
+        return r;
+      }
+    }
+    auto *record = new thread_record;
+    record->in_use.store(true, std::memory_order_relaxed);
+    thread_record *head = s.records.load(std::memory_order_relaxed);
+    do {
+      record->next = head;
+    } while (!s.records.compare_exchange_weak(head, record,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed));
+    return record;
+  }
+
+  // Thread exit: unfreed garbage moves to the domain's orphan list.
+  static void release(state &s, thread_record *record) {
+    record->announced.store(idle, std::memory_order_release);
+    record->nesting = 0;
+    if (s.alive.load() && !record->retired_list.empty()) {
+      std::lock_guard<std::mutex> lock(s.orphan_mutex);
+      s.orphans.insert(s.orphans.end(), record->retired_list.begin(),
+                       record->retired_list.end());
+      s.has_orphans.store(true, std::memory_order_release);
+    }
+    record->retired_list.clear();
+    record->in_use.store(false, std::memory_order_release);
+  }
+
+  // ----- RECLAMATION -----
+
+  bool try_advance() {
+    // Pairs with the fence in pin(): unlinks made before this point are
+    // visible to any reader whose announcement the scan below misses.
+    detail::store_load_fence();
+    std::uint64_t current =
+        state_->global_epoch.load(std::memory_order_relaxed);
+    for (thread_record *r = state_->records.load(std::memory_order_acquire);
+         r != nullptr; r = r->next) {
+      std::uint64_t announced = r->announced.load(std::memory_order_acquire);
+      if (announced != idle && announced != current) {
+        return false;
+      }
+    }
+    return state_->global_epoch.compare_exchange_strong(
+        current, current + 1, std::memory_order_acq_rel);
+  }
+
+  void collect(thread_record *record) {
+    try_advance();
+    if (state_->has_orphans.load(std::memory_order_acquire)) {
+      std::lock_guard<std::mutex> lock(state_->orphan_mutex);
+      record->retired_list.insert(record->retired_list.end(),
+                                  state_->orphans.begin(),
+                                  state_->orphans.end());
+      state_->orphans.clear();
+      state_->has_orphans.store(false, std::memory_order_relaxed);
+    }
+    std::uint64_t safe = state_->global_epoch.load(std::memory_order_acquire);
+    auto &list = record->retired_list;
+    auto still_pending = std::partition(
+        list.begin(), list.end(),
+        [safe](const retired &r) { return r.epoch + 2 > safe; });
+    // Deleters may retire more objects, so detach the batch first.
+    std::vector<retired> ready(still_pending, list.end());
+    list.erase(still_pending, list.end());
+    free_all(ready);
+  }
+
+  static void free_all(std::vector<retired> &list) {
+    std::vector<retired> batch;
+    batch.swap(list);
+    for (const auto &r : batch) {
+      r.deleter(r.pointer);
+    }
+  }
+
+  std::shared_ptr<state> state_;
+};
+
+// Process-wide domain for structures that don't need their own.
+inline epoch_domain &default_epoch_domain() {
+  static epoch_domain domain;
+  return domain;
+}
+
+} // namespace ds
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/*
+ * Hazard pointers
+ *
+ * Each reader publishes the exact pointer it is about to dereference in a
+ * hazard slot. A retired object is freed only when no slot holds it.
+ *
+ * 1) protect(src): load p, publish p, re-load src; retry until both loads
+ *    agree - from then on p cannot be freed under us
+ * 2) retire(p): append to the domain's retired list
+ * 3) once the list exceeds 2 * (number of slots) + retire_slack, snapshot
+ *    every slot, sort, and free each retired object not in the snapshot
+ *
+ * Unlike EBR a stalled reader pins at most the objects in its own slots, so
+ * garbage stays bounded by O(slots). The price is a seq_cst store per
+ * protected load instead of one per critical section.
+ */
+
+namespace ds {
+
+class hazard_domain {
+  using deleter_fn = void (*)(void *);
+
+  struct retired {
+    void *pointer;
+    deleter_fn deleter;
+  };
+
+  struct alignas(64) slot {
+    std::atomic<const void *> pointer{nullptr};
+    std::atomic<bool> in_use{false};
+    slot *next{nullptr};
+  };
+
+public:
+  static constexpr std::size_t retire_slack = 64;
+
+  // Owns one hazard slot for its lifetime.
+  class hazard_pointer {
+  public:
+    hazard_pointer(hazard_pointer &&other) noexcept
+        : slot_(std::exchange(other.slot_, nullptr)) {}
+    hazard_pointer &operator=(hazard_pointer &&) = delete;
+    hazard_pointer(const hazard_pointer &) = delete;
+    hazard_pointer &operator=(const hazard_pointer &) = delete;
+
+    ~hazard_pointer() {
+      if (slot_ != nullptr) {
+        slot_->pointer.store(nullptr, std::memory_order_release);
+        slot_->in_use.store(false, std::memory_order_release);
+      }
+    }
+
+    // Returns a pointer that stays valid until reset() or the next protect().
+    template <typename T> T *protect(const std::atomic<T *> &source) {
+      T *p = source.load(std::memory_order_relaxed);
+      while (true) {
+        slot_->pointer.store(p, std::memory_order_seq_cst);
+        T *again = source.load(std::memory_order_seq_cst);
+        if (again == p) {
+          return p;
+        }
+        p = again;
+      }
+    }
+
+    void reset() noexcept {
+      slot_->pointer.store(nullptr, std::memory_order_release);
+    }
+
+  private:
+    friend class hazard_domain;
+    explicit hazard_pointer(slot *s) : slot_(s) {}
+    slot *slot_;
+  };
+
+  hazard_domain() = default;
+
+  // Frees everything still retired. No hazard_pointer may outlive the domain.
+  ~hazard_domain() {
+    for (const auto &r : retired_) {
+      r.deleter(r.pointer);
+    }
+    slot *s = slots_.load();
+    while (s != nullptr) {
+      delete std::exchange(s, s->next);
+    }
+  }
+
+  hazard_domain(const hazard_domain &) = delete;
+  hazard_domain &operator=(const hazard_domain &) = delete;
+  hazard_domain(hazard_domain &&) = delete;
+  hazard_domain &operator=(hazard_domain &&) = delete;
+
+  [[nodiscard]] hazard_pointer make_hazard_pointer() {
+    for (slot *s = slots_.load(std::memory_order_acquire); s != nullptr;
+         s = s->next) {
+      bool expected = false;
+      if (!s->in_use.load(std::memory_order_relaxed) &&
+          s->in_use.compare_exchange_strong(expected, true)) {
+        return hazard_pointer(s);
+      }
+    }
+    auto *s = new slot;
+    s->in_use.store(true, std::memory_order_relaxed);
+    slot *head = slots_.load(std::memory_order_relaxed);
+    do {
+      s->next = head;
+    } while (!slots_.compare_exchange_weak(
+        head, s, std::memory_order_release, std::memory_order_relaxed));
+    slot_count_.fetch_add(1, std::memory_order_relaxed);
+    return hazard_pointer(s);
+  }
+
+  template <typename T> void retire(T *pointer) {
+    retire(static_cast<void *>(pointer),
+           [](void *p) { delete static_cast<T *>(p); });
+  }
+
+  void retire(void *pointer, deleter_fn deleter) {
+    std::vector<retired> ready;
+    {
+      std::lock_guard<std::mutex> lock(retired_mutex_);
+      retired_.push_back({pointer, deleter});
+      if (retired_.size() <
+          2 * slot_count_.load(std::memory_order_relaxed) + retire_slack) {
+        return;
+      }
+      ready = scan();
+    }
+    free_all(ready);
+  }
+
+  // Free every retired object that no slot currently protects.
+  void reclaim() {
+    std::vector<retired> ready;
+    {
+      std::lock_guard<std::mutex> lock(retired_mutex_);
+      ready = scan();
+    }
+    free_all(ready);
+  }
+
+  [[nodiscard]] std::size_t pending() const {
+    std::lock_guard<std::mutex> lock(retired_mutex_);
+    return retired_.size();
+  }
+
+private:
+  // Caller holds retired_mutex_. Returns the objects that are safe to free.
+  std::vector<retired> scan() {
+    std::vector<const void *> hazards;
+    for (slot *s = slots_.load(std::memory_order_acquire); s != nullptr;
+         s = s->next) {
+      if (const void *p = s->pointer.load(std::memory_order_seq_cst)) {
+        hazards.push_back(p);
+      }
+    }
+    std::sort(hazards.begin(), hazards.end());
+
+    auto protected_end =
+        std::partition(retired_.begin(), retired_.end(), [&](const retired &r) {
+          return std::binary_search(hazards.begin(), hazards.end(), r.pointer);
+        });
+    std::vector<retired> ready(protected_end, retired_.end());
+    retired_.erase(protected_end, retired_.end());
+    return ready;
+  }
+
+  // Runs outside the lock: deleters may retire more objects.
+  static void free_all(const std::vector<retired> &ready) {
+    for (const auto &r : ready) {
+      r.deleter(r.pointer);
+    }
+  }
+
+  std::atomic<slot *> slots_{nullptr};
+  std::atomic<std::size_t> slot_count_{0};
+  mutable std::mutex retired_mutex_;
+  std::vector<retired> retired_;
+};
+
+inline hazard_domain &default_hazard_domain() {
+  static hazard_domain domain;
+  return domain;
+}
+
+} // namespace ds
@@ -0,0 +1,66 @@
+#include "benchmark.hpp"
+#include "shm_queue.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+struct tick {
+  std::uint64_t sequence;
+  double price;
+  std::uint32_t size;
+};
+
+using spsc = ds::shm_queue<tick>;
+using mpsc = ds::shm_queue<tick, ds::shm_producers::multi>;
+
+template <typename Queue> void push_pop(ds::bench::state &st) {
+  auto region = ds::shm_region::create_anonymous(Queue::required_bytes(1024));
+  auto q = Queue::create(region, 1024);
+  tick out{};
+  for (std::size_t i = 0; i < st.iterations(); ++i) {
+    q.try_push(tick{i, 1.0, 100});
+    q.try_pop(out);
+    ds::bench::do_not_optimize(out);
+  }
+}
+
+// One op is one element from a forked producer to this process.
+template <typename Queue> void cross_process(ds::bench::state &st) {
+  st.pause();
+  auto region = ds::shm_region::create_anonymous(Queue::required_bytes(4096));
+  auto q = Queue::create(region, 4096);
+  std::size_t count = st.iterations();
+  st.resume();
+
+  pid_t child = ::fork();
+  if (child == 0) {
+    for (std::size_t i = 0; i < count; ++i) {
+      q.push(tick{i, 1.0, 100});
+    }
+    ::_exit(0);
+  }
+  std::uint64_t sum = 0;
+  tick t{};
+  for (std::size_t i = 0; i < count; ++i) {
+    q.pop(t);
+    sum += t.sequence;
+  }
+  ds::bench::do_not_optimize(sum);
+  ::waitpid(child, nullptr, 0);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  ds::bench::runner runner(argc, argv, "shm_queue");
+  runner.add("spsc_push_pop", push_pop<spsc>);
+  runner.add("mpsc_push_pop", push_pop<mpsc>);
+  runner.add("spsc_cross_process", cross_process<spsc>);
+  runner.add("mpsc_cross_process", cross_process<mpsc>);
+  return runner.run();
+}
@@ -0,0 +1,275 @@
+#pragma once
+
+#include "shm_region.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace ds {
+
+/*
+ * shm_queue<T, Producers>
+ * Bounded queue whose control block and ring live in a shm_region, so a
+ * producer in one process and a consumer in another exchange elements
+ * through shared memory: one copy in, one copy (or an in-place read) out,
+ * and no syscalls unless someone has to sleep.
+ *
+ *   offset 0          header: magic, capacity, slots_offset
+ *   +64               head      (producers)        own cache line
+ *   +128              tail      (consumer)         own cache line
+ *   +192              data signal / consumer waiters
+ *   +256              space signal / producer waiters
+ *   slots_offset      slot[capacity] = { sequence, T }
+ *
+ * The layout is position independent: everything is found from the
+ * header by offset, so each process can map the region anywhere.
+ *
+ * Each slot carries a sequence number (Vyukov's bounded queue). Slot i
+ * starts at i. A producer that claims position p fills the slot and
+ * stores p + 1. The consumer waits for p + 1, reads, and stores
+ * p + capacity to hand the slot to the next lap. With
+ * shm_producers::single, head is advanced with a plain store. With
+ * shm_producers::multi, producers claim positions with a CAS. There is
+ * always one consumer.
+ *
+ * Blocking is optional and works across processes: waiters sleep on a
+ * 32-bit signal word with a shared (non-private) futex, and the other
+ * side only issues FUTEX_WAKE when a waiter count says someone is asleep.
+ * Sequence stores and loads are seq_cst so "publish, then check waiters"
+ * and "register, then re-check the slot" cannot both miss each other.
+ * T must be trivially copyable, since the other process only sees bytes.
+ */
+
+enum class shm_producers { single, multi };
+
+namespace detail {
+
+inline long futex(std::atomic<std::uint32_t> *word, int op,
+                  std::uint32_t value, const timespec *timeout) noexcept {
+  static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t));
+  return ::syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(word), op,
+                   value, timeout, nullptr, 0);
+}
+
+// One side of the sleep/wake protocol.
+struct alignas(64) shm_waitpoint {
+  std::atomic<std::uint32_t> signal{0};
+  std::atomic<std::uint32_t> waiters{0};
+
+  // Sleeps until notify() or `until`, unless `ready()` already holds after
+  // registering. Returns ready().
+  template <typename Ready>
+  bool wait(Ready ready, std::chrono::steady_clock::time_point until) {
+    waiters.fetch_add(1);
+    while (!ready()) {
+      std::uint32_t seen = signal.load();
+      if (ready()) {
+        break;
+      }
+      auto now = std::chrono::steady_clock::now();
+      if (now >= until) {
+        break;
+      }
+      timespec timeout{};
+      const timespec *limit = nullptr;
+      if (until != std::chrono::steady_clock::time_point::max()) {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      until - now)
+                      .count();
+        timeout.tv_sec = static_cast<std::time_t>(ns / 1'000'000'000);
+        timeout.tv_nsec = static_cast<long>(ns % 1'000'000'000);
+        limit = &timeout;
+      }
+      futex(&signal, FUTEX_WAIT, seen, limit);
+    }
+    waiters.fetch_sub(1);
+    return ready();
+  }
+
+  void notify() noexcept {
+    if (waiters.load() != 0) {
+      signal.fetch_add(1);
+      futex(&signal, FUTEX_WAKE, INT_MAX, nullptr);
+    }
+  }
+};
+
+} // namespace detail
+
+template <typename T, shm_producers Producers = shm_producers::single>
+class shm_queue {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "elements cross process boundaries as raw bytes");
+
+  static constexpr std::uint64_t magic_value = 0x64735f73686d7131; // ds_shmq1
+
+  struct slot {
+    std::atomic<std::uint64_t> sequence;
+    T value;
+  };
+
+  struct header {
+    std::atomic<std::uint64_t> magic;
+    std::uint64_t capacity;
+    std::uint64_t element_size;
+    std::uint64_t slots_offset;
+    alignas(64) std::atomic<std::uint64_t> head;
+    alignas(64) std::atomic<std::uint64_t> tail;
+    detail::shm_waitpoint data;  // consumer sleeps here
+    detail::shm_waitpoint space; // producers sleep here
+  };
+
+  static constexpr std::size_t slots_offset =
+      (sizeof(header) + alignof(slot) - 1) / alignof(slot) * alignof(slot);
+
+public:
+  using clock = std::chrono::steady_clock;
+
+  // Bytes a region needs for `capacity` (rounded up to a power of two).
+  [[nodiscard]] static std::size_t required_bytes(std::size_t capacity) {
+    return slots_offset + std::bit_ceil(capacity) * sizeof(slot);
+  }
+
+  // Lays a fresh queue out in `region`; attach() from the other process.
+  [[nodiscard]] static shm_queue create(shm_region &region,
+                                        std::size_t capacity) {
+    capacity = std::bit_ceil(std::max<std::size_t>(capacity, 2));
+    if (region.size() < required_bytes(capacity)) {
+      throw std::length_error("shm_queue: region too small");
+    }
+    auto *h = ::new (region.data()) header{};
+    h->capacity = capacity;
+    h->element_size = sizeof(T);
+    h->slots_offset = slots_offset;
+    auto *slots = reinterpret_cast<slot *>(region.data() + slots_offset);
+    for (std::size_t i = 0; i < capacity; ++i) {
+      ::new (&slots[i].sequence) std::atomic<std::uint64_t>(i);
+    }
+    // Published last: an attacher that sees the magic sees the layout.
+    h->magic.store(magic_value, std::memory_order_release);
+    return shm_queue(region.data());
+  }
+
+  [[nodiscard]] static shm_queue attach(shm_region &region) {
+    if (region.size() < sizeof(header)) {
+      throw std::runtime_error("shm_queue: region too small");
+    }
+    auto *h = std::launder(reinterpret_cast<header *>(region.data()));
+    if (h->magic.load(std::memory_order_acquire) != magic_value ||
+        h->element_size != sizeof(T) ||
+        region.size() < h->slots_offset + h->capacity * sizeof(slot)) {
+      throw std::runtime_error("shm_queue: region holds no matching queue");
+    }
+    return shm_queue(region.data());
+  }
+
+  [[nodiscard]] std::size_t capacity() const noexcept { return mask_ + 1; }
+
+  // Approximate when the other side is active. tail is read first: head
+  // only moves forward, so the later head read can never be behind it.
+  [[nodiscard]] std::size_t size() const noexcept {
+    std::uint64_t tail = header_->tail.load();
+    std::uint64_t head = header_->head.load();
+    return static_cast<std::size_t>(head - tail);
+  }
+
+  // ----- PRODUCER API -----
+  bool try_push(const T &value) {
+    std::uint64_t position = header_->head.load(std::memory_order_relaxed);
+    while (true) {
+      slot &s = slots_[position & mask_];
+      std::uint64_t sequence = s.sequence.load();
+      auto diff = static_cast<std::int64_t>(sequence - position);
+      if (diff < 0) {
+        return false; // full
+      }
+      if (diff > 0) {
+        position = header_->head.load(std::memory_order_relaxed);
+        continue;
+      }
+      if constexpr (Producers == shm_producers::single) {
+        header_->head.store(position + 1, std::memory_order_relaxed);
+      } else if (!header_->head.compare_exchange_weak(
+                     position, position + 1, std::memory_order_relaxed)) {
+        continue;
+      }
+      s.value = value;
+      s.sequence.store(position + 1);
+      header_->data.notify();
+      return true;
+    }
+  }
+
+  void push(const T &value) { push_until(value, clock::time_point::max()); }
+
+  template <typename Rep, typename Period>
+  bool push_for(const T &value, std::chrono::duration<Rep, Period> timeout) {
+    return push_until(value, clock::now() + timeout);
+  }
+
+  // ----- CONSUMER API (single consumer) -----
+
+  // Hands the next element to fn(const T&) while it is still in its slot.
+  template <typename Fn> bool try_pop_with(Fn &&fn) {
+    std::uint64_t position = header_->tail.load(std::memory_order_relaxed);
+    slot &s = slots_[position & mask_];
+    if (s.sequence.load() != position + 1) {
+      return false;
+    }
+    fn(static_cast<const T &>(s.value));
+    s.sequence.store(position + mask_ + 1);
+    header_->tail.store(position + 1, std::memory_order_relaxed);
+    header_->space.notify();
+    return true;
+  }
+
+  bool try_pop(T &out) {
+    return try_pop_with([&](const T &value) { out = value; });
+  }
+
+  void pop(T &out) { pop_until(out, clock::time_point::max()); }
+
+  template <typename Rep, typename Period>
+  bool pop_for(T &out, std::chrono::duration<Rep, Period> timeout) {
+    return pop_until(out, clock::now() + timeout);
+  }
+
+private:
+  explicit shm_queue(std::byte *base)
+      : header_(std::launder(reinterpret_cast<header *>(base))),
+        slots_(reinterpret_cast<slot *>(base + header_->slots_offset)),
+        mask_(header_->capacity - 1) {}
+
+  bool push_until(const T &value, clock::time_point until) {
+    bool pushed = false;
+    header_->space.wait([&] { return pushed || (pushed = try_push(value)); },
+                        until);
+    return pushed;
+  }
+
+  bool pop_until(T &out, clock::time_point until) {
+    bool popped = false;
+    header_->data.wait([&] { return popped || (popped = try_pop(out)); },
+                       until);
+    return popped;
+  }
+
+  header *header_;
+  slot *slots_;
+  std::uint64_t mask_;
+};
+
+} // namespace ds
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ds {
+
+/*
+ * shm_region
+ * A MAP_SHARED mapping that other processes can map too.
+ *
+ *   create_anonymous(bytes)   memfd_create: no name in the filesystem; share
+ *                             it by fork() or by passing fd() over a unix
+ *                             socket, then from_fd() on the other side
+ *   create(name, bytes)       shm_open(O_CREAT | O_EXCL) under /dev/shm
+ *   open(name)                shm_open an existing region, mapped at its size
+ *
+ * Each process may map the region at a different address, so whatever lives
+ * inside must refer to other parts of it by offset, never by pointer.
+ * Named regions persist until unlink(name).
+ */
+class shm_region {
+public:
+  [[nodiscard]] static shm_region create_anonymous(std::size_t bytes) {
+    int fd = ::memfd_create("ds_shm_region", MFD_CLOEXEC);
+    if (fd < 0) {
+      throw std::system_error(errno, std::generic_category(), "memfd_create");
+    }
+    return sized(fd, bytes, "memfd");
+  }
+
+  [[nodiscard]] static shm_region create(const std::string &name,
+                                         std::size_t bytes) {
+    int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC,
+                        0600);
+    if (fd < 0) {
+      throw std::system_error(errno, std::generic_category(),
+                              "shm_open " + name);
+    }
+    return sized(fd, bytes, name);
+  }
+
+  [[nodiscard]] static shm_region open(const std::string &name) {
+    int fd = ::shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+    if (fd < 0) {
+      throw std::system_error(errno, std::generic_category(),
+                              "shm_open " + name);
+    }
+    return from_fd(fd);
+  }
+
+  // Takes ownership of `fd` and maps the whole object.
+  [[nodiscard]] static shm_region from_fd(int fd) {
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+      int error = errno;
+      ::close(fd);
+      throw std::system_error(error, std::generic_category(), "fstat");
+    }
+    return shm_region(fd, static_cast<std::size_t>(st.st_size));
+  }
+
+  static void unlink(const std::string &name) noexcept {
+    ::shm_unlink(name.c_str());
+  }
+
+  ~shm_region() {
+    if (data_ != nullptr) {
+      ::munmap(data_, size_);
+    }
+    if (fd_ >= 0) {
+      ::close(fd_);
+    }
+  }
+
+  shm_region(shm_region &&other) noexcept
+      : fd_(std::exchange(other.fd_, -1)),
+        data_(std::exchange(other.data_, nullptr)),
+        size_(std::exchange(other.size_, 0)) {}
+  shm_region &operator=(shm_region &&other) noexcept {
+    std::swap(fd_, other.fd_);
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    return *this;
+  }
+  shm_region(const shm_region &) = delete;
+  shm_region &operator=(const shm_region &) = delete;
+
+  [[nodiscard]] std::byte *data() const noexcept { return data_; }
+  [[nodiscard]] std::size_t size() const noexcept { return size_; }
+  [[nodiscard]] int fd() const noexcept { return fd_; }
+
+private:
+  shm_region(int fd, std::size_t size) : fd_(fd), size_(size) {
+    void *address =
+        ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED) {
+      int error = errno;
+      ::close(fd);
+      fd_ = -1;
+      throw std::system_error(error, std::generic_category(), "mmap");
+    }
+    data_ = static_cast<std::byte *>(address);
+  }
+
+  static shm_region sized(int fd, std::size_t bytes, const std::string &what) {
+    if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+      int error = errno;
+      ::close(fd);
+      throw std::system_error(error, std::generic_category(),
+                              "ftruncate " + what);
+    }
+    return shm_region(fd, bytes);
+  }
+
+  int fd_{-1};
+  std::byte *data_{nullptr};
+  std::size_t size_{0};
+};
+
+} // namespace ds
@@ -0,0 +1,222 @@
+#include "shm_queue.hpp"
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+struct tick {
+  std::uint64_t sequence;
+  double price;
+  std::uint32_t size;
+};
+
+// Runs `child` in a forked process and returns its exit status.
+template <typename Fn> pid_t spawn(Fn child) {
+  pid_t pid = ::fork();
+  if (pid == 0) {
+    child();
+    ::_exit(0);
+  }
+  REQUIRE(pid > 0);
+  return pid;
+}
+
+int join(pid_t pid) {
+  int status = 0;
+  ::waitpid(pid, &status, 0);
+  return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+} // namespace
+
+// ------ SINGLE PROCESS -------
+
+TEST_CASE("values come out in FIFO order and the ring fills up", "[fifo]") {
+  using queue = ds::shm_queue<int>;
+  auto region = ds::shm_region::create_anonymous(queue::required_bytes(8));
+  auto q = queue::create(region, 8);
+  REQUIRE(q.capacity() == 8);
+
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < 8; ++i) {
+      REQUIRE(q.try_push(i));
+    }
+    REQUIRE_FALSE(q.try_push(99));
+    REQUIRE(q.size() == 8);
+    int out = -1;
+    for (int i = 0; i < 8; ++i) {
+      REQUIRE(q.try_pop(out));
+      REQUIRE(out == i);
+    }
+    REQUIRE_FALSE(q.try_pop(out));
+  }
+}
+
+TEST_CASE("try_pop_with reads the element in place", "[fifo]") {
+  using queue = ds::shm_queue<tick>;
+  auto region = ds::shm_region::create_anonymous(queue::required_bytes(4));
+  auto q = queue::create(region, 4);
+  REQUIRE(q.try_push(tick{7, 101.5, 300}));
+
+  std::uint32_t seen = 0;
+  REQUIRE(q.try_pop_with([&](const tick &t) { seen = t.size; }));
+  REQUIRE(seen == 300);
+  REQUIRE_FALSE(q.try_pop_with([](const tick &) {}));
+}
+
+TEST_CASE("size stays in range while both sides run", "[fifo]") {
+  using queue = ds::shm_queue<int>;
+  auto region = ds::shm_region::create_anonymous(queue::required_bytes(4));
+  auto q = queue::create(region, 4);
+  constexpr int n = 100'000;
+  std::thread producer([&] {
+    for (int i = 0; i < n; ++i) {
+      q.push(i);
+    }
+  });
+  std::thread consumer([&] {
+    int out = 0;
+    for (int i = 0; i < n; ++i) {
+      q.pop(out);
+    }
+  });
+  std::size_t largest = 0;
+  for (int i = 0; i < n; ++i) {
+    largest = std::max(largest, q.size());
+  }
+  producer.join();
+  consumer.join();
+  // Approximate, but never a wrapped-around count.
+  REQUIRE(largest <= static_cast<std::size_t>(n));
+  REQUIRE(q.size() == 0);
+}
+
+TEST_CASE("attach validates the region", "[attach]") {
+  auto region = ds::shm_region::create_anonymous(
+      ds::shm_queue<int>::required_bytes(16));
+  REQUIRE_THROWS_AS(ds::shm_queue<int>::attach(region), std::runtime_error);
+
+  auto q = ds::shm_queue<int>::create(region, 16);
+  REQUIRE(q.try_push(5));
+  auto other = ds::shm_queue<int>::attach(region);
+  int out = 0;
+  REQUIRE(other.try_pop(out));
+  REQUIRE(out == 5);
+
+  REQUIRE_THROWS_AS(ds::shm_queue<tick>::attach(region), std::runtime_error);
+  auto small = ds::shm_region::create_anonymous(64);
+  REQUIRE_THROWS_AS(ds::shm_queue<int>::create(small, 16), std::length_error);
+}
+
+TEST_CASE("timed operations give up", "[blocking]") {
+  using queue = ds::shm_queue<int>;
+  auto region = ds::shm_region::create_anonymous(queue::required_bytes(2));
+  auto q = queue::create(region, 2);
+  int out = 0;
+  REQUIRE_FALSE(q.pop_for(out, 5ms));
+  q.push(1);
+  q.push(2);
+  REQUIRE_FALSE(q.push_for(3, 5ms));
+}
+
+TEST_CASE("named regions are opened by name", "[region]") {
+  std::string name = "/ds_shm_queue_test_" + std::to_string(::getpid());
+  ds::shm_region::unlink(name);
+  using queue = ds::shm_queue<int>;
+  auto created = ds::shm_region::create(name, queue::required_bytes(4));
+  auto producer = queue::create(created, 4);
+  REQUIRE_THROWS_AS(ds::shm_region::create(name, 64), std::system_error);
+
+  auto opened = ds::shm_region::open(name);
+  ds::shm_region::unlink(name);
+  REQUIRE(opened.size() == created.size());
+  auto consumer = queue::attach(opened);
+  producer.push(42);
+  int out = 0;
+  REQUIRE(consumer.try_pop(out));
+  REQUIRE(out == 42);
+}
+
+// ------ ACROSS PROCESSES -------
+
+TEST_CASE("a child process produces, the parent consumes", "[process]") {
+  using queue = ds::shm_queue<tick>;
+  constexpr std::uint64_t count = 100'000;
+  auto region = ds::shm_region::create_anonymous(queue::required_bytes(64));
+  auto q = queue::create(region, 64);
+
+  pid_t child = spawn([&] {
+    for (std::uint64_t i = 0; i < count; ++i) {
+      q.push(tick{i, static_cast<double>(i) / 4, static_cast<std::uint32_t>(i)});
+    }
+  });
+
+  bool ordered = true;
+  tick t{};
+  for (std::uint64_t i = 0; i < count; ++i) {
+    q.pop(t);
+    ordered = ordered && t.sequence == i &&
+              t.size == static_cast<std::uint32_t>(i);
+  }
+  REQUIRE(ordered);
+  REQUIRE(join(child) == 0);
+  REQUIRE(q.size() == 0);
+}
+
+TEST_CASE("a blocked consumer is woken by another process", "[process]") {
+  using queue = ds::shm_queue<int>;
+  auto region = ds::shm_region::create_anonymous(queue::required_bytes(4));
+  auto q = queue::create(region, 4);
+
+  pid_t child = spawn([&] {
+    std::this_thread::sleep_for(20ms);
+    q.push(7);
+  });
+  int out = 0;
+  q.pop(out);
+  REQUIRE(out == 7);
+  REQUIRE(join(child) == 0);
+}
+
+TEST_CASE("several producer processes feed one consumer", "[process]") {
+  using queue = ds::shm_queue<std::uint64_t, ds::shm_producers::multi>;
+  constexpr std::uint64_t producers = 3;
+  constexpr std::uint64_t per_producer = 20'000;
+  auto region = ds::shm_region::create_anonymous(queue::required_bytes(32));
+  auto q = queue::create(region, 32);
+
+  std::vector<pid_t> children;
+  for (std::uint64_t p = 0; p < producers; ++p) {
+    children.push_back(spawn([&, p] {
+      for (std::uint64_t i = 0; i < per_producer; ++i) {
+        q.push(p << 32 | i);
+      }
+    }));
+  }
+
+  // Each producer's elements arrive in its own order.
+  std::vector<std::uint64_t> next(producers, 0);
+  bool ordered = true;
+  std::uint64_t value = 0;
+  for (std::uint64_t i = 0; i < producers * per_producer; ++i) {
+    q.pop(value);
+    std::uint64_t p = value >> 32;
+    ordered = ordered && p < producers && (value & 0xffffffff) == next[p]++;
+  }
+  REQUIRE(ordered);
+  for (pid_t child : children) {
+    REQUIRE(join(child) == 0);
+  }
+}
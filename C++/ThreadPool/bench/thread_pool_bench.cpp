@@ -0,0 +1,133 @@
+#include "benchmark.hpp"
+#include "parallel_pipeline.hpp"
+#include "pool_future.hpp"
+#include "thread_pool.hpp"
+#include <future>
+#include <vector>
+
+namespace {
+
+constexpr int chain_depth = 8;
+constexpr std::size_t fan_width = 32;
+
+// Stand-in for per-item work of a given size.
+std::size_t work(std::size_t seed, int rounds) {
+  for (int r = 0; r < rounds; ++r) {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+  }
+  return seed;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  ds::bench::runner runner(argc, argv, "thread_pool");
+  ds::thread_pool pool(4);
+
+  runner.add("submit/round_trip", [&pool](ds::bench::state &st) {
+    for (std::size_t i = 0; i < st.iterations(); ++i) {
+      auto f = pool.submit([i] { return i; });
+      ds::bench::do_not_optimize(f.get());
+    }
+  });
+
+  runner.add("submit/batch_then_wait", [&pool](ds::bench::state &st) {
+    std::vector<std::future<std::size_t>> futures;
+    futures.reserve(st.iterations());
+    for (std::size_t i = 0; i < st.iterations(); ++i) {
+      futures.push_back(pool.submit([i] { return i; }));
+    }
+    for (auto &f : futures) {
+      ds::bench::do_not_optimize(f.get());
+    }
+  });
+
+  // A dependent chain of small steps: blocking on each std::future versus
+  // letting each pool_future step schedule the next.
+  runner.add("chain8/submit_get", [&pool](ds::bench::state &st) {
+    for (std::size_t i = 0; i < st.iterations(); ++i) {
+      std::size_t v = i;
+      for (int step = 0; step < chain_depth; ++step) {
+        v = pool.submit([v] { return v + 1; }).get();
+      }
+      ds::bench::do_not_optimize(v);
+    }
+  });
+
+  runner.add("chain8/then", [&pool](ds::bench::state &st) {
+    for (std::size_t i = 0; i < st.iterations(); ++i) {
+      auto f = ds::spawn(pool, [i] { return i + 1; });
+      for (int step = 1; step < chain_depth; ++step) {
+        f = std::move(f).then([](std::size_t v) { return v + 1; });
+      }
+      ds::bench::do_not_optimize(f.get());
+    }
+  });
+
+  // Fan out, then combine: get() every std::future versus one when_all.
+  runner.add("fan_in32/submit_get", [&pool](ds::bench::state &st) {
+    std::vector<std::future<std::size_t>> parts;
+    parts.reserve(fan_width);
+    for (std::size_t i = 0; i < st.iterations(); ++i) {
+      parts.clear();
+      for (std::size_t k = 0; k < fan_width; ++k) {
+        parts.push_back(pool.submit([k] { return k; }));
+      }
+      std::size_t sum = 0;
+      for (auto &p : parts) {
+        sum += p.get();
+      }
+      ds::bench::do_not_optimize(sum);
+    }
+  });
+
+  runner.add("fan_in32/when_all", [&pool](ds::bench::state &st) {
+    for (std::size_t i = 0; i < st.iterations(); ++i) {
+      std::vector<ds::pool_future<std::size_t>> parts;
+      parts.reserve(fan_width);
+      for (std::size_t k = 0; k < fan_width; ++k) {
+        parts.push_back(ds::spawn(pool, [k] { return k; }));
+      }
+      auto sum = ds::when_all(std::move(parts)).then([](auto values) {
+        std::size_t total = 0;
+        for (std::size_t v : values) {
+          total += v;
+        }
+        return total;
+      });
+      ds::bench::do_not_optimize(sum.get());
+    }
+  });
+
+  // read (serial) -> transform (parallel, heavy) -> write (serial, in
+  // order): one item per op, inline on one thread versus through the
+  // pipeline with 16 tokens.
+  runner.add("stream3/inline", [](ds::bench::state &st) {
+    std::size_t out = 0;
+    for (std::size_t i = 0; i < st.iterations(); ++i) {
+      out += work(work(i, 50), 400) & 1;
+    }
+    ds::bench::do_not_optimize(out);
+  });
+
+  runner.add("stream3/parallel_pipeline", [&pool](ds::bench::state &st) {
+    std::size_t out = 0;
+    ds::parallel_pipeline pipeline(
+        pool, 16,
+        ds::make_stage(ds::stage_mode::serial_in_order,
+                       [&, i = std::size_t{0}](ds::flow_control &flow) mutable {
+                         if (i == st.iterations()) {
+                           flow.stop();
+                         }
+                         return work(i++, 50);
+                       }),
+        ds::make_stage(ds::stage_mode::parallel,
+                       [](std::size_t v) { return work(v, 400); }),
+        ds::make_stage(ds::stage_mode::serial_in_order,
+                       [&](std::size_t v) { out += v & 1; }));
+    pipeline.run();
+    ds::bench::do_not_optimize(out);
+  });
+
+  return runner.run();
+}
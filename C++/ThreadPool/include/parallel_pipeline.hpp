@@ -0,0 +1,450 @@
+#pragma once
+
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace ds {
+
+/*
+ * parallel_pipeline
+ * Streams items through a chain of stages on a thread_pool.
+ *
+ *   input --> parse --> transform --> compress --> write
+ *   serial    parallel  parallel      parallel     serial_in_order
+ *
+ *   token: [seq | slot]   a fixed set of max_tokens tokens circulates
+ *
+ * The input stage fills a free token and the same worker carries it from
+ * stage to stage; items never pass through a shared queue. A serial stage
+ * admits one token at a time. A token that finds it busy, or (in order)
+ * not its turn, is parked in that stage's gate. The worker leaving the
+ * stage hands the next eligible parked token to the pool and carries on
+ * with its own. Stages therefore overlap across tokens, and throughput is
+ * bounded by the slowest stage rather than by the sum of the stages.
+ *
+ *   serial_in_order       one at a time, in input order
+ *   serial_out_of_order   one at a time, in arrival order
+ *   parallel              any number at once
+ *
+ * max_tokens caps items in flight, which bounds memory and parked tokens.
+ * The input stage must be serial. It gets a flow_control& and calls stop()
+ * to end the stream; the value returned from that call is discarded.
+ *
+ * A stage that throws cancels the run: the input stops, tokens in flight
+ * drain through the gates without running stages, and run() rethrows.
+ * run() blocks, so calling it from a worker of a one-thread pool
+ * deadlocks.
+ */
+
+enum class stage_mode { serial_in_order, serial_out_of_order, parallel };
+
+class flow_control {
+public:
+  void stop() noexcept { stopped_ = true; }
+  [[nodiscard]] bool stopped() const noexcept { return stopped_; }
+
+private:
+  bool stopped_{false};
+};
+
+template <typename Fn> struct pipeline_stage {
+  stage_mode mode;
+  Fn fn;
+};
+
+template <typename Fn>
+pipeline_stage<std::decay_t<Fn>> make_stage(stage_mode mode, Fn &&fn) {
+  return {mode, std::forward<Fn>(fn)};
+}
+
+namespace detail {
+
+template <typename T>
+using pipeline_value_t =
+    std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+// The value type each stage produces, as a tuple.
+template <typename In, typename... Fns> struct pipeline_outputs {
+  using type = std::tuple<>;
+};
+template <typename In, typename Fn, typename... Rest>
+struct pipeline_outputs<In, Fn, Rest...> {
+  using out = std::invoke_result_t<Fn &, In>;
+  static_assert(sizeof...(Rest) == 0 || !std::is_void_v<out>,
+                "only the last stage may return void");
+  using type = decltype(std::tuple_cat(
+      std::declval<std::tuple<pipeline_value_t<out>>>(),
+      std::declval<typename pipeline_outputs<out, Rest...>::type>()));
+};
+
+template <typename Tuple> struct pipeline_slot;
+template <typename... Outs> struct pipeline_slot<std::tuple<Outs...>> {
+  // Index k + 1 holds the output of stage k.
+  using type = std::variant<std::monostate, Outs...>;
+};
+
+} // namespace detail
+
+template <typename... Fns> class parallel_pipeline {
+  static_assert(sizeof...(Fns) >= 2, "a pipeline needs input and a stage");
+
+public:
+  parallel_pipeline(thread_pool &pool, std::size_t max_tokens,
+                    pipeline_stage<Fns>... stages);
+
+  parallel_pipeline(const parallel_pipeline &) = delete;
+  parallel_pipeline &operator=(const parallel_pipeline &) = delete;
+
+  // Runs until the input stops and every item has left the last stage;
+  // rethrows the first exception a stage threw.
+  void run();
+
+  // Items that left the last stage during the last run().
+  [[nodiscard]] std::size_t processed() const;
+  // Most tokens in flight at once during the last run().
+  [[nodiscard]] std::size_t peak_in_flight() const;
+
+private:
+  static constexpr std::size_t stage_count = sizeof...(Fns);
+  using outputs =
+      typename detail::pipeline_outputs<flow_control &, Fns...>::type;
+
+  struct token {
+    std::uint64_t seq{0};
+    typename detail::pipeline_slot<outputs>::type slot;
+    token *next_free{nullptr};
+  };
+
+  // Admission for one serial stage; parked tokens wait in `waiting`,
+  // indexed by seq in order and as a FIFO ring out of order.
+  struct gate {
+    std::mutex mutex;
+    bool busy{false};
+    std::uint64_t next_seq{0};
+    std::vector<token *> waiting;
+    std::size_t head{0};
+    std::size_t count{0};
+  };
+
+  void drive(token *t, std::size_t k, bool admitted);
+  token *next_input(bool pump);
+  token *retire(token *t);
+  void release_token(token *t);
+  void notify_if_done();
+  void record_error();
+
+  bool enter(std::size_t k, token *t);
+  token *leave(std::size_t k);
+
+  void execute(std::size_t k, token &t);
+  template <std::size_t K> void execute_stage(token &t);
+
+  thread_pool &pool_;
+  std::tuple<pipeline_stage<Fns>...> stages_;
+  std::array<stage_mode, stage_count> modes_;
+  std::vector<token> tokens_;
+  std::unique_ptr<gate[]> gates_;
+
+  // Guards the input stage, the free list and the counters below.
+  mutable std::mutex mutex_;
+  std::condition_variable done_;
+  token *free_{nullptr};
+  bool input_busy_{false};
+  bool input_done_{true};
+  std::uint64_t next_seq_{0};
+  std::size_t in_flight_{0};
+  std::size_t pumps_{0};
+  std::size_t processed_{0};
+  std::size_t peak_{0};
+  std::exception_ptr error_;
+  std::atomic<bool> cancelled_{false};
+};
+
+template <typename... Fns>
+parallel_pipeline(thread_pool &, std::size_t, pipeline_stage<Fns>...)
+    -> parallel_pipeline<Fns...>;
+
+// ============================================================================
+// Implementation
+// ============================================================================
+
+template <typename... Fns>
+parallel_pipeline<Fns...>::parallel_pipeline(thread_pool &pool,
+                                             std::size_t max_tokens,
+                                             pipeline_stage<Fns>... stages)
+    : pool_(pool), stages_(std::move(stages)...),
+      modes_{stages.mode...}, tokens_(max_tokens),
+      gates_(std::make_unique<gate[]>(stage_count)) {
+  if (max_tokens == 0) {
+    throw std::invalid_argument("parallel_pipeline: max_tokens is zero");
+  }
+  if (modes_[0] == stage_mode::parallel) {
+    throw std::invalid_argument("parallel_pipeline: input must be serial");
+  }
+  for (std::size_t k = 1; k < stage_count; ++k) {
+    if (modes_[k] != stage_mode::parallel) {
+      gates_[k].waiting.assign(max_tokens, nullptr);
+    }
+  }
+}
+
+template <typename... Fns> void parallel_pipeline<Fns...>::run() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_ = nullptr;
+    for (token &t : tokens_) {
+      t.next_free = free_;
+      free_ = &t;
+    }
+    for (std::size_t k = 0; k < stage_count; ++k) {
+      gates_[k].next_seq = 0;
+    }
+    input_done_ = false;
+    next_seq_ = 0;
+    processed_ = 0;
+    peak_ = 0;
+    error_ = nullptr;
+    cancelled_.store(false);
+    pumps_ = 1;
+  }
+  pool_.post([this] { drive(next_input(true), 1, false); });
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_.wait(lock, [this] {
+    return input_done_ && in_flight_ == 0 && pumps_ == 0;
+  });
+  if (error_) {
+    std::rethrow_exception(error_);
+  }
+}
+
+template <typename... Fns>
+std::size_t parallel_pipeline<Fns...>::processed() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return processed_;
+}
+
+template <typename... Fns>
+std::size_t parallel_pipeline<Fns...>::peak_in_flight() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return peak_;
+}
+
+// ----- TOKEN FLOW -----
+
+// Carries `t` from stage k onward, then keeps pulling fresh input, until
+// the token parks at a busy gate or there is nothing left to start.
+// `admitted` means the gate of stage k was already claimed for `t`.
+template <typename... Fns>
+void parallel_pipeline<Fns...>::drive(token *t, std::size_t k,
+                                      bool admitted) {
+  while (t != nullptr) {
+    if (k == stage_count) {
+      t = retire(t);
+      k = 1;
+      continue;
+    }
+    const bool serial = modes_[k] != stage_mode::parallel;
+    if (serial && !admitted && !enter(k, t)) {
+      return; // parked; whoever leaves the stage resumes it
+    }
+    admitted = false;
+    execute(k, *t);
+    if (serial) {
+      if (token *next = leave(k)) {
+        pool_.post([this, next, k] { drive(next, k, true); });
+      }
+    }
+    ++k;
+  }
+}
+
+// Runs the input stage into a free token. Returns nullptr when another
+// worker holds the input, every token is in flight, or the stream ended.
+template <typename... Fns>
+auto parallel_pipeline<Fns...>::next_input(bool pump) -> token * {
+  token *t = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pump) {
+      --pumps_;
+    }
+    if (input_busy_ || input_done_ || free_ == nullptr) {
+      notify_if_done();
+      return nullptr;
+    }
+    input_busy_ = true;
+    t = std::exchange(free_, free_->next_free);
+    peak_ = std::max(peak_, ++in_flight_);
+  }
+
+  flow_control flow;
+  bool ok = !cancelled_.load(std::memory_order_acquire);
+  if (ok) {
+    try {
+      t->slot.template emplace<1>(std::invoke(std::get<0>(stages_).fn, flow));
+    } catch (...) {
+      record_error();
+      ok = false;
+    }
+  }
+
+  bool spare = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    input_busy_ = false;
+    if (!ok || flow.stopped()) {
+      input_done_ = true;
+      release_token(t);
+      notify_if_done();
+      return nullptr;
+    }
+    t->seq = next_seq_++;
+    if (free_ != nullptr) {
+      ++pumps_;
+      spare = true;
+    }
+  }
+  // Keep the input busy on another worker while this one carries `t`.
+  if (spare) {
+    pool_.post([this] { drive(next_input(true), 1, false); });
+  }
+  return t;
+}
+
+// Returns a finished token and starts the next item in its place.
+template <typename... Fns>
+auto parallel_pipeline<Fns...>::retire(token *t) -> token * {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    release_token(t);
+    ++processed_;
+    if (input_done_ && in_flight_ == 0 && pumps_ == 0) {
+      // run() may return as soon as the lock drops; touch nothing after.
+      done_.notify_all();
+      return nullptr;
+    }
+  }
+  return next_input(false);
+}
+
+// Caller holds mutex_.
+template <typename... Fns>
+void parallel_pipeline<Fns...>::release_token(token *t) {
+  t->slot.template emplace<0>();
+  t->next_free = std::exchange(free_, t);
+  --in_flight_;
+}
+
+// Caller holds mutex_.
+template <typename... Fns> void parallel_pipeline<Fns...>::notify_if_done() {
+  if (input_done_ && in_flight_ == 0 && pumps_ == 0) {
+    done_.notify_all();
+  }
+}
+
+template <typename... Fns> void parallel_pipeline<Fns...>::record_error() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!error_) {
+    error_ = std::current_exception();
+  }
+  cancelled_.store(true, std::memory_order_release);
+}
+
+// ----- SERIAL GATES -----
+
+template <typename... Fns>
+bool parallel_pipeline<Fns...>::enter(std::size_t k, token *t) {
+  gate &g = gates_[k];
+  const bool in_order = modes_[k] == stage_mode::serial_in_order;
+  std::lock_guard<std::mutex> lock(g.mutex);
+  if (!g.busy && (!in_order || t->seq == g.next_seq)) {
+    g.busy = true;
+    return true;
+  }
+  const std::size_t slots = g.waiting.size();
+  if (in_order) {
+    // Parked seqs all lie in [next_seq, next_seq + max_tokens).
+    g.waiting[t->seq % slots] = t;
+  } else {
+    g.waiting[(g.head + g.count) % slots] = t;
+  }
+  ++g.count;
+  return false;
+}
+
+// Frees the stage and claims it for the next eligible parked token.
+template <typename... Fns>
+auto parallel_pipeline<Fns...>::leave(std::size_t k) -> token * {
+  gate &g = gates_[k];
+  const bool in_order = modes_[k] == stage_mode::serial_in_order;
+  std::lock_guard<std::mutex> lock(g.mutex);
+  g.busy = false;
+  ++g.next_seq;
+  if (g.count == 0) {
+    return nullptr;
+  }
+  const std::size_t slots = g.waiting.size();
+  token *next = nullptr;
+  if (in_order) {
+    next = std::exchange(g.waiting[g.next_seq % slots], nullptr);
+  } else {
+    next = std::exchange(g.waiting[g.head], nullptr);
+    g.head = (g.head + 1) % slots;
+  }
+  if (next != nullptr) {
+    --g.count;
+    g.busy = true;
+  }
+  return next;
+}
+
+// ----- STAGES -----
+
+template <typename... Fns>
+void parallel_pipeline<Fns...>::execute(std::size_t k, token &t) {
+  [&]<std::size_t... I>(std::index_sequence<I...>) {
+    static_cast<void>(((k == I + 1 && (execute_stage<I + 1>(t), true)) || ...));
+  }(std::make_index_sequence<stage_count - 1>{});
+}
+
+template <typename... Fns>
+template <std::size_t K>
+void parallel_pipeline<Fns...>::execute_stage(token &t) {
+  // After a failure the token still walks the gates, but carries nothing.
+  if (t.slot.index() != K || cancelled_.load(std::memory_order_acquire)) {
+    t.slot.template emplace<0>();
+    return;
+  }
+  auto &fn = std::get<K>(stages_).fn;
+  try {
+    if constexpr (K + 1 == stage_count) {
+      std::invoke(fn, std::move(std::get<K>(t.slot)));
+      t.slot.template emplace<0>();
+    } else {
+      t.slot.template emplace<K + 1>(
+          std::invoke(fn, std::move(std::get<K>(t.slot))));
+    }
+  } catch (...) {
+    record_error();
+    t.slot.template emplace<0>();
+  }
+}
+
+} // namespace ds
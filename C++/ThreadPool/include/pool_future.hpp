@@ -0,0 +1,702 @@
+#pragma once
+
+#include "intrusive_ptr.hpp"
+#include "thread_pool.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace ds {
+
+/*
+ * pool_future<T>
+ * A future for thread_pool tasks that is chained instead of waited on.
+ *
+ *   spawn(pool, load)            [state | result | flags | continuation]
+ *     .then(parse)                              |
+ *     .then(store);                             | result lands: the stored
+ *                                               v continuation is posted
+ *                                [state | ...]  <-- parse writes here
+ *
+ * Each state holds one result and one continuation. The producer setting
+ * the result and then() attaching the continuation each set a bit in
+ * `flags`; whichever arrives second sees both and schedules the
+ * continuation, so no thread parks waiting for an intermediate value.
+ *
+ * Continuations up to inline_task::capacity bytes are stored inline in the
+ * state. The task posted to the pool captures only the state pointer,
+ * which std::function keeps without allocating, so a then() step costs its
+ * own state plus the queue node.
+ *
+ * A stage that throws skips the later then() callbacks and get() rethrows
+ * at the end. A continuation returning pool_future<U> is unwrapped.
+ * when_all / when_any combine futures; their bookkeeping runs inline on
+ * whichever thread completes an input.
+ *
+ * Continuations are posted to the pool, so it must outlive the chain.
+ * get() blocks like std::future::get(); calling it on a pool worker for
+ * work queued behind it on the same pool can deadlock.
+ */
+
+template <typename T> class pool_future;
+template <typename T> class pool_promise;
+
+template <typename T> struct when_any_result {
+  std::size_t index;
+  T value;
+};
+
+namespace detail {
+
+// ----- INLINE TASK -----
+
+// A one-shot void() callable stored in place. Callables that fit
+// `capacity` live in the buffer; larger ones are boxed on the heap.
+class inline_task {
+public:
+  static constexpr std::size_t capacity = 64;
+
+  template <typename F>
+  static constexpr bool stored_inline =
+      sizeof(F) <= capacity && alignof(F) <= alignof(std::max_align_t);
+
+  inline_task() noexcept = default;
+  ~inline_task() { reset(); }
+
+  inline_task(const inline_task &) = delete;
+  inline_task &operator=(const inline_task &) = delete;
+
+  template <typename F> void emplace(F &&f) {
+    using Fn = std::decay_t<F>;
+    reset();
+    if constexpr (stored_inline<Fn>) {
+      ::new (static_cast<void *>(storage_)) Fn(std::forward<F>(f));
+      invoke_ = [](void *p) { (*std::launder(static_cast<Fn *>(p)))(); };
+      destroy_ = [](void *p) noexcept {
+        std::launder(static_cast<Fn *>(p))->~Fn();
+      };
+    } else {
+      ::new (static_cast<void *>(storage_)) Fn *(new Fn(std::forward<F>(f)));
+      invoke_ = [](void *p) { (**std::launder(static_cast<Fn **>(p)))(); };
+      destroy_ = [](void *p) noexcept {
+        delete *std::launder(static_cast<Fn **>(p));
+      };
+    }
+  }
+
+  explicit operator bool() const noexcept { return invoke_ != nullptr; }
+
+  // Runs the callable once, then destroys it.
+  void operator()() {
+    struct cleanup {
+      inline_task &task;
+      ~cleanup() { task.reset(); }
+    } guard{*this};
+    invoke_(storage_);
+  }
+
+  void reset() noexcept {
+    if (destroy_ != nullptr) {
+      destroy_(storage_);
+    }
+    invoke_ = nullptr;
+    destroy_ = nullptr;
+  }
+
+private:
+  alignas(std::max_align_t) std::byte storage_[capacity];
+  void (*invoke_)(void *){nullptr};
+  void (*destroy_)(void *) noexcept {nullptr};
+};
+
+// ----- SHARED STATE -----
+
+template <typename T>
+using stored_t = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+template <typename T>
+class future_state
+    : public intrusive_ref_counter<future_state<T>, thread_safe_counter> {
+public:
+  explicit future_state(thread_pool *pool) noexcept : pool_(pool) {}
+
+  [[nodiscard]] thread_pool *pool() const noexcept { return pool_; }
+
+  // Producer side: store the result, then publish() it exactly once.
+  template <typename... Args> void emplace_value(Args &&...args) {
+    result_.template emplace<1>(std::forward<Args>(args)...);
+  }
+  void emplace_exception(std::exception_ptr e) noexcept {
+    result_.template emplace<2>(std::move(e));
+  }
+  void publish() {
+    unsigned prior = flags_.fetch_or(has_result, std::memory_order_acq_rel);
+    flags_.notify_all();
+    if ((prior & has_continuation) != 0) {
+      run_continuation();
+    }
+  }
+
+  // Consumer side: `fn` runs once the result is in, posted to the pool or
+  // inline on the thread that completes the state.
+  template <typename F> void on_ready(bool on_pool, F &&fn) {
+    on_pool_ = on_pool;
+    continuation_.emplace(std::forward<F>(fn));
+    unsigned prior =
+        flags_.fetch_or(has_continuation, std::memory_order_acq_rel);
+    if ((prior & has_result) != 0) {
+      run_continuation();
+    }
+  }
+
+  [[nodiscard]] bool ready() const noexcept {
+    return (flags_.load(std::memory_order_acquire) & has_result) != 0;
+  }
+
+  void wait() const noexcept {
+    unsigned flags = flags_.load(std::memory_order_acquire);
+    while ((flags & has_result) == 0) {
+      flags_.wait(flags, std::memory_order_acquire);
+      flags = flags_.load(std::memory_order_acquire);
+    }
+  }
+
+  // Valid once ready().
+  [[nodiscard]] bool failed() const noexcept { return result_.index() == 2; }
+  [[nodiscard]] std::exception_ptr exception() const {
+    return std::get<2>(result_);
+  }
+  stored_t<T> &&take() {
+    if (failed()) {
+      std::rethrow_exception(std::get<2>(result_));
+    }
+    return std::move(std::get<1>(result_));
+  }
+
+  // Moves this (ready) result into `to` and publishes it there.
+  void forward_to(future_state &to) {
+    if (failed()) {
+      to.emplace_exception(exception());
+    } else {
+      try {
+        to.emplace_value(std::move(std::get<1>(result_)));
+      } catch (...) {
+        to.emplace_exception(std::current_exception());
+      }
+    }
+    to.publish();
+  }
+
+private:
+  static constexpr unsigned has_result = 1;
+  static constexpr unsigned has_continuation = 2;
+
+  void run_continuation() {
+    // Either way the state stays alive until its continuation has run,
+    // whoever else lets go of it meanwhile.
+    intrusive_ptr<future_state> ref(this);
+    if (!on_pool_) {
+      continuation_();
+      return;
+    }
+    pool_->post([self = ref.get()] {
+      intrusive_ptr<future_state> owned(self, false);
+      owned->continuation_();
+    });
+    static_cast<void>(ref.detach());
+  }
+
+  thread_pool *pool_;
+  std::variant<std::monostate, stored_t<T>, std::exception_ptr> result_;
+  std::atomic<unsigned> flags_{0};
+  bool on_pool_{false};
+  inline_task continuation_;
+};
+
+// Stores what `produce` returns (or throws) into `out` and publishes it.
+template <typename T, typename F> void fulfil(future_state<T> &out, F &&produce) {
+  try {
+    if constexpr (std::is_void_v<T>) {
+      std::forward<F>(produce)();
+      out.emplace_value();
+    } else {
+      out.emplace_value(std::forward<F>(produce)());
+    }
+  } catch (...) {
+    out.emplace_exception(std::current_exception());
+  }
+  out.publish();
+}
+
+template <typename T> void fail(future_state<T> &out, std::exception_ptr e) {
+  out.emplace_exception(std::move(e));
+  out.publish();
+}
+
+struct future_access {
+  template <typename T>
+  static intrusive_ptr<future_state<T>> &state(pool_future<T> &f) noexcept {
+    return f.state_;
+  }
+  template <typename T>
+  static pool_future<T> make(intrusive_ptr<future_state<T>> s) noexcept {
+    return pool_future<T>(std::move(s));
+  }
+};
+
+// ----- CONTINUATION TYPES -----
+
+template <typename F, typename T> struct continuation_result {
+  using type = std::invoke_result_t<F &, T>;
+};
+template <typename F> struct continuation_result<F, void> {
+  using type = std::invoke_result_t<F &>;
+};
+template <typename F, typename T>
+using continuation_result_t = typename continuation_result<F, T>::type;
+
+template <typename R> struct unwrap_future {
+  using type = R;
+  static constexpr bool is_future = false;
+};
+template <typename U> struct unwrap_future<pool_future<U>> {
+  using type = U;
+  static constexpr bool is_future = true;
+};
+
+template <typename F, typename... Args>
+using spawn_result_t =
+    typename unwrap_future<std::invoke_result_t<F, Args...>>::type;
+
+template <typename T, typename F>
+decltype(auto) invoke_with(F &fn, future_state<T> &src) {
+  if constexpr (std::is_void_v<T>) {
+    return std::invoke(fn);
+  } else {
+    return std::invoke(fn, src.take());
+  }
+}
+
+// Runs `produce` into `next`. A produced pool_future<U> is unwrapped: its
+// result is forwarded into `next` when it lands.
+template <typename R, typename U, typename F>
+void deliver(future_state<U> &next, F &&produce) {
+  if constexpr (unwrap_future<R>::is_future) {
+    R inner;
+    try {
+      inner = std::forward<F>(produce)();
+    } catch (...) {
+      fail(next, std::current_exception());
+      return;
+    }
+    if (!inner.valid()) {
+      fail(next, std::make_exception_ptr(
+                     std::future_error(std::future_errc::no_state)));
+      return;
+    }
+    future_state<U> &from = *future_access::state(inner);
+    from.on_ready(false, [&from, to = intrusive_ptr<future_state<U>>(&next)] {
+      from.forward_to(*to);
+    });
+  } else {
+    fulfil(next, std::forward<F>(produce));
+  }
+}
+
+// Body of a then() continuation: runs `fn` on `src`'s value into `next`.
+template <typename R, typename T, typename U, typename F>
+void run_then(future_state<T> &src, future_state<U> &next, F &fn) {
+  if (src.failed()) {
+    fail(next, src.exception());
+    return;
+  }
+  deliver<R>(next, [&]() -> R { return invoke_with(fn, src); });
+}
+
+// ----- COMBINATOR STATE -----
+
+template <typename T> struct all_join {
+  using output = std::conditional_t<std::is_void_v<T>, void, std::vector<T>>;
+
+  std::vector<intrusive_ptr<future_state<T>>> inputs;
+  intrusive_ptr<future_state<output>> out;
+  std::atomic<std::size_t> remaining;
+
+  // The last input to finish builds the output and frees the join.
+  void arrive() {
+    if (remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+      return;
+    }
+    std::unique_ptr<all_join> self(this);
+    for (auto &in : inputs) {
+      if (in->failed()) {
+        fail(*out, in->exception());
+        return;
+      }
+    }
+    fulfil(*out, [&] {
+      if constexpr (!std::is_void_v<T>) {
+        std::vector<T> values;
+        values.reserve(inputs.size());
+        for (auto &in : inputs) {
+          values.push_back(in->take());
+        }
+        return values;
+      }
+    });
+  }
+};
+
+template <typename T> struct any_join {
+  using output =
+      std::conditional_t<std::is_void_v<T>, std::size_t, when_any_result<T>>;
+
+  std::vector<intrusive_ptr<future_state<T>>> inputs;
+  intrusive_ptr<future_state<output>> out;
+  std::atomic<bool> decided{false};
+  std::atomic<std::size_t> remaining;
+
+  // The first input to finish settles the output; the last frees the join.
+  void arrive(std::size_t index) {
+    if (!decided.exchange(true, std::memory_order_acq_rel)) {
+      future_state<T> &in = *inputs[index];
+      if (in.failed()) {
+        fail(*out, in.exception());
+      } else {
+        fulfil(*out, [&] {
+          if constexpr (std::is_void_v<T>) {
+            return index;
+          } else {
+            return when_any_result<T>{index, in.take()};
+          }
+        });
+      }
+    }
+    if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete this;
+    }
+  }
+};
+
+template <typename... Ts> struct tuple_join {
+  using output = std::tuple<stored_t<Ts>...>;
+
+  std::tuple<intrusive_ptr<future_state<Ts>>...> inputs;
+  intrusive_ptr<future_state<output>> out;
+  std::atomic<std::size_t> remaining{sizeof...(Ts)};
+
+  void arrive() {
+    if (remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+      return;
+    }
+    std::unique_ptr<tuple_join> self(this);
+    std::exception_ptr error;
+    std::apply(
+        [&](auto &...in) {
+          ((error = (!error && in->failed()) ? in->exception() : error), ...);
+        },
+        inputs);
+    if (error) {
+      fail(*out, error);
+      return;
+    }
+    fulfil(*out, [&] {
+      return std::apply([](auto &...in) { return output(in->take()...); },
+                        inputs);
+    });
+  }
+};
+
+template <typename T>
+std::vector<intrusive_ptr<future_state<T>>>
+take_states(std::vector<pool_future<T>> &futures, const char *who) {
+  if (futures.empty()) {
+    throw std::invalid_argument(std::string(who) + ": no futures");
+  }
+  std::vector<intrusive_ptr<future_state<T>>> states;
+  states.reserve(futures.size());
+  for (auto &f : futures) {
+    if (!f.valid()) {
+      throw std::future_error(std::future_errc::no_state);
+    }
+  }
+  for (auto &f : futures) {
+    states.push_back(std::move(future_access::state(f)));
+  }
+  return states;
+}
+
+} // namespace detail
+
+// ----- FUTURE -----
+
+template <typename T> class pool_future {
+public:
+  using value_type = T;
+
+  pool_future() noexcept = default;
+
+  [[nodiscard]] bool valid() const noexcept {
+    return static_cast<bool>(state_);
+  }
+
+  [[nodiscard]] bool is_ready() const { return checked().ready(); }
+
+  // Blocks until the result is in.
+  void wait() const { checked().wait(); }
+
+  // Blocks for the result and consumes the future; rethrows a failure.
+  T get();
+
+  // Schedules `f(value)` on the pool once the value arrives and returns a
+  // future for its result. Consumes this future.
+  template <typename F> [[nodiscard]] auto then(F &&f) &&;
+
+private:
+  friend struct detail::future_access;
+
+  explicit pool_future(intrusive_ptr<detail::future_state<T>> s) noexcept
+      : state_(std::move(s)) {}
+
+  detail::future_state<T> &checked() const {
+    if (!state_) {
+      throw std::future_error(std::future_errc::no_state);
+    }
+    return *state_;
+  }
+
+  intrusive_ptr<detail::future_state<T>> state_;
+};
+
+// ----- PROMISE -----
+
+// The producer end for results that do not come from spawn(), e.g. an I/O
+// completion. Destroying it unsatisfied fails the future with
+// broken_promise.
+template <typename T> class pool_promise {
+public:
+  explicit pool_promise(thread_pool &pool)
+      : state_(make_intrusive<detail::future_state<T>>(&pool)) {}
+
+  ~pool_promise() { abandon(); }
+
+  pool_promise(pool_promise &&other) noexcept
+      : state_(std::move(other.state_)), retrieved_(other.retrieved_),
+        satisfied_(other.satisfied_) {}
+  pool_promise &operator=(pool_promise &&other) noexcept {
+    if (this != &other) {
+      abandon();
+      state_ = std::move(other.state_);
+      retrieved_ = other.retrieved_;
+      satisfied_ = other.satisfied_;
+    }
+    return *this;
+  }
+  pool_promise(const pool_promise &) = delete;
+  pool_promise &operator=(const pool_promise &) = delete;
+
+  [[nodiscard]] pool_future<T> get_future() {
+    if (!state_) {
+      throw std::future_error(std::future_errc::no_state);
+    }
+    if (retrieved_) {
+      throw std::future_error(std::future_errc::future_already_retrieved);
+    }
+    retrieved_ = true;
+    return detail::future_access::make(state_);
+  }
+
+  template <typename... Args> void set_value(Args &&...args) {
+    checked();
+    state_->emplace_value(std::forward<Args>(args)...);
+    satisfied_ = true;
+    state_->publish();
+  }
+
+  void set_exception(std::exception_ptr e) {
+    checked();
+    satisfied_ = true;
+    detail::fail(*state_, std::move(e));
+  }
+
+private:
+  void checked() const {
+    if (!state_) {
+      throw std::future_error(std::future_errc::no_state);
+    }
+    if (satisfied_) {
+      throw std::future_error(std::future_errc::promise_already_satisfied);
+    }
+  }
+
+  void abandon() noexcept {
+    if (!state_ || satisfied_) {
+      return;
+    }
+    satisfied_ = true;
+    try {
+      detail::fail(*state_, std::make_exception_ptr(std::future_error(
+                                std::future_errc::broken_promise)));
+    } catch (...) {
+      // The pool is gone; nobody is left to run the continuation.
+    }
+  }
+
+  intrusive_ptr<detail::future_state<T>> state_;
+  bool retrieved_{false};
+  bool satisfied_{false};
+};
+
+// ----- ENTRY POINTS -----
+
+// Runs `f(args...)` on the pool; the pool_future counterpart of
+// thread_pool::submit. Move-only callables are accepted, and a returned
+// pool_future<U> is unwrapped like in then().
+template <typename F, typename... Args>
+auto spawn(thread_pool &pool, F &&f, Args &&...args)
+    -> pool_future<detail::spawn_result_t<F, Args...>>;
+
+// Ready when every input is; carries the values in input order, or the
+// first failure in input order. The result schedules on the first input's
+// pool. Throws std::invalid_argument when `futures` is empty.
+template <typename T>
+auto when_all(std::vector<pool_future<T>> futures)
+    -> pool_future<typename detail::all_join<T>::output>;
+
+// Heterogeneous form: a tuple, with std::monostate for void inputs.
+template <typename T, typename... Ts>
+auto when_all(pool_future<T> first, pool_future<Ts>... rest)
+    -> pool_future<std::tuple<detail::stored_t<T>, detail::stored_t<Ts>...>>;
+
+// Ready when the first input finishes, with its index and value (just the
+// index for void), or its failure. Throws std::invalid_argument when
+// `futures` is empty.
+template <typename T>
+auto when_any(std::vector<pool_future<T>> futures)
+    -> pool_future<typename detail::any_join<T>::output>;
+
+// ============================================================================
+// Implementation
+// ============================================================================
+
+template <typename T> T pool_future<T>::get() {
+  intrusive_ptr<detail::future_state<T>> state = std::move(state_);
+  if (!state) {
+    throw std::future_error(std::future_errc::no_state);
+  }
+  state->wait();
+  if constexpr (std::is_void_v<T>) {
+    state->take();
+  } else {
+    return state->take();
+  }
+}
+
+template <typename T>
+template <typename F>
+auto pool_future<T>::then(F &&f) && {
+  using R = detail::continuation_result_t<std::decay_t<F>, T>;
+  using U = typename detail::unwrap_future<R>::type;
+
+  detail::future_state<T> &src = checked();
+  auto next = make_intrusive<detail::future_state<U>>(src.pool());
+  src.on_ready(true, [&src, next, fn = std::forward<F>(f)]() mutable {
+    detail::run_then<R>(src, *next, fn);
+  });
+  state_.reset();
+  return detail::future_access::make(std::move(next));
+}
+
+template <typename F, typename... Args>
+auto spawn(thread_pool &pool, F &&f, Args &&...args)
+    -> pool_future<detail::spawn_result_t<F, Args...>> {
+  using R = std::invoke_result_t<F, Args...>;
+  using U = detail::spawn_result_t<F, Args...>;
+
+  auto state = make_intrusive<detail::future_state<U>>(&pool);
+  auto job = [state, func = std::forward<F>(f),
+              ... args = std::forward<Args>(args)]() mutable {
+    detail::deliver<R>(*state, [&]() -> R {
+      return std::invoke(func, std::forward<Args>(args)...);
+    });
+  };
+  // Boxed so std::function holds one pointer: no copy requirement on `f`.
+  auto boxed = std::make_unique<decltype(job)>(std::move(job));
+  pool.post([task = boxed.get()] {
+    std::unique_ptr<decltype(job)> owned(task);
+    (*owned)();
+  });
+  static_cast<void>(boxed.release());
+  return detail::future_access::make(std::move(state));
+}
+
+template <typename T>
+auto when_all(std::vector<pool_future<T>> futures)
+    -> pool_future<typename detail::all_join<T>::output> {
+  using join_t = detail::all_join<T>;
+  using output = typename join_t::output;
+
+  auto states = detail::take_states(futures, "when_all");
+  auto out = make_intrusive<detail::future_state<output>>(states[0]->pool());
+  const std::size_t n = states.size();
+  auto *join = new join_t{std::move(states), out, {n}};
+  // The last on_ready() may free the join; nothing touches it afterwards.
+  for (std::size_t i = 0; i < n; ++i) {
+    join->inputs[i]->on_ready(false, [join] { join->arrive(); });
+  }
+  return detail::future_access::make(std::move(out));
+}
+
+template <typename T, typename... Ts>
+auto when_all(pool_future<T> first, pool_future<Ts>... rest)
+    -> pool_future<std::tuple<detail::stored_t<T>, detail::stored_t<Ts>...>> {
+  using join_t = detail::tuple_join<T, Ts...>;
+  using output = typename join_t::output;
+
+  if (!first.valid() || (!rest.valid() || ...)) {
+    throw std::future_error(std::future_errc::no_state);
+  }
+  auto &head = detail::future_access::state(first);
+  auto out = make_intrusive<detail::future_state<output>>(head->pool());
+  auto *join = new join_t{
+      {std::move(head), std::move(detail::future_access::state(rest))...},
+      out};
+  auto raw = std::apply([](auto &...in) { return std::tuple(in.get()...); },
+                        join->inputs);
+  std::apply(
+      [join](auto *...in) {
+        (in->on_ready(false, [join] { join->arrive(); }), ...);
+      },
+      raw);
+  return detail::future_access::make(std::move(out));
+}
+
+template <typename T>
+auto when_any(std::vector<pool_future<T>> futures)
+    -> pool_future<typename detail::any_join<T>::output> {
+  using join_t = detail::any_join<T>;
+  using output = typename join_t::output;
+
+  auto states = detail::take_states(futures, "when_any");
+  auto out = make_intrusive<detail::future_state<output>>(states[0]->pool());
+  const std::size_t n = states.size();
+  auto *join = new join_t{std::move(states), out, {false}, {n}};
+  for (std::size_t i = 0; i < n; ++i) {
+    join->inputs[i]->on_ready(false, [join, i] { join->arrive(i); });
+  }
+  return detail::future_access::make(std::move(out));
+}
+
+} // namespace ds
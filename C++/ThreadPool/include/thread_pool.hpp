@@ -33,6 +33,10 @@ public:
   auto submit(F &&f, Args &&...args)
       -> std::future<std::invoke_result_t<F, Args...>>;
 
+  // Queue a task without a future, for callers that signal completion
+  // themselves (I/O callbacks, coroutine resumption)
+  template <typename F> void post(F &&f);
+
   // Wait for all queued tasks to complete (doesn't shutdown)
   void wait_all();
 
@@ -134,4 +138,8 @@ auto thread_pool::submit(F &&f, Args &&...args)
   return result;
 }
 
+template <typename F> void thread_pool::post(F &&f) {
+  task_queue_.push(std::function<void()>(std::forward<F>(f)));
+}
+
 } // namespace ds
@@ -0,0 +1,194 @@
+#include "parallel_pipeline.hpp"
+#include <algorithm>
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// Input stage yielding 0..n-1.
+auto counter(int n) {
+  return [i = 0, n](ds::flow_control &flow) mutable {
+    if (i >= n) {
+      flow.stop();
+    }
+    return i++;
+  };
+}
+
+// Tracks how many callers are inside at once.
+struct occupancy {
+  std::atomic<int> now{0};
+  std::atomic<int> peak{0};
+
+  void enter() {
+    int n = ++now;
+    int seen = peak.load();
+    while (n > seen && !peak.compare_exchange_weak(seen, n)) {
+    }
+  }
+  void leave() { --now; }
+};
+
+} // namespace
+
+// ------ ORDERING -------
+
+TEST_CASE("an in-order stage sees items in input order", "[pipeline]") {
+  ds::thread_pool pool(4);
+  std::vector<std::string> written;
+  ds::parallel_pipeline pipeline(
+      pool, 8, ds::make_stage(ds::stage_mode::serial_in_order, counter(200)),
+      ds::make_stage(ds::stage_mode::parallel,
+                     [](int v) {
+                       // Uneven work so items overtake each other.
+                       std::this_thread::sleep_for(
+                           std::chrono::microseconds((v * 37) % 200));
+                       return std::to_string(v);
+                     }),
+      ds::make_stage(ds::stage_mode::serial_in_order,
+                     [&](std::string s) { written.push_back(std::move(s)); }));
+  pipeline.run();
+
+  REQUIRE(pipeline.processed() == 200);
+  REQUIRE(written.size() == 200);
+  for (int i = 0; i < 200; ++i) {
+    REQUIRE(written[static_cast<std::size_t>(i)] == std::to_string(i));
+  }
+}
+
+TEST_CASE("serial stages run one item at a time", "[pipeline]") {
+  ds::thread_pool pool(4);
+  occupancy in_order, out_of_order, parallel;
+  std::vector<int> arrivals;
+  ds::parallel_pipeline pipeline(
+      pool, 6, ds::make_stage(ds::stage_mode::serial_in_order, counter(300)),
+      ds::make_stage(ds::stage_mode::parallel,
+                     [&](int v) {
+                       parallel.enter();
+                       std::this_thread::sleep_for(50us);
+                       parallel.leave();
+                       return v;
+                     }),
+      ds::make_stage(ds::stage_mode::serial_out_of_order,
+                     [&](int v) {
+                       out_of_order.enter();
+                       arrivals.push_back(v);
+                       out_of_order.leave();
+                       return v;
+                     }),
+      ds::make_stage(ds::stage_mode::serial_in_order, [&](int) {
+        in_order.enter();
+        in_order.leave();
+      }));
+  pipeline.run();
+
+  REQUIRE(in_order.peak == 1);
+  REQUIRE(out_of_order.peak == 1);
+  REQUIRE(parallel.peak <= 6);
+  std::sort(arrivals.begin(), arrivals.end());
+  for (int i = 0; i < 300; ++i) {
+    REQUIRE(arrivals[static_cast<std::size_t>(i)] == i);
+  }
+}
+
+// ------ TOKENS -------
+
+TEST_CASE("tokens in flight never exceed the cap", "[pipeline][tokens]") {
+  ds::thread_pool pool(4);
+  std::atomic<int> live{0};
+  std::atomic<int> peak{0};
+  ds::parallel_pipeline pipeline(
+      pool, 3,
+      ds::make_stage(ds::stage_mode::serial_out_of_order,
+                     [&, i = 0](ds::flow_control &flow) mutable {
+                       if (i++ == 100) {
+                         flow.stop();
+                         return 0;
+                       }
+                       int n = ++live;
+                       int seen = peak.load();
+                       while (n > seen && !peak.compare_exchange_weak(seen, n)) {
+                       }
+                       return i;
+                     }),
+      ds::make_stage(ds::stage_mode::parallel,
+                     [](int v) {
+                       std::this_thread::sleep_for(20us);
+                       return v;
+                     }),
+      ds::make_stage(ds::stage_mode::serial_out_of_order,
+                     [&](int) { --live; }));
+  pipeline.run();
+
+  REQUIRE(pipeline.processed() == 100);
+  REQUIRE(peak <= 3);
+  REQUIRE(pipeline.peak_in_flight() <= 3);
+}
+
+TEST_CASE("stages overlap instead of adding up", "[pipeline][throughput]") {
+  // Three serial stages of 2 ms each: one at a time that is 6 ms per item;
+  // pipelined, a new item leaves every ~2 ms. Sleeping keeps the check
+  // meaningful on a single core.
+  constexpr int items = 20;
+  ds::thread_pool pool(3);
+  auto step = [](int v) {
+    std::this_thread::sleep_for(2ms);
+    return v;
+  };
+  ds::parallel_pipeline pipeline(
+      pool, 4, ds::make_stage(ds::stage_mode::serial_in_order, counter(items)),
+      ds::make_stage(ds::stage_mode::serial_in_order, step),
+      ds::make_stage(ds::stage_mode::serial_in_order, step),
+      ds::make_stage(ds::stage_mode::serial_in_order,
+                     [&](int v) { static_cast<void>(step(v)); }));
+  auto start = std::chrono::steady_clock::now();
+  pipeline.run();
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  REQUIRE(elapsed < items * 6ms * 3 / 4);
+}
+
+// ------ ERRORS -------
+
+TEST_CASE("a throwing stage cancels the run", "[pipeline][errors]") {
+  ds::thread_pool pool(2);
+  std::atomic<int> sunk{0};
+  ds::parallel_pipeline pipeline(
+      pool, 4, ds::make_stage(ds::stage_mode::serial_in_order, counter(1000)),
+      ds::make_stage(ds::stage_mode::parallel,
+                     [](int v) {
+                       if (v == 10) {
+                         throw std::runtime_error("bad record");
+                       }
+                       return v;
+                     }),
+      ds::make_stage(ds::stage_mode::serial_in_order, [&](int) { ++sunk; }));
+  REQUIRE_THROWS_AS(pipeline.run(), std::runtime_error);
+  REQUIRE(sunk < 1000);
+
+  // The pipeline can run again; its input carries on where it stopped.
+  int before = sunk;
+  pipeline.run();
+  REQUIRE(sunk > before);
+}
+
+TEST_CASE("invalid configurations are rejected", "[pipeline][errors]") {
+  ds::thread_pool pool(1);
+  auto sink = [](int) {};
+  REQUIRE_THROWS_AS(
+      ds::parallel_pipeline(
+          pool, 0, ds::make_stage(ds::stage_mode::serial_in_order, counter(1)),
+          ds::make_stage(ds::stage_mode::parallel, sink)),
+      std::invalid_argument);
+  REQUIRE_THROWS_AS(
+      ds::parallel_pipeline(
+          pool, 4, ds::make_stage(ds::stage_mode::parallel, counter(1)),
+          ds::make_stage(ds::stage_mode::parallel, sink)),
+      std::invalid_argument);
+}
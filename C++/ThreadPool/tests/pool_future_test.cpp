@@ -0,0 +1,248 @@
+#include "pool_future.hpp"
+#include "require_no_alloc.hpp"
+#include <array>
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+// ------ THEN -------
+
+TEST_CASE("spawn delivers a value and rethrows a failure", "[future]") {
+  ds::thread_pool pool(2);
+  REQUIRE(ds::spawn(pool, [](int a, int b) { return a + b; }, 2, 3).get() ==
+          5);
+
+  auto failing = ds::spawn(pool, []() -> int {
+    throw std::runtime_error("boom");
+  });
+  REQUIRE_THROWS_AS(failing.get(), std::runtime_error);
+  REQUIRE_FALSE(failing.valid());
+  REQUIRE_THROWS_AS(failing.get(), std::future_error);
+
+  auto owned = std::make_unique<int>(7);
+  REQUIRE(ds::spawn(pool, [p = std::move(owned)] { return *p; }).get() == 7);
+}
+
+TEST_CASE("then chains run on the pool", "[future][then]") {
+  ds::thread_pool pool(1);
+  std::thread::id worker = pool.submit([] {
+                                 return std::this_thread::get_id();
+                               }).get();
+
+  std::atomic<bool> all_on_pool{true};
+  auto on_pool = [&] {
+    if (std::this_thread::get_id() != worker) {
+      all_on_pool = false;
+    }
+  };
+  auto result = ds::spawn(pool, [] { return std::string("4"); })
+                    .then([&](std::string s) {
+                      on_pool();
+                      return std::stoi(s);
+                    })
+                    .then([&](int v) {
+                      on_pool();
+                      return v * 10;
+                    })
+                    .then([&](int) { on_pool(); })
+                    .then([&] {
+                      on_pool();
+                      return std::string("done");
+                    });
+  REQUIRE(result.get() == "done");
+  REQUIRE(all_on_pool);
+}
+
+TEST_CASE("then attached after the result still runs", "[future][then]") {
+  ds::thread_pool pool(1);
+  ds::pool_promise<int> promise(pool);
+  auto future = promise.get_future();
+  promise.set_value(20);
+  REQUIRE(future.is_ready());
+  REQUIRE(std::move(future).then([](int v) { return v + 1; }).get() == 21);
+}
+
+TEST_CASE("a failure skips later stages", "[future][then]") {
+  ds::thread_pool pool(1);
+  std::atomic<int> stages{0};
+  auto result = ds::spawn(pool, [&] {
+                  ++stages;
+                  return 1;
+                })
+                    .then([&](int) -> int {
+                      ++stages;
+                      throw std::out_of_range("stage two");
+                    })
+                    .then([&](int v) {
+                      ++stages;
+                      return v;
+                    });
+  REQUIRE_THROWS_AS(result.get(), std::out_of_range);
+  REQUIRE(stages == 2);
+}
+
+TEST_CASE("a continuation returning a future is unwrapped", "[future][then]") {
+  ds::thread_pool pool(1);
+  auto result = ds::spawn(pool, [] { return 3; }).then([&pool](int v) {
+    return ds::spawn(pool, [v] { return v * v; });
+  });
+  static_assert(std::is_same_v<decltype(result), ds::pool_future<int>>);
+  REQUIRE(result.get() == 9);
+}
+
+TEST_CASE("nested pipelines never park the only worker", "[future][then]") {
+  // Every stage below runs on a single worker; any blocking wait inside the
+  // pool would deadlock.
+  ds::thread_pool pool(1);
+  auto outer = ds::spawn(pool, [&pool] {
+                 std::vector<ds::pool_future<int>> parts;
+                 for (int i = 1; i <= 8; ++i) {
+                   parts.push_back(ds::spawn(pool, [i] { return i; })
+                                       .then([](int v) { return v * 2; }));
+                 }
+                 return ds::when_all(std::move(parts));
+               }).then([](std::vector<int> values) {
+    int sum = 0;
+    for (int v : values) {
+      sum += v;
+    }
+    return sum;
+  });
+  REQUIRE(outer.get() == 72);
+}
+
+// ------ COMBINATORS -------
+
+TEST_CASE("when_all keeps input order", "[future][when_all]") {
+  ds::thread_pool pool(3);
+  std::vector<ds::pool_future<int>> futures;
+  for (int i = 0; i < 16; ++i) {
+    futures.push_back(ds::spawn(pool, [i] {
+      std::this_thread::sleep_for(std::chrono::microseconds((16 - i) * 50));
+      return i;
+    }));
+  }
+  auto values = ds::when_all(std::move(futures)).get();
+  REQUIRE(values.size() == 16);
+  for (int i = 0; i < 16; ++i) {
+    REQUIRE(values[static_cast<std::size_t>(i)] == i);
+  }
+
+  std::vector<ds::pool_future<void>> none;
+  REQUIRE_THROWS_AS(ds::when_all(std::move(none)), std::invalid_argument);
+}
+
+TEST_CASE("when_all over void and mixed futures", "[future][when_all]") {
+  ds::thread_pool pool(2);
+  std::atomic<int> ran{0};
+  std::vector<ds::pool_future<void>> chores;
+  for (int i = 0; i < 4; ++i) {
+    chores.push_back(ds::spawn(pool, [&] { ++ran; }));
+  }
+  ds::when_all(std::move(chores)).get();
+  REQUIRE(ran == 4);
+
+  auto [n, text, nothing] =
+      ds::when_all(ds::spawn(pool, [] { return 1; }),
+                   ds::spawn(pool, [] { return std::string("two"); }),
+                   ds::spawn(pool, [] {}))
+          .get();
+  REQUIRE(n == 1);
+  REQUIRE(text == "two");
+  REQUIRE(nothing == std::monostate{});
+}
+
+TEST_CASE("when_all reports the first failure in input order",
+          "[future][when_all]") {
+  ds::thread_pool pool(2);
+  ds::pool_promise<int> a(pool), b(pool), c(pool);
+  std::vector<ds::pool_future<int>> futures;
+  futures.push_back(a.get_future());
+  futures.push_back(b.get_future());
+  futures.push_back(c.get_future());
+  auto all = ds::when_all(std::move(futures));
+
+  c.set_exception(std::make_exception_ptr(std::logic_error("c")));
+  b.set_exception(std::make_exception_ptr(std::out_of_range("b")));
+  REQUIRE_FALSE(all.is_ready());
+  a.set_value(1);
+  REQUIRE_THROWS_AS(all.get(), std::out_of_range);
+}
+
+TEST_CASE("when_any settles on the first result", "[future][when_any]") {
+  ds::thread_pool pool(1);
+  ds::pool_promise<std::string> slow(pool), fast(pool), never(pool);
+  std::vector<ds::pool_future<std::string>> futures;
+  futures.push_back(slow.get_future());
+  futures.push_back(fast.get_future());
+  futures.push_back(never.get_future());
+  auto first = ds::when_any(std::move(futures));
+
+  fast.set_value("fast");
+  slow.set_value("slow");
+  auto winner = first.get();
+  REQUIRE(winner.index == 1);
+  REQUIRE(winner.value == "fast");
+  // `never` is abandoned at scope exit; the combinator ignores it.
+
+  std::vector<ds::pool_future<void>> chores;
+  ds::pool_promise<void> idle(pool);
+  chores.push_back(idle.get_future());
+  chores.push_back(ds::spawn(pool, [] {}));
+  REQUIRE(ds::when_any(std::move(chores)).get() == 1);
+  idle.set_value();
+}
+
+// ------ PROMISE -------
+
+TEST_CASE("promise misuse is reported as future_error", "[future][promise]") {
+  ds::thread_pool pool(1);
+  ds::pool_future<int> orphan;
+  {
+    ds::pool_promise<int> promise(pool);
+    orphan = promise.get_future();
+    REQUIRE_THROWS_AS(promise.get_future(), std::future_error);
+  }
+  try {
+    orphan.get();
+    FAIL("expected broken_promise");
+  } catch (const std::future_error &e) {
+    REQUIRE(e.code() == std::future_errc::broken_promise);
+  }
+
+  ds::pool_promise<int> promise(pool);
+  promise.set_value(1);
+  REQUIRE_THROWS_AS(promise.set_value(2), std::future_error);
+  REQUIRE(promise.get_future().get() == 1);
+}
+
+// ------ INLINE STORAGE -------
+
+TEST_CASE("small continuations are stored without allocating",
+          "[future][alloc]") {
+  ds::detail::inline_task task;
+  int hits = 0;
+  std::array<long, 4> payload{1, 2, 3, 4};
+  REQUIRE_NO_ALLOC {
+    task.emplace([&hits, payload] { hits += static_cast<int>(payload[3]); });
+    task();
+  }
+  REQUIRE(hits == 4);
+  REQUIRE_FALSE(task);
+
+  std::array<long, 32> big{};
+  big[31] = 5;
+  static_assert(!ds::detail::inline_task::stored_inline<decltype([big] {})>);
+  task.emplace([&hits, big] { hits += static_cast<int>(big[31]); });
+  task();
+  REQUIRE(hits == 9);
+}
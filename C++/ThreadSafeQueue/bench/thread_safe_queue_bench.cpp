@@ -0,0 +1,102 @@
+#include "benchmark.hpp"
+#include "conflating_queue.hpp"
+#include "queue_selector.hpp"
+#include "thread_safe_queue.hpp"
+#include <array>
+#include <utility>
+#include <thread>
+
+int main(int argc, char **argv) {
+  ds::bench::runner runner(argc, argv, "thread_safe_queue");
+
+  runner.add("push_pop/single_thread", [](ds::bench::state &st) {
+    ds::thread_safe_queue<int> q;
+    int out = 0;
+    for (std::size_t i = 0; i < st.iterations(); ++i) {
+      q.push(static_cast<int>(i));
+      q.try_pop(out);
+      ds::bench::do_not_optimize(out);
+    }
+  });
+
+  runner.add("push_pop/one_producer_one_consumer", [](ds::bench::state &st) {
+    ds::thread_safe_queue<std::size_t> q;
+    std::thread consumer([&] {
+      std::size_t out = 0;
+      for (std::size_t i = 0; i < st.iterations(); ++i) {
+        q.wait_and_pop(out);
+      }
+      ds::bench::do_not_optimize(out);
+    });
+    for (std::size_t i = 0; i < st.iterations(); ++i) {
+      q.push(i);
+    }
+    consumer.join();
+  });
+
+  // Bursts of price updates over 64 keys, drained every 1024 updates; one
+  // op is one update. The conflating queue hands the consumer one entry per
+  // key per drain instead of every update.
+  runner.add("burst_drain/thread_safe_queue", [](ds::bench::state &st) {
+    ds::thread_safe_queue<std::pair<int, double>> q;
+    std::pair<int, double> out;
+    for (std::size_t i = 0; i < st.iterations(); ++i) {
+      q.push({static_cast<int>(i % 64), static_cast<double>(i)});
+      if (i % 1024 == 1023) {
+        while (q.try_pop(out)) {
+          ds::bench::do_not_optimize(out);
+        }
+      }
+    }
+  });
+
+  runner.add("burst_drain/conflating_queue", [](ds::bench::state &st) {
+    ds::conflating_queue<int, double> q;
+    std::pair<int, double> out;
+    for (std::size_t i = 0; i < st.iterations(); ++i) {
+      q.push(static_cast<int>(i % 64), static_cast<double>(i));
+      if (i % 1024 == 1023) {
+        while (q.try_pop(out)) {
+          ds::bench::do_not_optimize(out);
+        }
+      }
+    }
+  });
+
+  // One consumer over four queues fed by one producer; one op is one
+  // element. The selector sleeps when all are empty where the poller spins.
+  auto fan_in = [](ds::bench::state &st, bool use_selector) {
+    std::array<ds::thread_safe_queue<std::size_t>, 4> queues;
+    ds::queue_selector sel(ds::select_policy::round_robin);
+    for (auto &q : queues) {
+      sel.add(q);
+    }
+    std::thread consumer([&] {
+      std::size_t out = 0;
+      std::size_t received = 0;
+      std::size_t next = 0;
+      while (received < st.iterations()) {
+        if (use_selector) {
+          if (auto i = sel.wait_any(); i && queues[*i].try_pop(out)) {
+            ++received;
+          }
+        } else if (queues[next++ % 4].try_pop(out)) {
+          ++received;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+      ds::bench::do_not_optimize(out);
+    });
+    for (std::size_t i = 0; i < st.iterations(); ++i) {
+      queues[i % 4].push(i);
+    }
+    consumer.join();
+  };
+  runner.add("fan_in/busy_poll",
+             [&](ds::bench::state &st) { fan_in(st, false); });
+  runner.add("fan_in/queue_selector",
+             [&](ds::bench::state &st) { fan_in(st, true); });
+
+  return runner.run();
+}
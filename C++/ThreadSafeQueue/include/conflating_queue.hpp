@@ -0,0 +1,293 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ds {
+
+/*
+ * conflating_queue<Key, Value>
+ * A thread_safe_queue for state updates (prices, positions, statuses) where
+ * only the newest value per key matters. Each key has at most one pending
+ * entry; pushing a key that is already pending overwrites its value in
+ * place and the key keeps its place in line:
+ *
+ *   push(A,1) push(B,1) push(A,2) push(C,1) push(A,3)
+ *
+ *   pending:  A=3 -> B=1 -> C=1        (A stays first)
+ *
+ * A slow consumer therefore does at most one pop per distinct key however
+ * fast producers publish, and the queue never holds more entries than there
+ * are keys.
+ *
+ * Each key gets a slot the first time it is seen and keeps it; pending
+ * slots are chained into a FIFO through indices. Once every key has been
+ * seen, push and pop touch only the index map and the slot, with no
+ * allocation. This suits a fixed universe of keys such as instruments;
+ * slots are not reclaimed when a key goes quiet.
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+class conflating_queue {
+public:
+  using entry = std::pair<Key, Value>;
+
+  conflating_queue() = default;
+  ~conflating_queue();
+
+  // Non copyable, non movable
+  conflating_queue(const conflating_queue &) = delete;
+  conflating_queue &operator=(const conflating_queue &) = delete;
+  conflating_queue(conflating_queue &&) = delete;
+  conflating_queue &operator=(conflating_queue &&) = delete;
+
+  // ----- PRODUCER API ----
+
+  // Returns true if the key was queued, false if a pending value for it
+  // was overwritten.
+  bool push(const Key &key, const Value &value);
+  bool push(const Key &key, Value &&value);
+
+  // ----- CONSUMER API ----
+
+  // Non-blocking - returns false if empty
+  bool try_pop(entry &out);
+  [[nodiscard]] std::optional<entry> try_pop();
+
+  // Blocking wait (forever) - returns false only on shutdown
+  bool wait_and_pop(entry &out);
+  [[nodiscard]] std::optional<entry> wait_and_pop();
+
+  // Blocking wait with timeout - returns false on shutdown OR timeout
+  template <typename Rep, typename Period>
+  bool wait_for(entry &out, std::chrono::duration<Rep, Period> timeout);
+
+  // ------ LIFECYCLE -------
+  void shutdown();
+  [[nodiscard]] bool is_shutdown() const;
+
+  // ------- CAPACITY -------
+
+  // Pending keys.
+  [[nodiscard]] std::size_t size() const;
+  [[nodiscard]] bool empty() const;
+  // Distinct keys ever pushed.
+  [[nodiscard]] std::size_t keys() const;
+  // Pushes absorbed by overwriting a pending value.
+  [[nodiscard]] std::uint64_t conflated() const;
+
+private:
+  static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+  struct slot {
+    Key key;
+    Value value;
+    std::size_t next{npos};
+    bool pending{false};
+  };
+
+  template <typename V> bool store(const Key &key, V &&value);
+  entry take_front();
+
+  std::unordered_map<Key, std::size_t, Hash, KeyEqual> index_;
+  std::vector<slot> slots_;
+  std::size_t head_{npos};
+  std::size_t tail_{npos};
+  std::size_t pending_{0};
+  std::uint64_t conflated_{0};
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  bool shutdown_{false};
+};
+
+// Destructor Implementation
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+conflating_queue<Key, Value, Hash, KeyEqual>::~conflating_queue() {
+  shutdown();
+}
+
+// Lifecycle API Implementation
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+void conflating_queue<Key, Value, Hash, KeyEqual>::shutdown() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutdown_ = true;
+  }
+  cv_.notify_all();
+}
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+bool conflating_queue<Key, Value, Hash, KeyEqual>::is_shutdown() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return shutdown_;
+}
+
+// Capacity API implementation
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+std::size_t conflating_queue<Key, Value, Hash, KeyEqual>::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return pending_;
+}
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+bool conflating_queue<Key, Value, Hash, KeyEqual>::empty() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return pending_ == 0;
+}
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+std::size_t conflating_queue<Key, Value, Hash, KeyEqual>::keys() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return slots_.size();
+}
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+std::uint64_t conflating_queue<Key, Value, Hash, KeyEqual>::conflated() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return conflated_;
+}
+
+// Producer API Implementation
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+bool conflating_queue<Key, Value, Hash, KeyEqual>::push(const Key &key,
+                                                        const Value &value) {
+  return store(key, value);
+}
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+bool conflating_queue<Key, Value, Hash, KeyEqual>::push(const Key &key,
+                                                        Value &&value) {
+  return store(key, std::move(value));
+}
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+template <typename V>
+bool conflating_queue<Key, Value, Hash, KeyEqual>::store(const Key &key,
+                                                         V &&value) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (shutdown_) {
+      throw std::runtime_error("push() called on shutdown queue");
+    }
+    auto [it, inserted] = index_.try_emplace(key, slots_.size());
+    if (inserted) {
+      try {
+        slots_.push_back(slot{key, std::forward<V>(value)});
+      } catch (...) {
+        index_.erase(it);
+        throw;
+      }
+    } else {
+      slot &s = slots_[it->second];
+      s.value = std::forward<V>(value);
+      if (s.pending) {
+        ++conflated_;
+        return false;
+      }
+    }
+    // Append the key's slot to the pending chain.
+    std::size_t i = it->second;
+    slots_[i].pending = true;
+    slots_[i].next = npos;
+    if (tail_ == npos) {
+      head_ = i;
+    } else {
+      slots_[tail_].next = i;
+    }
+    tail_ = i;
+    ++pending_;
+  }
+  cv_.notify_one();
+  return true;
+}
+
+// ------ CONSUMER API (non blocking) ------
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+auto conflating_queue<Key, Value, Hash, KeyEqual>::take_front() -> entry {
+  slot &s = slots_[head_];
+  entry out{s.key, std::move(s.value)};
+  s.pending = false;
+  head_ = s.next;
+  if (head_ == npos) {
+    tail_ = npos;
+  }
+  --pending_;
+  return out;
+}
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+bool conflating_queue<Key, Value, Hash, KeyEqual>::try_pop(entry &out) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (pending_ == 0) {
+    return false;
+  }
+  out = take_front();
+  return true;
+}
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+auto conflating_queue<Key, Value, Hash, KeyEqual>::try_pop()
+    -> std::optional<entry> {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (pending_ == 0) {
+    return std::nullopt;
+  }
+  return take_front();
+}
+
+// ------- CONSUMER API (blocking) --------
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+bool conflating_queue<Key, Value, Hash, KeyEqual>::wait_and_pop(entry &out) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [this] { return pending_ != 0 || shutdown_; });
+  if (pending_ == 0) {
+    return false;
+  }
+  out = take_front();
+  return true;
+}
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+auto conflating_queue<Key, Value, Hash, KeyEqual>::wait_and_pop()
+    -> std::optional<entry> {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [this] { return pending_ != 0 || shutdown_; });
+  if (pending_ == 0) {
+    return std::nullopt;
+  }
+  return take_front();
+}
+
+// --------- CONSUMER API (blocking with timeout) ------
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+template <typename Rep, typename Period>
+bool conflating_queue<Key, Value, Hash, KeyEqual>::wait_for(
+    entry &out, std::chrono::duration<Rep, Period> timeout) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  bool success = cv_.wait_for(lock, timeout,
+                              [this] { return pending_ != 0 || shutdown_; });
+  if (!success || pending_ == 0) {
+    return false;
+  }
+  out = take_front();
+  return true;
+}
+
+} // namespace ds
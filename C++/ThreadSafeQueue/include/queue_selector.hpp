@@ -0,0 +1,178 @@
+#pragma once
+
+#include "select_signal.hpp"
+#include "thread_safe_queue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace ds {
+
+/*
+ * queue_selector
+ * Lets one consumer block until any of several thread_safe_queues has data,
+ * instead of a thread per queue or a try_pop busy loop:
+ *
+ *   queue_selector sel(select_policy::priority);
+ *   sel.add(urgent);   // index 0
+ *   sel.add(normal);   // index 1
+ *   while (auto i = sel.wait_any()) {
+ *     if (*i == 0 && urgent.try_pop(msg)) ...
+ *   }
+ *
+ * Each watched queue holds a pointer to the selector's select_signal and
+ * bumps its epoch on every push and on shutdown(). wait_any() reads the
+ * epoch, scans the queues, and sleeps only if the epoch has not moved since,
+ * so a push between the scan and the sleep is never missed. Pushes to a
+ * queue nobody selects on pay one null check.
+ *
+ *   priority      the lowest ready index wins
+ *   round_robin   the scan starts after the index returned last, so a busy
+ *                 queue cannot starve the others
+ *
+ * The index only says the queue was non-empty: with several consumers
+ * another may pop first, so try_pop() it and select again on failure.
+ * wait_any() returns nullopt once every queue is shut down and drained, or
+ * after the selector's own shutdown(). Queues must outlive the selector,
+ * and a queue can be watched by one selector at a time.
+ */
+
+enum class select_policy { priority, round_robin };
+
+class queue_selector {
+public:
+  using clock = std::chrono::steady_clock;
+
+  explicit queue_selector(select_policy policy = select_policy::priority)
+      : policy_(policy) {}
+
+  ~queue_selector() {
+    for (source &s : sources_) {
+      s.watch(s.queue, nullptr);
+    }
+  }
+
+  // Non copyable, non movable
+  queue_selector(const queue_selector &) = delete;
+  queue_selector &operator=(const queue_selector &) = delete;
+  queue_selector(queue_selector &&) = delete;
+  queue_selector &operator=(queue_selector &&) = delete;
+
+  // Watches `queue` and returns its index. Call before any waiting starts.
+  // Throws std::logic_error if another selector already watches it.
+  template <typename T, typename Container, typename Mutex>
+  std::size_t add(thread_safe_queue<T, Container, Mutex> &queue) {
+    using queue_type = thread_safe_queue<T, Container, Mutex>;
+    source s{
+        &queue,
+        [](void *q) { return !static_cast<queue_type *>(q)->empty(); },
+        [](void *q) {
+          // Nothing can be pushed after shutdown, so this cannot flip back.
+          auto *typed = static_cast<queue_type *>(q);
+          return typed->is_shutdown() && typed->empty();
+        },
+        [](void *q, detail::select_signal *signal) {
+          static_cast<queue_type *>(q)->watch(signal);
+        }};
+    sources_.reserve(sources_.size() + 1);
+    queue.watch(&signal_);
+    sources_.push_back(s);
+    return sources_.size() - 1;
+  }
+
+  [[nodiscard]] std::size_t size() const noexcept { return sources_.size(); }
+
+  // ----- SELECTION -----
+
+  // Non-blocking - index of a non-empty queue, or nullopt
+  [[nodiscard]] std::optional<std::size_t> try_select() {
+    return scan().ready;
+  }
+
+  // Blocking wait (forever) - nullopt only on shutdown
+  [[nodiscard]] std::optional<std::size_t> wait_any() {
+    return wait_until(clock::time_point::max());
+  }
+
+  // Blocking wait with timeout - nullopt on shutdown OR timeout
+  template <typename Rep, typename Period>
+  [[nodiscard]] std::optional<std::size_t>
+  wait_for(std::chrono::duration<Rep, Period> timeout) {
+    return wait_until(
+        clock::now() + std::chrono::duration_cast<clock::duration>(timeout));
+  }
+
+  // ------ LIFECYCLE -------
+
+  // Wakes every waiter; later waits return nullopt at once. The queues
+  // themselves are left running.
+  void shutdown() {
+    shutdown_.store(true);
+    signal_.notify();
+  }
+  [[nodiscard]] bool is_shutdown() const { return shutdown_.load(); }
+
+private:
+  struct source {
+    void *queue;
+    bool (*ready)(void *);
+    bool (*finished)(void *);
+    void (*watch)(void *, detail::select_signal *);
+  };
+
+  struct scan_result {
+    std::optional<std::size_t> ready;
+    bool all_finished{false};
+  };
+
+  scan_result scan() {
+    scan_result result;
+    std::size_t n = sources_.size();
+    std::size_t start =
+        policy_ == select_policy::round_robin && n != 0
+            ? next_.load(std::memory_order_relaxed) % n
+            : 0;
+    bool all_finished = n != 0;
+    for (std::size_t k = 0; k < n; ++k) {
+      std::size_t i = (start + k) % n;
+      const source &s = sources_[i];
+      if (s.ready(s.queue)) {
+        next_.store(i + 1, std::memory_order_relaxed);
+        result.ready = i;
+        return result;
+      }
+      all_finished = all_finished && s.finished(s.queue);
+    }
+    result.all_finished = all_finished;
+    return result;
+  }
+
+  std::optional<std::size_t> wait_until(clock::time_point until) {
+    while (!shutdown_.load()) {
+      std::uint64_t seen = signal_.prepare();
+      scan_result result = scan();
+      if (result.ready || result.all_finished || shutdown_.load()) {
+        signal_.cancel();
+        return result.ready;
+      }
+      if (clock::now() >= until) {
+        signal_.cancel();
+        return std::nullopt;
+      }
+      signal_.wait_until(seen, until);
+    }
+    return std::nullopt;
+  }
+
+  select_policy policy_;
+  std::vector<source> sources_;
+  detail::select_signal signal_;
+  std::atomic<bool> shutdown_{false};
+  std::atomic<std::size_t> next_{0};
+};
+
+} // namespace ds
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace ds::detail {
+
+// The wake-up point a queue_selector shares with the queues it watches.
+// Queues call notify() whenever they gain an element or shut down; the
+// selector records epoch() before scanning its queues and sleeps only while
+// the epoch is unchanged. notify() skips the mutex unless someone sleeps.
+class select_signal {
+public:
+  void notify() {
+    epoch_.fetch_add(1);
+    if (waiters_.load() != 0) {
+      // Taking the mutex orders us after a waiter's final epoch check.
+      { std::lock_guard<std::mutex> lock(mutex_); }
+      cv_.notify_all();
+    }
+  }
+
+  // Registers a prospective waiter and returns the epoch to wait on.
+  [[nodiscard]] std::uint64_t prepare() {
+    waiters_.fetch_add(1);
+    return epoch_.load();
+  }
+
+  // Sleeps until the epoch moves past `seen` or `until`; ends the waiter
+  // registration prepare() started.
+  void wait_until(std::uint64_t seen,
+                  std::chrono::steady_clock::time_point until) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait_until(lock, until, [&] { return epoch_.load() != seen; });
+    }
+    waiters_.fetch_sub(1);
+  }
+
+  void cancel() { waiters_.fetch_sub(1); }
+
+private:
+  std::atomic<std::uint64_t> epoch_{0};
+  std::atomic<std::uint32_t> waiters_{0};
+  std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
+} // namespace ds::detail
@@ -1,19 +1,42 @@
 #pragma once
 
+#include "profiled_mutex.hpp"
+#include "select_signal.hpp"
+
 #include <algorithm>
 #include <chrono>
 #include <condition_variable>
+#include <deque>
 #include <mutex>
 #include <optional>
 #include <queue>
 #include <stdexcept>
+#include <string_view>
+#include <type_traits>
 #include <utility>
 
 namespace ds {
 
-template <typename T> class thread_safe_queue {
+class queue_selector;
+
+// Container is the std::queue backing store; a std::pmr::deque (or a deque
+// with a ds::memory allocator) keeps node allocations off the global heap.
+// Mutex may be ds::profiled_mutex to record contention under the
+// "thread_safe_queue" lock site (see profiled_thread_safe_queue below).
+// One consumer can block on several queues at once with a queue_selector
+// (queue_selector.hpp).
+template <typename T, typename Container = std::deque<T>,
+          typename Mutex = std::mutex>
+class thread_safe_queue {
+  // std::condition_variable only works with std::unique_lock<std::mutex>.
+  using condition = std::conditional_t<std::is_same_v<Mutex, std::mutex>,
+                                       std::condition_variable,
+                                       std::condition_variable_any>;
+
 public:
   thread_safe_queue() = default;
+  explicit thread_safe_queue(const typename Container::allocator_type &alloc)
+      : queue_(alloc) {}
   ~thread_safe_queue();
 
   // Non copyable, non movable
@@ -55,84 +78,127 @@ public:
   [[nodiscard]] bool empty() const;
 
 private:
-  std::queue<T> queue_;
-  mutable std::mutex mutex_;
-  std::condition_variable cv_;
+  friend class queue_selector;
+
+  // A queue_selector watching this queue; at most one at a time.
+  void watch(detail::select_signal *signal) {
+    std::lock_guard<Mutex> lock(mutex_);
+    if (signal != nullptr && signal_ != nullptr) {
+      throw std::logic_error("thread_safe_queue: already watched by a "
+                             "queue_selector");
+    }
+    signal_ = signal;
+  }
+
+  void notify_watcher() {
+    if (signal_ != nullptr) {
+      signal_->notify();
+    }
+  }
+
+  static Mutex make_mutex() {
+    if constexpr (std::is_constructible_v<Mutex, std::string_view>) {
+      return Mutex("thread_safe_queue");
+    } else {
+      return Mutex();
+    }
+  }
+
+  std::queue<T, Container> queue_;
+  mutable Mutex mutex_ = make_mutex();
+  condition cv_;
   bool shutdown_{false};
+  detail::select_signal *signal_{nullptr};
 };
 
+template <typename T>
+using profiled_thread_safe_queue =
+    thread_safe_queue<T, std::deque<T>, profiled_mutex>;
+
 // Destructor Implementation
 
-template <typename T> thread_safe_queue<T>::~thread_safe_queue() { shutdown(); }
+template <typename T, typename Container, typename Mutex>
+thread_safe_queue<T, Container, Mutex>::~thread_safe_queue() { shutdown(); }
 
 // Lifecycle API Implementation
 
-template <typename T> void thread_safe_queue<T>::shutdown() {
+template <typename T, typename Container, typename Mutex>
+void thread_safe_queue<T, Container, Mutex>::shutdown() {
   {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<Mutex> lock(mutex_);
     shutdown_ = true;
+    notify_watcher();
   }
   cv_.notify_all();
 }
 
-template <typename T> bool thread_safe_queue<T>::is_shutdown() const {
-  std::lock_guard<std::mutex> lock(mutex_);
+template <typename T, typename Container, typename Mutex>
+bool thread_safe_queue<T, Container, Mutex>::is_shutdown() const {
+  std::lock_guard<Mutex> lock(mutex_);
   return shutdown_;
 }
 
 // Capacity API implementation
 
-template <typename T> size_t thread_safe_queue<T>::size() const {
-  std::lock_guard<std::mutex> lock(mutex_);
+template <typename T, typename Container, typename Mutex>
+size_t thread_safe_queue<T, Container, Mutex>::size() const {
+  std::lock_guard<Mutex> lock(mutex_);
   return queue_.size();
 }
 
-template <typename T> bool thread_safe_queue<T>::empty() const {
-  std::lock_guard<std::mutex> lock(mutex_);
+template <typename T, typename Container, typename Mutex>
+bool thread_safe_queue<T, Container, Mutex>::empty() const {
+  std::lock_guard<Mutex> lock(mutex_);
   return queue_.empty();
 }
 
 // Producer API Implementation
 
-template <typename T> void thread_safe_queue<T>::push(const T &value) {
+template <typename T, typename Container, typename Mutex>
+void thread_safe_queue<T, Container, Mutex>::push(const T &value) {
   {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<Mutex> lock(mutex_);
     if (shutdown_) {
       throw std::runtime_error("push() called on shutdown queue");
     }
     queue_.push(value);
+    notify_watcher();
   }
   cv_.notify_one();
 }
 
-template <typename T> void thread_safe_queue<T>::push(T &&value) {
+template <typename T, typename Container, typename Mutex>
+void thread_safe_queue<T, Container, Mutex>::push(T &&value) {
   {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<Mutex> lock(mutex_);
     if (shutdown_) {
       throw std::runtime_error("push() called on shutdown queue");
     }
     queue_.push(std::move(value));
+    notify_watcher();
   }
   cv_.notify_one();
 }
 
-template <typename T>
+template <typename T, typename Container, typename Mutex>
 template <typename... Args>
-void thread_safe_queue<T>::emplace(Args &&...args) {
+void thread_safe_queue<T, Container, Mutex>::emplace(Args &&...args) {
   {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<Mutex> lock(mutex_);
     if (shutdown_) {
       throw std::runtime_error("emplace() called on shutdown queue");
     }
     queue_.emplace(std::forward<Args>(args)...);
+    notify_watcher();
   }
   cv_.notify_one();
 }
 
 // ------ CONSUMER API (non blocking) ------
 
-template <typename T> bool thread_safe_queue<T>::try_pop(T &out) {
-  std::lock_guard<std::mutex> lock(mutex_);
+template <typename T, typename Container, typename Mutex>
+bool thread_safe_queue<T, Container, Mutex>::try_pop(T &out) {
+  std::lock_guard<Mutex> lock(mutex_);
   if (queue_.empty()) {
     return false;
   }
@@ -141,8 +207,9 @@ template <typename T> bool thread_safe_queue<T>::try_pop(T &out) {
   return true;
 }
 
-template <typename T> std::optional<T> thread_safe_queue<T>::try_pop() {
-  std::lock_guard<std::mutex> lock(mutex_);
+template <typename T, typename Container, typename Mutex>
+std::optional<T> thread_safe_queue<T, Container, Mutex>::try_pop() {
+  std::lock_guard<Mutex> lock(mutex_);
   if (queue_.empty()) {
     return std::nullopt;
   }
@@ -152,8 +219,9 @@ template <typename T> std::optional<T> thread_safe_queue<T>::try_pop() {
 }
 
 // ------- CONSUMER API (blocking) --------
-template <typename T> bool thread_safe_queue<T>::wait_and_pop(T &out) {
-  std::unique_lock<std::mutex> lock(mutex_);
+template <typename T, typename Container, typename Mutex>
+bool thread_safe_queue<T, Container, Mutex>::wait_and_pop(T &out) {
+  std::unique_lock<Mutex> lock(mutex_);
   cv_.wait(lock, [this] { return !queue_.empty() || shutdown_; });
   if (queue_.empty()) {
     return false;
@@ -163,8 +231,9 @@ template <typename T> bool thread_safe_queue<T>::wait_and_pop(T &out) {
   return true;
 }
 
-template <typename T> std::optional<T> thread_safe_queue<T>::wait_and_pop() {
-  std::unique_lock<std::mutex> lock(mutex_);
+template <typename T, typename Container, typename Mutex>
+std::optional<T> thread_safe_queue<T, Container, Mutex>::wait_and_pop() {
+  std::unique_lock<Mutex> lock(mutex_);
   cv_.wait(lock, [this] { return !queue_.empty() || shutdown_; });
   if (queue_.empty()) {
     return std::nullopt;
@@ -175,11 +244,11 @@ template <typename T> std::optional<T> thread_safe_queue<T>::wait_and_pop() {
 }
 
 // --------- CONSUMER API (blocking with timeout) ------
-template <typename T>
+template <typename T, typename Container, typename Mutex>
 template <typename Rep, typename Period>
-bool thread_safe_queue<T>::wait_for(
+bool thread_safe_queue<T, Container, Mutex>::wait_for(
     T &out, std::chrono::duration<Rep, Period> timeout) {
-  std::unique_lock<std::mutex> lock(mutex_);
+  std::unique_lock<Mutex> lock(mutex_);
   bool success = cv_.wait_for(lock, timeout,
                               [this] { return !queue_.empty() || shutdown_; });
   if (!success || queue_.empty()) {
@@ -190,11 +259,11 @@ bool thread_safe_queue<T>::wait_for(
   return true;
 }
 
-template <typename T>
+template <typename T, typename Container, typename Mutex>
 template <typename Rep, typename Period>
-std::optional<T>
-thread_safe_queue<T>::wait_for(std::chrono::duration<Rep, Period> timeout) {
-  std::unique_lock<std::mutex> lock(mutex_);
+std::optional<T> thread_safe_queue<T, Container, Mutex>::wait_for(
+    std::chrono::duration<Rep, Period> timeout) {
+  std::unique_lock<Mutex> lock(mutex_);
   bool success = cv_.wait_for(lock, timeout,
                               [this] { return !queue_.empty() || shutdown_; });
   if (!success || queue_.empty()) {
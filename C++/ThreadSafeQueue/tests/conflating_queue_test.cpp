@@ -0,0 +1,163 @@
+#include "conflating_queue.hpp"
+#include "require_no_alloc.hpp"
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ------ CONFLATION -------
+
+TEST_CASE("a pending key is overwritten and keeps its position",
+          "[conflating]") {
+  ds::conflating_queue<std::string, int> q;
+  REQUIRE(q.push("A", 1));
+  REQUIRE(q.push("B", 1));
+  REQUIRE_FALSE(q.push("A", 2));
+  REQUIRE(q.push("C", 1));
+  REQUIRE_FALSE(q.push("A", 3));
+
+  REQUIRE(q.size() == 3);
+  REQUIRE(q.conflated() == 2);
+
+  auto first = q.try_pop();
+  REQUIRE(first.has_value());
+  REQUIRE(first->first == "A");
+  REQUIRE(first->second == 3);
+  REQUIRE(q.try_pop()->first == "B");
+  REQUIRE(q.try_pop()->first == "C");
+  REQUIRE_FALSE(q.try_pop().has_value());
+  REQUIRE(q.empty());
+}
+
+TEST_CASE("a popped key queues again at the back", "[conflating]") {
+  ds::conflating_queue<int, int> q;
+  q.push(1, 10);
+  q.push(2, 20);
+  std::pair<int, int> out;
+  REQUIRE(q.try_pop(out));
+  REQUIRE(out == std::pair{1, 10});
+
+  REQUIRE(q.push(1, 11));
+  REQUIRE(q.try_pop(out));
+  REQUIRE(out == std::pair{2, 20});
+  REQUIRE(q.try_pop(out));
+  REQUIRE(out == std::pair{1, 11});
+  REQUIRE(q.keys() == 2);
+}
+
+TEST_CASE("move-only values", "[conflating][move]") {
+  ds::conflating_queue<int, std::unique_ptr<std::string>> q;
+  q.push(7, std::make_unique<std::string>("old"));
+  q.push(7, std::make_unique<std::string>("new"));
+  auto out = q.try_pop();
+  REQUIRE(*out->second == "new");
+}
+
+TEST_CASE("push on a known key does not allocate", "[conflating][alloc]") {
+  ds::conflating_queue<int, double> q;
+  for (int key = 0; key < 64; ++key) {
+    q.push(key, 0.0);
+  }
+  std::pair<int, double> out;
+  while (q.try_pop(out)) {
+  }
+
+  REQUIRE_NO_ALLOC {
+    for (int i = 0; i < 10000; ++i) {
+      q.push(i % 64, static_cast<double>(i));
+      if (i % 3 == 0) {
+        q.try_pop(out);
+      }
+    }
+  }
+  REQUIRE(q.keys() == 64);
+}
+
+// ------ BLOCKING AND SHUTDOWN -------
+
+TEST_CASE("wait_and_pop blocks until a key is pushed",
+          "[conflating][blocking]") {
+  ds::conflating_queue<int, int> q;
+  std::thread producer([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    q.push(3, 30);
+  });
+  auto out = q.wait_and_pop();
+  producer.join();
+  REQUIRE(out.has_value());
+  REQUIRE(out->second == 30);
+
+  std::pair<int, int> entry;
+  REQUIRE_FALSE(q.wait_for(entry, std::chrono::milliseconds(5)));
+}
+
+TEST_CASE("shutdown wakes waiters and rejects pushes",
+          "[conflating][shutdown]") {
+  ds::conflating_queue<int, int> q;
+  q.push(1, 1);
+  std::thread waiter([&] {
+    std::pair<int, int> out;
+    REQUIRE(q.wait_and_pop(out));
+    REQUIRE_FALSE(q.wait_and_pop(out));
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  q.shutdown();
+  waiter.join();
+  REQUIRE(q.is_shutdown());
+  REQUIRE_THROWS_AS(q.push(2, 2), std::runtime_error);
+}
+
+// ------ STRESS -------
+
+TEST_CASE("a slow consumer sees every key's latest value",
+          "[conflating][stress]") {
+  constexpr int producers = 4;
+  constexpr int keys = 16;
+  constexpr int updates = 5000;
+  ds::conflating_queue<int, int> q;
+
+  // Each producer owns keys p, p + producers, ... and publishes increasing
+  // values, so per key the consumer must never see a value go backwards.
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; ++p) {
+    threads.emplace_back([&, p] {
+      for (int v = 1; v <= updates; ++v) {
+        for (int key = p; key < keys; key += producers) {
+          q.push(key, v);
+        }
+      }
+    });
+  }
+
+  std::vector<int> last(keys, 0);
+  std::atomic<bool> monotonic{true};
+  std::thread consumer([&] {
+    std::pair<int, int> out;
+    while (q.wait_and_pop(out)) {
+      if (out.second <= last[static_cast<std::size_t>(out.first)]) {
+        monotonic = false;
+      }
+      last[static_cast<std::size_t>(out.first)] = out.second;
+      std::this_thread::yield();
+    }
+  });
+
+  for (auto &t : threads) {
+    t.join();
+  }
+  while (!q.empty()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  q.shutdown();
+  consumer.join();
+
+  REQUIRE(monotonic);
+  for (int value : last) {
+    REQUIRE(value == updates);
+  }
+  REQUIRE(q.keys() == keys);
+}
@@ -0,0 +1,167 @@
+#include "queue_selector.hpp"
+#include "thread_safe_queue.hpp"
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+// ------ SELECTION -------
+
+TEST_CASE("priority selection prefers the lowest ready index",
+          "[selector]") {
+  ds::thread_safe_queue<int> high;
+  ds::thread_safe_queue<std::string> low;
+  ds::queue_selector sel(ds::select_policy::priority);
+  REQUIRE(sel.add(high) == 0);
+  REQUIRE(sel.add(low) == 1);
+
+  REQUIRE_FALSE(sel.try_select().has_value());
+  low.push("later");
+  REQUIRE(sel.try_select() == 1u);
+  high.push(1);
+  REQUIRE(sel.try_select() == 0u);
+  REQUIRE(sel.try_select() == 0u);
+}
+
+TEST_CASE("round robin selection rotates over ready queues", "[selector]") {
+  ds::thread_safe_queue<int> a, b, c;
+  ds::queue_selector sel(ds::select_policy::round_robin);
+  sel.add(a);
+  sel.add(b);
+  sel.add(c);
+  for (int i = 0; i < 3; ++i) {
+    a.push(i);
+    b.push(i);
+    c.push(i);
+  }
+
+  std::vector<std::size_t> order;
+  int out = 0;
+  while (auto i = sel.try_select()) {
+    order.push_back(*i);
+    ds::thread_safe_queue<int> *queues[] = {&a, &b, &c};
+    REQUIRE(queues[*i]->try_pop(out));
+  }
+  REQUIRE(order ==
+          std::vector<std::size_t>{0, 1, 2, 0, 1, 2, 0, 1, 2});
+}
+
+TEST_CASE("a queue is watched by one selector at a time", "[selector]") {
+  ds::thread_safe_queue<int> q;
+  {
+    ds::queue_selector first;
+    first.add(q);
+    ds::queue_selector second;
+    REQUIRE_THROWS_AS(second.add(q), std::logic_error);
+  }
+  // The first selector let go when it was destroyed.
+  ds::queue_selector third;
+  REQUIRE(third.add(q) == 0);
+  q.push(1);
+  REQUIRE(third.try_select() == 0u);
+}
+
+// ------ BLOCKING -------
+
+TEST_CASE("wait_any blocks until any queue receives data",
+          "[selector][blocking]") {
+  ds::thread_safe_queue<int> a, b;
+  ds::queue_selector sel;
+  sel.add(a);
+  sel.add(b);
+
+  std::thread producer([&] {
+    std::this_thread::sleep_for(20ms);
+    b.push(5);
+  });
+  auto ready = sel.wait_any();
+  producer.join();
+  REQUIRE(ready == 1u);
+  REQUIRE(b.try_pop().value() == 5);
+}
+
+TEST_CASE("wait_for times out", "[selector][timeout]") {
+  ds::thread_safe_queue<int> a;
+  ds::queue_selector sel;
+  sel.add(a);
+  auto start = std::chrono::steady_clock::now();
+  REQUIRE_FALSE(sel.wait_for(10ms).has_value());
+  REQUIRE(std::chrono::steady_clock::now() - start >= 10ms);
+}
+
+TEST_CASE("shutting down every queue ends the wait once drained",
+          "[selector][shutdown]") {
+  ds::thread_safe_queue<int> a, b;
+  ds::queue_selector sel;
+  sel.add(a);
+  sel.add(b);
+  a.push(1);
+  a.shutdown();
+
+  std::thread closer([&] {
+    std::this_thread::sleep_for(20ms);
+    b.shutdown();
+  });
+  // a still holds an element.
+  REQUIRE(sel.wait_any() == 0u);
+  REQUIRE(a.try_pop().has_value());
+  REQUIRE_FALSE(sel.wait_any().has_value());
+  closer.join();
+}
+
+TEST_CASE("selector shutdown wakes its waiters", "[selector][shutdown]") {
+  ds::thread_safe_queue<int> a;
+  ds::queue_selector sel;
+  sel.add(a);
+  std::thread waiter([&] { REQUIRE_FALSE(sel.wait_any().has_value()); });
+  std::this_thread::sleep_for(20ms);
+  sel.shutdown();
+  waiter.join();
+  REQUIRE(sel.is_shutdown());
+}
+
+// ------ STRESS -------
+
+TEST_CASE("one consumer drains several producers' queues",
+          "[selector][stress]") {
+  constexpr int queues = 4;
+  constexpr int per_queue = 5000;
+  std::vector<std::unique_ptr<ds::thread_safe_queue<int>>> qs;
+  ds::queue_selector sel(ds::select_policy::round_robin);
+  for (int i = 0; i < queues; ++i) {
+    qs.push_back(std::make_unique<ds::thread_safe_queue<int>>());
+    sel.add(*qs.back());
+  }
+
+  std::vector<std::thread> producers;
+  for (int i = 0; i < queues; ++i) {
+    producers.emplace_back([&, i] {
+      for (int v = 0; v < per_queue; ++v) {
+        qs[static_cast<std::size_t>(i)]->push(v);
+      }
+      qs[static_cast<std::size_t>(i)]->shutdown();
+    });
+  }
+
+  long long sum = 0;
+  int received = 0;
+  int out = 0;
+  while (auto i = sel.wait_any()) {
+    if (qs[*i]->try_pop(out)) {
+      sum += out;
+      ++received;
+    }
+  }
+  for (auto &t : producers) {
+    t.join();
+  }
+  REQUIRE(received == queues * per_queue);
+  REQUIRE(sum == static_cast<long long>(queues) * per_queue *
+                     (per_queue - 1) / 2);
+}
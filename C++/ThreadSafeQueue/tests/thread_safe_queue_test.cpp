@@ -1,8 +1,12 @@
+#include "memory_resources.hpp"
+#include "require_no_alloc.hpp"
 #include "thread_safe_queue.hpp"
 #include <atomic>
 #include <catch2/catch_test_macros.hpp>
 #include <chrono>
+#include <deque>
 #include <memory>
+#include <memory_resource>
 #include <stdexcept>
 #include <string>
 #include <thread>
@@ -292,3 +296,26 @@ TEST_CASE("MPMC stress test", "[queue][stress]") {
   REQUIRE(items_consumed == total_items);
   REQUIRE(sum_consumed == sum_produced);
 }
+
+// ------ ALLOCATIONS -------
+
+TEST_CASE("push/pop on a pooled deque does not allocate once warm",
+          "[queue][alloc]") {
+  ds::memory::pool_resource pool;
+  std::pmr::polymorphic_allocator<int> alloc(&pool);
+  ds::thread_safe_queue<int, std::pmr::deque<int>> q(alloc);
+  int value{};
+  for (int i = 0; i < 10000; ++i) {
+    q.push(i);
+    q.try_pop(value);
+  }
+
+  REQUIRE_NO_ALLOC {
+    for (int i = 0; i < 10000; ++i) {
+      q.push(i);
+      q.try_pop(value);
+    }
+    q.try_pop(value);
+  }
+  REQUIRE(value == 9999);
+}
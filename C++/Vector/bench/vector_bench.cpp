@@ -0,0 +1,37 @@
+#include "benchmark.hpp"
+#include "memory_resources.hpp"
+#include "vector.hpp"
+#include <vector>
+
+int main(int argc, char **argv) {
+  ds::bench::runner runner(argc, argv, "vector");
+
+  runner.add("push_back/ds_vector", [](ds::bench::state &st) {
+    ds::vector<int> v;
+    for (std::size_t i = 0; i < st.iterations(); ++i) {
+      v.push_back(static_cast<int>(i));
+    }
+    ds::bench::do_not_optimize(v.get_size());
+  });
+
+  runner.add("push_back/ds_vector_on_arena", [](ds::bench::state &st) {
+    using alloc =
+        ds::memory::resource_allocator<int, ds::memory::monotonic_arena>;
+    ds::memory::monotonic_arena arena;
+    ds::vector<int, alloc> v{alloc(&arena)};
+    for (std::size_t i = 0; i < st.iterations(); ++i) {
+      v.push_back(static_cast<int>(i));
+    }
+    ds::bench::do_not_optimize(v.get_size());
+  });
+
+  runner.add("push_back/std_vector", [](ds::bench::state &st) {
+    std::vector<int> v;
+    for (std::size_t i = 0; i < st.iterations(); ++i) {
+      v.push_back(static_cast<int>(i));
+    }
+    ds::bench::do_not_optimize(v.size());
+  });
+
+  return runner.run();
+}
@@ -1,25 +1,31 @@
+#pragma once
+
 #include <cstddef>
 #include <memory>
 #include <stdexcept>
 
 namespace ds {
-template <typename T> class vector {
+// Allocator lets the storage come from a ds::memory resource (or any other
+// standard allocator) instead of the global heap.
+template <typename T, typename Allocator = std::allocator<T>> class vector {
+  using alloc_traits = std::allocator_traits<Allocator>;
+
 public:
-  vector() : data_(std::allocator<T>{}.allocate(1)), capacity_(1), size_(0) {}
+  vector() : vector(Allocator()) {}
+  explicit vector(const Allocator &alloc)
+      : alloc_(alloc), data_(alloc_traits::allocate(alloc_, 1)), capacity_(1),
+        size_(0) {}
   ~vector() {
-    std::allocator<T> alloc;
     for (std::size_t i = 0; i < size_; i++) {
-      std::allocator_traits<std::allocator<T>>::destroy(alloc, data_ + i);
+      alloc_traits::destroy(alloc_, data_ + i);
     }
-    alloc.deallocate(data_, capacity_);
+    alloc_traits::deallocate(alloc_, data_, capacity_);
   }
   void push_back(T element) {
     if (size_ + 1 == capacity_) {
       reserve(get_new_capacity());
     }
-    std::allocator<T> alloc;
-    std::allocator_traits<std::allocator<T>>::construct(alloc, data_ + size_,
-                                                        element);
+    alloc_traits::construct(alloc_, data_ + size_, element);
     size_++;
   }
   const T &at(std::size_t index) const {
@@ -30,26 +36,24 @@ public:
   }
   std::size_t get_size() const { return size_; }
   std::size_t get_capacity() const { return capacity_; }
+  Allocator get_allocator() const { return alloc_; }
   void shrink_to_fit() {
     if (size_ == capacity_)
       return;
 
-    std::allocator<T> alloc;
-
     if (size_ == 0) {
-      alloc.deallocate(data_, capacity_);
+      alloc_traits::deallocate(alloc_, data_, capacity_);
       capacity_ = 1;
-      data_ = alloc.allocate(capacity_);
+      data_ = alloc_traits::allocate(alloc_, capacity_);
       return;
     }
 
-    T *new_data = alloc.allocate(size_);
+    T *new_data = alloc_traits::allocate(alloc_, size_);
     for (std::size_t i = 0; i < size_; i++) {
-      std::allocator_traits<std::allocator<T>>::construct(alloc, new_data + i,
-                                                          std::move(data_[i]));
-      std::allocator_traits<std::allocator<T>>::destroy(alloc, data_ + i);
+      alloc_traits::construct(alloc_, new_data + i, std::move(data_[i]));
+      alloc_traits::destroy(alloc_, data_ + i);
     }
-    alloc.deallocate(data_, capacity_);
+    alloc_traits::deallocate(alloc_, data_, capacity_);
     data_ = new_data;
     capacity_ = size_;
   }
@@ -57,22 +61,19 @@ public:
     if (size_ == 0)
       return;
     size_--;
-    std::allocator<T> alloc;
-    std::allocator_traits<std::allocator<T>>::destroy(alloc, data_ + size_);
+    alloc_traits::destroy(alloc_, data_ + size_);
   }
 
 private:
   void reserve(std::size_t new_capacity) {
     if (capacity_ >= new_capacity)
       return;
-    std::allocator<T> alloc;
-    T *new_data = alloc.allocate(new_capacity);
+    T *new_data = alloc_traits::allocate(alloc_, new_capacity);
     for (std::size_t i = 0; i < size_; i++) {
-      std::allocator_traits<std::allocator<T>>::construct(alloc, new_data + i,
-                                                          data_[i]);
-      std::allocator_traits<std::allocator<T>>::destroy(alloc, data_ + i);
+      alloc_traits::construct(alloc_, new_data + i, data_[i]);
+      alloc_traits::destroy(alloc_, data_ + i);
     }
-    alloc.deallocate(data_, capacity_);
+    alloc_traits::deallocate(alloc_, data_, capacity_);
     data_ = new_data;
     capacity_ = new_capacity;
   }
@@ -82,6 +83,7 @@ private:
     }
     return capacity_ * 3;
   }
+  [[no_unique_address]] Allocator alloc_;
   T *data_{};
   std::size_t capacity_{};
   std::size_t size_{};
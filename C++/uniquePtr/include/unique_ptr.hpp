@@ -1,3 +1,5 @@
+#pragma once
+
 #include <stdexcept>
 #include <utility>
 namespace ds
@@ -11,12 +13,13 @@ namespace ds
         }
     };
 
-    template <typename T, typename custom_deleter = custom_deleter<T>>
+    template <typename T, typename Deleter = custom_deleter<T>>
     class unique_ptr
     {
     public:
         unique_ptr() : ptr(nullptr) {}
         unique_ptr(T* pointer) : ptr(pointer) {}
+        unique_ptr(T* pointer, Deleter d) : ptr(pointer), deleter(std::move(d)) {}
 
         unique_ptr(const unique_ptr&) {
             throw std::invalid_argument("Copy constructor not available for unique ptr");
@@ -25,20 +28,22 @@ namespace ds
             throw std::invalid_argument("Copy assignment operator not available for unique ptr");
         };
 
-        unique_ptr(unique_ptr&& other) noexcept : ptr(other.ptr) {
+        unique_ptr(unique_ptr&& other) noexcept
+            : ptr(other.ptr), deleter(std::move(other.deleter)) {
             other.ptr = nullptr;
         }
 
         unique_ptr& operator=(unique_ptr&& other) noexcept {
             if (this == &other) return *this;
-            ds::custom_deleter<T>()(ptr);
+            destroy();
             ptr = other.ptr;
+            deleter = std::move(other.deleter);
             other.ptr = nullptr;
             return *this;
         }
 
         ~unique_ptr(){
-            ds::custom_deleter<T>()(ptr);
+            destroy();
         }
 
         T* release() {
@@ -46,7 +51,7 @@ namespace ds
         }
 
         void reset(T* pointer = nullptr) {
-            ds::custom_deleter<T>()(ptr);
+            destroy();
             ptr = pointer;
         }
 
@@ -54,6 +59,13 @@ namespace ds
             return ptr != nullptr;
         }
 
+        T* get() const {
+            return ptr;
+        }
+
+        Deleter& get_deleter() {
+            return deleter;
+        }
 
         T& operator*() const {
             return *ptr;
@@ -66,6 +78,13 @@ namespace ds
         }
 
     private:
+        // Deleters are only invoked on owned pointers, so pool/allocator
+        // deleters never have to handle nullptr themselves.
+        void destroy() {
+            if (ptr != nullptr) deleter(ptr);
+        }
+
         T* ptr {};
+        [[no_unique_address]] Deleter deleter {};
     };
 }